@@ -239,6 +239,22 @@
  */
 #define ID_MM_TTY_FLOW_CONTROL "ID_MM_TTY_FLOW_CONTROL"
 
+/**
+ * ID_MM_TTY_SEND_CHUNK_SIZE:
+ *
+ * This is a port-specific tag applied to TTYs that cannot process AT
+ * commands written in a single burst, and which require the daemon to
+ * wait some time after writing each chunk of the command.
+ *
+ * The value of the tag should be the maximum number of bytes to write
+ * before waiting, e.g. "1" to write the command byte by byte. If not
+ * given, commands are written at once, and the daemon writes the next
+ * commands byte by byte once the TTY fails to reply to one of them.
+ *
+ * Since: 1.20
+ */
+#define ID_MM_TTY_SEND_CHUNK_SIZE "ID_MM_TTY_SEND_CHUNK_SIZE"
+
 /*
  * The following symbols are deprecated. We don't add them to -compat
  * because this -tags file is not really part of the installed API.
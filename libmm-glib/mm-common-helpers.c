@@ -1698,6 +1698,14 @@ mm_utils_hex2byte (const gchar *hex)
     return (a << 4) | b;
 }
 
+/* Value of each hex digit plus one, so that invalid chars are 0 */
+static const guint8 hex2num_table[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,
+    ['5'] = 6,  ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+};
+
 guint8 *
 mm_utils_hexstr2bin (const gchar  *hex,
                      gssize        len,
@@ -1707,7 +1715,6 @@ mm_utils_hexstr2bin (const gchar  *hex,
     const gchar *ipos = hex;
     g_autofree guint8 *buf = NULL;
     gssize i;
-    gint a;
     guint8 *opos;
 
     if (len < 0)
@@ -1728,14 +1735,17 @@ mm_utils_hexstr2bin (const gchar  *hex,
 
     opos = buf = g_malloc0 (len / 2);
     for (i = 0; i < len; i += 2) {
-        a = mm_utils_hex2byte (ipos);
-        if (a < 0) {
+        guint8 hi, lo;
+
+        hi = hex2num_table[(guint8) ipos[0]];
+        lo = hex2num_table[(guint8) ipos[1]];
+        if (!hi || !lo) {
             g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
                          "Hex byte conversion from '%c%c' failed",
                          ipos[0], ipos[1]);
             return NULL;
         }
-        *opos++ = (guint8)a;
+        *opos++ = (guint8) (((hi - 1) << 4) | (lo - 1));
         ipos += 2;
     }
     *out_len = len / 2;
@@ -1769,19 +1779,24 @@ mm_utils_ishexstr (const gchar *hex)
     return TRUE;
 }
 
+static const gchar bin2hex_digits[] = "0123456789ABCDEF";
+
 gchar *
 mm_utils_bin2hexstr (const guint8 *bin,
                      gsize         len)
 {
-    GString *ret;
-    gsize i;
+    gchar *ret;
+    gsize  i;
 
     g_return_val_if_fail (bin != NULL, NULL);
 
-    ret = g_string_sized_new (len * 2 + 1);
-    for (i = 0; i < len; i++)
-        g_string_append_printf (ret, "%.2X", bin[i]);
-    return g_string_free (ret, FALSE);
+    ret = g_malloc (len * 2 + 1);
+    for (i = 0; i < len; i++) {
+        ret[2 * i]     = bin2hex_digits[bin[i] >> 4];
+        ret[2 * i + 1] = bin2hex_digits[bin[i] & 0x0F];
+    }
+    ret[2 * len] = '\0';
+    return ret;
 }
 
 gboolean
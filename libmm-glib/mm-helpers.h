@@ -329,4 +329,229 @@
     PROPERTY_ERROR_DEFINE_GET              (property_name, Type, type, TYPE)                   \
     PROPERTY_ERROR_DEFINE_PEEK             (property_name, Type, type, TYPE)
 
+/******************************************************************************/
+/* Snapshot based properties.
+ *
+ * Instead of lazily rebuilding the value under a mutex on the first getter
+ * call after a change, the value is rebuilt once in the property updated
+ * callback (i.e. in the thread running the proxy's main context) and
+ * published as an immutable snapshot. Getters just take a reference to the
+ * current snapshot, so they never wait for a variant conversion, and
+ * concurrent getters in different threads don't serialize on a mutex.
+ *
+ * The snapshot pointer doubles as a bit lock (bit 0) which is only held
+ * while swapping the pointer or while taking a reference on it, so that a
+ * snapshot cannot be disposed between being read and being referenced.
+ */
+
+#define PROPERTY_SNAPSHOT_DECLARE(property_name,PropertyType) \
+    PropertyType *property_name;                              \
+    gsize         property_name##_initialized;                \
+    guint         property_name##_id;
+
+#define PROPERTY_SNAPSHOT_ARRAY_DECLARE(property_name)             PROPERTY_SNAPSHOT_DECLARE (property_name, GArray)
+#define PROPERTY_SNAPSHOT_OBJECT_DECLARE(property_name,ObjectType) PROPERTY_SNAPSHOT_DECLARE (property_name, ObjectType)
+
+#define PROPERTY_SNAPSHOT_INITIALIZE(property_name,signal_name) \
+    self->priv->property_name##_id =                            \
+        g_signal_connect (self,                                 \
+                          "notify::" signal_name,               \
+                          G_CALLBACK (property_name##_updated), \
+                          NULL);
+
+#define PROPERTY_SNAPSHOT_LOCK_BIT 0
+
+static inline gpointer
+property_snapshot_unmask (gpointer value)
+{
+    return (gpointer) ((gsize) value & ~((gsize) 1 << PROPERTY_SNAPSHOT_LOCK_BIT));
+}
+
+/* Publishes a new snapshot and returns the previous one, which the caller
+ * must release */
+static inline gpointer
+property_snapshot_swap (gpointer *slot,
+                        gpointer  value)
+{
+    gpointer old;
+
+    g_pointer_bit_lock (slot, PROPERTY_SNAPSHOT_LOCK_BIT);
+    old = property_snapshot_unmask (g_atomic_pointer_get (slot));
+    /* Keep the lock bit set until the unlock */
+    g_atomic_pointer_set (slot, (gpointer) ((gsize) value | ((gsize) 1 << PROPERTY_SNAPSHOT_LOCK_BIT)));
+    g_pointer_bit_unlock (slot, PROPERTY_SNAPSHOT_LOCK_BIT);
+    return old;
+}
+
+/* Returns a new reference to the current snapshot, or NULL */
+static inline gpointer
+property_snapshot_ref (gpointer  *slot,
+                       gpointer (*ref_func) (gpointer))
+{
+    gpointer value;
+
+    g_pointer_bit_lock (slot, PROPERTY_SNAPSHOT_LOCK_BIT);
+    value = property_snapshot_unmask (g_atomic_pointer_get (slot));
+    if (value)
+        ref_func (value);
+    g_pointer_bit_unlock (slot, PROPERTY_SNAPSHOT_LOCK_BIT);
+    return value;
+}
+
+/* Returns the current snapshot, without taking a reference; only valid in
+ * the thread running the proxy's main context, until the property changes */
+static inline gpointer
+property_snapshot_peek (gpointer *slot)
+{
+    return property_snapshot_unmask (g_atomic_pointer_get (slot));
+}
+
+/* This helper defines the methods to build and publish snapshots. The first
+ * getter call builds the snapshot with the lock held, so that it cannot
+ * overwrite a newer one published by the updated callback meanwhile. */
+#define PROPERTY_SNAPSHOT_DEFINE_UPDATE(property_name,Type,type,TYPE,PropertyType,variant_to_value,value_unref) \
+    static PropertyType *                                                                                       \
+    property_name##_build (MM##Type *self)                                                                      \
+    {                                                                                                           \
+        g_autoptr(GVariant) variant = NULL;                                                                     \
+                                                                                                                \
+        variant = mm_gdbus_##type##_dup_##property_name (MM_GDBUS_##TYPE (self));                               \
+        return (variant ? variant_to_value (variant) : NULL);                                                   \
+    }                                                                                                           \
+                                                                                                                \
+    static void                                                                                                 \
+    property_name##_ensure (MM##Type *self)                                                                     \
+    {                                                                                                           \
+        if (g_once_init_enter (&self->priv->property_name##_initialized)) {                                     \
+            gpointer *slot = (gpointer *) &self->priv->property_name;                                           \
+            gpointer  old;                                                                                      \
+                                                                                                                \
+            g_pointer_bit_lock (slot, PROPERTY_SNAPSHOT_LOCK_BIT);                                              \
+            old = property_snapshot_unmask (g_atomic_pointer_get (slot));                                       \
+            g_atomic_pointer_set (slot, (gpointer) ((gsize) property_name##_build (self) |                      \
+                                                    ((gsize) 1 << PROPERTY_SNAPSHOT_LOCK_BIT)));                \
+            g_pointer_bit_unlock (slot, PROPERTY_SNAPSHOT_LOCK_BIT);                                            \
+            if (old)                                                                                            \
+                value_unref (old);                                                                              \
+            g_once_init_leave (&self->priv->property_name##_initialized, 1);                                    \
+        }                                                                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    static void                                                                                                 \
+    property_name##_updated (MM##Type *self)                                                                    \
+    {                                                                                                           \
+        gpointer old;                                                                                           \
+                                                                                                                \
+        old = property_snapshot_swap ((gpointer *) &self->priv->property_name, property_name##_build (self));   \
+        if (old)                                                                                                \
+            value_unref (old);                                                                                  \
+    }
+
+/* Getter implementation for snapshots of arrays of simple types */
+#define PROPERTY_SNAPSHOT_ARRAY_DEFINE_GET(property_name,Type,type,TYPE,ArrayItemType)                     \
+    gboolean                                                                                               \
+    mm_##type##_get_##property_name (MM##Type       *self,                                                 \
+                                     ArrayItemType **out,                                                  \
+                                     guint          *n_out)                                                \
+    {                                                                                                      \
+        g_autoptr(GArray) snapshot = NULL;                                                                 \
+                                                                                                           \
+        g_return_val_if_fail (MM_IS_##TYPE (self), FALSE);                                                 \
+        g_return_val_if_fail (out != NULL, FALSE);                                                         \
+        g_return_val_if_fail (n_out != NULL, FALSE);                                                       \
+                                                                                                           \
+        property_name##_ensure (self);                                                                     \
+        snapshot = property_snapshot_ref ((gpointer *) &self->priv->property_name,                         \
+                                          (gpointer (*) (gpointer)) g_array_ref);                          \
+        if (!snapshot)                                                                                     \
+            return FALSE;                                                                                  \
+                                                                                                           \
+        *out = NULL;                                                                                       \
+        *n_out = snapshot->len;                                                                            \
+        if (snapshot->len > 0)                                                                             \
+            *out = g_memdup (snapshot->data, (guint)(sizeof (ArrayItemType) * snapshot->len));             \
+        return TRUE;                                                                                       \
+    }
+
+/* Getter implementation for snapshots of arrays of complex types that need
+ * deep copy. */
+#define PROPERTY_SNAPSHOT_ARRAY_DEFINE_GET_DEEP(property_name,Type,type,TYPE,ArrayItemType,garray_to_array) \
+    gboolean                                                                                                \
+    mm_##type##_get_##property_name (MM##Type       *self,                                                  \
+                                     ArrayItemType **out,                                                   \
+                                     guint          *n_out)                                                 \
+    {                                                                                                       \
+        g_autoptr(GArray) snapshot = NULL;                                                                  \
+                                                                                                            \
+        g_return_val_if_fail (MM_IS_##TYPE (self), FALSE);                                                  \
+        g_return_val_if_fail (out != NULL, FALSE);                                                          \
+        g_return_val_if_fail (n_out != NULL, FALSE);                                                        \
+                                                                                                            \
+        property_name##_ensure (self);                                                                      \
+        snapshot = property_snapshot_ref ((gpointer *) &self->priv->property_name,                          \
+                                          (gpointer (*) (gpointer)) g_array_ref);                           \
+        return garray_to_array (snapshot, out, n_out);                                                      \
+    }
+
+/* Peeker implementation for snapshots of arrays of any type */
+#define PROPERTY_SNAPSHOT_ARRAY_DEFINE_PEEK(property_name,Type,type,TYPE,ArrayItemType) \
+    gboolean                                                                            \
+    mm_##type##_peek_##property_name (MM##Type             *self,                       \
+                                      const ArrayItemType **out,                        \
+                                      guint                *n_out)                      \
+    {                                                                                   \
+        GArray *snapshot;                                                               \
+                                                                                        \
+        g_return_val_if_fail (MM_IS_##TYPE (self), FALSE);                              \
+        g_return_val_if_fail (out != NULL, FALSE);                                      \
+        g_return_val_if_fail (n_out != NULL, FALSE);                                    \
+                                                                                        \
+        property_name##_ensure (self);                                                  \
+        snapshot = property_snapshot_peek ((gpointer *) &self->priv->property_name);    \
+        if (!snapshot)                                                                  \
+            return FALSE;                                                               \
+                                                                                        \
+        *n_out = snapshot->len;                                                         \
+        *out = (ArrayItemType *)snapshot->data;                                         \
+        return TRUE;                                                                    \
+    }
+
+/* Get implementation for snapshots of objects */
+#define PROPERTY_SNAPSHOT_OBJECT_DEFINE_GET(property_name,Type,type,TYPE,ObjectType) \
+    ObjectType *                                                                     \
+    mm_##type##_get_##property_name (MM##Type *self)                                 \
+    {                                                                                \
+        g_return_val_if_fail (MM_IS_##TYPE (self), NULL);                            \
+                                                                                     \
+        property_name##_ensure (self);                                               \
+        return property_snapshot_ref ((gpointer *) &self->priv->property_name,       \
+                                      g_object_ref);                                 \
+    }
+
+/* Peek implementation for snapshots of objects */
+#define PROPERTY_SNAPSHOT_OBJECT_DEFINE_PEEK(property_name,Type,type,TYPE,ObjectType) \
+    ObjectType *                                                                      \
+    mm_##type##_peek_##property_name (MM##Type *self)                                 \
+    {                                                                                 \
+        g_return_val_if_fail (MM_IS_##TYPE (self), NULL);                             \
+                                                                                      \
+        property_name##_ensure (self);                                                \
+        return property_snapshot_peek ((gpointer *) &self->priv->property_name);      \
+    }
+
+#define PROPERTY_SNAPSHOT_ARRAY_DEFINE(property_name,Type,type,TYPE,ArrayItemType,variant_to_garray)                \
+    PROPERTY_SNAPSHOT_DEFINE_UPDATE     (property_name, Type, type, TYPE, GArray, variant_to_garray, g_array_unref) \
+    PROPERTY_SNAPSHOT_ARRAY_DEFINE_GET  (property_name, Type, type, TYPE, ArrayItemType)                            \
+    PROPERTY_SNAPSHOT_ARRAY_DEFINE_PEEK (property_name, Type, type, TYPE, ArrayItemType)
+
+#define PROPERTY_SNAPSHOT_ARRAY_DEFINE_DEEP(property_name,Type,type,TYPE,ArrayItemType,variant_to_garray,garray_to_array) \
+    PROPERTY_SNAPSHOT_DEFINE_UPDATE         (property_name, Type, type, TYPE, GArray, variant_to_garray, g_array_unref)   \
+    PROPERTY_SNAPSHOT_ARRAY_DEFINE_GET_DEEP (property_name, Type, type, TYPE, ArrayItemType, garray_to_array)             \
+    PROPERTY_SNAPSHOT_ARRAY_DEFINE_PEEK     (property_name, Type, type, TYPE, ArrayItemType)
+
+#define PROPERTY_SNAPSHOT_OBJECT_DEFINE(property_name,Type,type,TYPE,ObjectType,variant_to_object)                        \
+    PROPERTY_SNAPSHOT_DEFINE_UPDATE      (property_name, Type, type, TYPE, ObjectType, variant_to_object, g_object_unref) \
+    PROPERTY_SNAPSHOT_OBJECT_DEFINE_GET  (property_name, Type, type, TYPE, ObjectType)                                    \
+    PROPERTY_SNAPSHOT_OBJECT_DEFINE_PEEK (property_name, Type, type, TYPE, ObjectType)
+
 #endif /* _MM_HELPERS_H_ */
@@ -45,7 +45,6 @@ G_DEFINE_TYPE (MMLocationGpsNmea, mm_location_gps_nmea, G_TYPE_OBJECT)
 
 struct _MMLocationGpsNmeaPrivate {
     GHashTable *traces;
-    GRegex *sequence_regex;
 };
 
 /*****************************************************************************/
@@ -54,26 +53,23 @@ static gboolean
 check_append_or_replace (MMLocationGpsNmea *self,
                          const gchar *trace)
 {
-    /* By default, replace */
-    gboolean append_or_replace = FALSE;
-    GMatchInfo *match_info = NULL;
-
-    if (G_UNLIKELY (!self->priv->sequence_regex))
-        self->priv->sequence_regex = g_regex_new ("\\$..(?:ALM|GSV|RTE|SFI),(\\d),(\\d).*",
-                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                                                  0,
-                                                  NULL);
-
-    if (g_regex_match (self->priv->sequence_regex, trace, 0, &match_info)) {
-        guint index;
-
-        /* If we don't have the first element of a sequence, append */
-        if (mm_get_uint_from_match_info (match_info, 2, &index) && index != 1)
-            append_or_replace = TRUE;
-    }
-    g_match_info_free (match_info);
+    /* Traces which are part of a sequence look like:
+     *   $..(ALM|GSV|RTE|SFI),<total>,<index>...
+     * where both total and index are single digits; if we don't have the
+     * first element of a sequence, append. Otherwise, replace. */
+    if (trace[0] != '$' || !trace[1] || !trace[2])
+        return FALSE;
+
+    if (strncmp (&trace[3], "ALM,", 4) != 0 &&
+        strncmp (&trace[3], "GSV,", 4) != 0 &&
+        strncmp (&trace[3], "RTE,", 4) != 0 &&
+        strncmp (&trace[3], "SFI,", 4) != 0)
+        return FALSE;
+
+    if (!g_ascii_isdigit (trace[7]) || trace[8] != ',' || !g_ascii_isdigit (trace[9]))
+        return FALSE;
 
-    return append_or_replace;
+    return (trace[9] != '1');
 }
 
 static gboolean
@@ -291,8 +287,6 @@ finalize (GObject *object)
     MMLocationGpsNmea *self = MM_LOCATION_GPS_NMEA (object);
 
     g_hash_table_destroy (self->priv->traces);
-    if (self->priv->sequence_regex)
-        g_regex_unref (self->priv->sequence_regex);
 
     G_OBJECT_CLASS (mm_location_gps_nmea_parent_class)->finalize (object);
 }
@@ -960,6 +960,224 @@ mm_manager_uninhibit_device_sync (MMManager     *manager,
 
 /*****************************************************************************/
 
+typedef struct {
+    guint64    generation;
+    gboolean   complete;
+    GVariant  *objects;
+    gchar    **removed;
+} GetStateResult;
+
+static void
+get_state_result_free (GetStateResult *result)
+{
+    g_clear_pointer (&result->objects, g_variant_unref);
+    g_strfreev (result->removed);
+    g_slice_free (GetStateResult, result);
+}
+
+/**
+ * mm_manager_get_state_finish:
+ * @manager: A #MMManager.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to
+ *  mm_manager_get_state().
+ * @generation: (out) (optional): Return location for the current state
+ *  generation.
+ * @complete: (out) (optional): Return location for whether @objects includes
+ *  all objects, instead of only the ones changed.
+ * @objects: (out) (optional) (transfer full): Return location for a #GVariant
+ *  of type <literal>a{oa{sa{sv}}}</literal> with the object paths, interfaces
+ *  and properties. The returned value should be freed with g_variant_unref().
+ * @removed: (out) (optional) (transfer full): Return location for the paths of
+ *  the objects removed. The returned value should be freed with g_strfreev().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_manager_get_state().
+ *
+ * Returns: %TRUE if the call succeeded, %FALSE if @error is set.
+ *
+ * Since: 1.20
+ */
+gboolean
+mm_manager_get_state_finish (MMManager     *manager,
+                             GAsyncResult  *res,
+                             guint64       *generation,
+                             gboolean      *complete,
+                             GVariant     **objects,
+                             gchar       ***removed,
+                             GError       **error)
+{
+    GetStateResult *result;
+
+    g_return_val_if_fail (MM_IS_MANAGER (manager), FALSE);
+
+    result = g_task_propagate_pointer (G_TASK (res), error);
+    if (!result)
+        return FALSE;
+
+    if (generation)
+        *generation = result->generation;
+    if (complete)
+        *complete = result->complete;
+    if (objects)
+        *objects = g_steal_pointer (&result->objects);
+    if (removed)
+        *removed = g_steal_pointer (&result->removed);
+    get_state_result_free (result);
+    return TRUE;
+}
+
+static void
+get_state_ready (MmGdbusOrgFreedesktopModemManager1 *manager_iface_proxy,
+                 GAsyncResult                       *res,
+                 GTask                              *task)
+{
+    GError         *error = NULL;
+    GetStateResult *result;
+
+    result = g_slice_new0 (GetStateResult);
+    if (!mm_gdbus_org_freedesktop_modem_manager1_call_get_state_finish (
+            manager_iface_proxy,
+            &result->generation,
+            &result->complete,
+            &result->objects,
+            &result->removed,
+            res,
+            &error)) {
+        g_slice_free (GetStateResult, result);
+        g_task_return_error (task, error);
+    } else
+        g_task_return_pointer (task, result, (GDestroyNotify)get_state_result_free);
+    g_object_unref (task);
+}
+
+/**
+ * mm_manager_get_state:
+ * @manager: A #MMManager.
+ * @since_generation: the generation returned by a previous call, or 0 to get
+ *  the state of all objects.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or
+ *  %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously requests a snapshot of the properties of all modems, bearers
+ * and SIMs in a single call, or only of those changed since
+ * @since_generation.
+ *
+ * If @since_generation is too old, or unknown to the daemon, the state of all
+ * objects is given instead, and the operation reports it as complete.
+ *
+ * When the operation is finished, @callback will be invoked in the
+ * <link linkend="g-main-context-push-thread-default">thread-default main loop</link>
+ * of the thread you are calling this method from. You can then call
+ * mm_manager_get_state_finish() to get the result of the operation.
+ *
+ * See mm_manager_get_state_sync() for the synchronous, blocking version of
+ * this method.
+ *
+ * Since: 1.20
+ */
+void
+mm_manager_get_state (MMManager           *manager,
+                      guint64              since_generation,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+    GTask  *task;
+    GError *inner_error = NULL;
+
+    g_return_if_fail (MM_IS_MANAGER (manager));
+
+    task = g_task_new (manager, cancellable, callback, user_data);
+
+    if (!ensure_modem_manager1_proxy (manager, &inner_error)) {
+        g_task_return_error (task, inner_error);
+        g_object_unref (task);
+        return;
+    }
+
+    mm_gdbus_org_freedesktop_modem_manager1_call_get_state (
+        manager->priv->manager_iface_proxy,
+        since_generation,
+        cancellable,
+        (GAsyncReadyCallback)get_state_ready,
+        task);
+}
+
+/**
+ * mm_manager_get_state_sync:
+ * @manager: A #MMManager.
+ * @since_generation: the generation returned by a previous call, or 0 to get
+ *  the state of all objects.
+ * @generation: (out) (optional): Return location for the current state
+ *  generation.
+ * @complete: (out) (optional): Return location for whether @objects includes
+ *  all objects, instead of only the ones changed.
+ * @objects: (out) (optional) (transfer full): Return location for a #GVariant
+ *  of type <literal>a{oa{sa{sv}}}</literal> with the object paths, interfaces
+ *  and properties. The returned value should be freed with g_variant_unref().
+ * @removed: (out) (optional) (transfer full): Return location for the paths of
+ *  the objects removed. The returned value should be freed with g_strfreev().
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously requests a snapshot of the properties of all modems, bearers
+ * and SIMs in a single call, or only of those changed since
+ * @since_generation.
+ *
+ * The calling thread is blocked until a reply is received.
+ *
+ * See mm_manager_get_state() for the asynchronous version of this method.
+ *
+ * Returns: %TRUE if the call succeeded, %FALSE if @error is set.
+ *
+ * Since: 1.20
+ */
+gboolean
+mm_manager_get_state_sync (MMManager     *manager,
+                           guint64        since_generation,
+                           guint64       *generation,
+                           gboolean      *complete,
+                           GVariant     **objects,
+                           gchar       ***removed,
+                           GCancellable  *cancellable,
+                           GError       **error)
+{
+    g_autoptr(GVariant)  out_objects = NULL;
+    g_auto(GStrv)        out_removed = NULL;
+    guint64              out_generation = 0;
+    gboolean             out_complete = FALSE;
+
+    g_return_val_if_fail (MM_IS_MANAGER (manager), FALSE);
+
+    if (!ensure_modem_manager1_proxy (manager, error))
+        return FALSE;
+
+    if (!mm_gdbus_org_freedesktop_modem_manager1_call_get_state_sync (
+            manager->priv->manager_iface_proxy,
+            since_generation,
+            &out_generation,
+            &out_complete,
+            &out_objects,
+            &out_removed,
+            cancellable,
+            error))
+        return FALSE;
+
+    if (generation)
+        *generation = out_generation;
+    if (complete)
+        *complete = out_complete;
+    if (objects)
+        *objects = g_steal_pointer (&out_objects);
+    if (removed)
+        *removed = g_steal_pointer (&out_removed);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 static void
 mm_manager_init (MMManager *manager)
 {
@@ -151,6 +151,27 @@ gboolean mm_manager_uninhibit_device_sync   (MMManager           *manager,
                                              GCancellable        *cancellable,
                                              GError             **error);
 
+void     mm_manager_get_state        (MMManager           *manager,
+                                      guint64              since_generation,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data);
+gboolean mm_manager_get_state_finish (MMManager           *manager,
+                                      GAsyncResult        *res,
+                                      guint64             *generation,
+                                      gboolean            *complete,
+                                      GVariant           **objects,
+                                      gchar             ***removed,
+                                      GError             **error);
+gboolean mm_manager_get_state_sync   (MMManager           *manager,
+                                      guint64              since_generation,
+                                      guint64             *generation,
+                                      gboolean            *complete,
+                                      GVariant           **objects,
+                                      gchar             ***removed,
+                                      GCancellable        *cancellable,
+                                      GError             **error);
+
 G_END_DECLS
 
 #endif /* _MM_MANAGER_H_ */
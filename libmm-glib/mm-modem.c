@@ -44,16 +44,13 @@
 G_DEFINE_TYPE (MMModem, mm_modem, MM_GDBUS_TYPE_MODEM_PROXY)
 
 struct _MMModemPrivate {
-    /* Common mutex to sync access */
-    GMutex mutex;
+    PROPERTY_SNAPSHOT_ARRAY_DECLARE (ports)
+    PROPERTY_SNAPSHOT_ARRAY_DECLARE (supported_modes)
+    PROPERTY_SNAPSHOT_ARRAY_DECLARE (supported_capabilities)
+    PROPERTY_SNAPSHOT_ARRAY_DECLARE (supported_bands)
+    PROPERTY_SNAPSHOT_ARRAY_DECLARE (current_bands)
 
-    PROPERTY_ARRAY_DECLARE (ports)
-    PROPERTY_ARRAY_DECLARE (supported_modes)
-    PROPERTY_ARRAY_DECLARE (supported_capabilities)
-    PROPERTY_ARRAY_DECLARE (supported_bands)
-    PROPERTY_ARRAY_DECLARE (current_bands)
-
-    PROPERTY_OBJECT_DECLARE (unlock_retries, MMUnlockRetries)
+    PROPERTY_SNAPSHOT_OBJECT_DECLARE (unlock_retries, MMUnlockRetries)
 };
 
 /*****************************************************************************/
@@ -261,10 +258,10 @@ mm_modem_get_primary_sim_slot (MMModem *self)
  * Since: 1.0
  */
 
-PROPERTY_ARRAY_DEFINE (supported_capabilities,
-                       Modem, modem, MODEM,
-                       MMModemCapability,
-                       mm_common_capability_combinations_variant_to_garray)
+PROPERTY_SNAPSHOT_ARRAY_DEFINE (supported_capabilities,
+                                Modem, modem, MODEM,
+                                MMModemCapability,
+                                mm_common_capability_combinations_variant_to_garray)
 
 /*****************************************************************************/
 
@@ -944,11 +941,11 @@ mm_modem_dup_primary_port (MMModem *self)
  * Since: 1.0
  */
 
-PROPERTY_ARRAY_DEFINE_DEEP (ports,
-                            Modem, modem, MODEM,
-                            MMModemPortInfo,
-                            mm_common_ports_variant_to_garray,
-                            mm_common_ports_garray_to_array)
+PROPERTY_SNAPSHOT_ARRAY_DEFINE_DEEP (ports,
+                                     Modem, modem, MODEM,
+                                     MMModemPortInfo,
+                                     mm_common_ports_variant_to_garray,
+                                     mm_common_ports_garray_to_array)
 
 /*****************************************************************************/
 
@@ -1120,10 +1117,10 @@ mm_modem_get_unlock_required (MMModem *self)
  * Since: 1.0
  */
 
-PROPERTY_OBJECT_DEFINE (unlock_retries,
-                        Modem, modem, MODEM,
-                        MMUnlockRetries,
-                        mm_unlock_retries_new_from_dictionary)
+PROPERTY_SNAPSHOT_OBJECT_DEFINE (unlock_retries,
+                                 Modem, modem, MODEM,
+                                 MMUnlockRetries,
+                                 mm_unlock_retries_new_from_dictionary)
 
 /*****************************************************************************/
 
@@ -1280,10 +1277,10 @@ mm_modem_get_signal_quality (MMModem *self,
  * Since: 1.0
  */
 
-PROPERTY_ARRAY_DEFINE (supported_modes,
-                       Modem, modem, MODEM,
-                       MMModemModeCombination,
-                       mm_common_mode_combinations_variant_to_garray)
+PROPERTY_SNAPSHOT_ARRAY_DEFINE (supported_modes,
+                                Modem, modem, MODEM,
+                                MMModemModeCombination,
+                                mm_common_mode_combinations_variant_to_garray)
 
 /*****************************************************************************/
 
@@ -1362,10 +1359,10 @@ mm_modem_get_current_modes (MMModem *self,
  * Since: 1.0
  */
 
-PROPERTY_ARRAY_DEFINE (supported_bands,
-                       Modem, modem, MODEM,
-                       MMModemBand,
-                       mm_common_bands_variant_to_garray)
+PROPERTY_SNAPSHOT_ARRAY_DEFINE (supported_bands,
+                                Modem, modem, MODEM,
+                                MMModemBand,
+                                mm_common_bands_variant_to_garray)
 
 /*****************************************************************************/
 
@@ -1404,10 +1401,10 @@ PROPERTY_ARRAY_DEFINE (supported_bands,
  * Since: 1.0
  */
 
-PROPERTY_ARRAY_DEFINE (current_bands,
-                       Modem, modem, MODEM,
-                       MMModemBand,
-                       mm_common_bands_variant_to_garray)
+PROPERTY_SNAPSHOT_ARRAY_DEFINE (current_bands,
+                                Modem, modem, MODEM,
+                                MMModemBand,
+                                mm_common_bands_variant_to_garray)
 
 /*****************************************************************************/
 
@@ -3251,14 +3248,13 @@ static void
 mm_modem_init (MMModem *self)
 {
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_MODEM, MMModemPrivate);
-    g_mutex_init (&self->priv->mutex);
 
-    PROPERTY_INITIALIZE (ports,                  "ports")
-    PROPERTY_INITIALIZE (supported_modes,        "supported-modes")
-    PROPERTY_INITIALIZE (supported_capabilities, "supported-capabilities")
-    PROPERTY_INITIALIZE (supported_bands,        "supported-bands")
-    PROPERTY_INITIALIZE (current_bands,          "current-bands")
-    PROPERTY_INITIALIZE (unlock_retries,         "unlock-retries")
+    PROPERTY_SNAPSHOT_INITIALIZE (ports,                  "ports")
+    PROPERTY_SNAPSHOT_INITIALIZE (supported_modes,        "supported-modes")
+    PROPERTY_SNAPSHOT_INITIALIZE (supported_capabilities, "supported-capabilities")
+    PROPERTY_SNAPSHOT_INITIALIZE (supported_bands,        "supported-bands")
+    PROPERTY_SNAPSHOT_INITIALIZE (current_bands,          "current-bands")
+    PROPERTY_SNAPSHOT_INITIALIZE (unlock_retries,         "unlock-retries")
 }
 
 static void
@@ -3266,8 +3262,6 @@ finalize (GObject *object)
 {
     MMModem *self = MM_MODEM (object);
 
-    g_mutex_clear (&self->priv->mutex);
-
     PROPERTY_ARRAY_FINALIZE (ports)
     PROPERTY_ARRAY_FINALIZE (supported_modes)
     PROPERTY_ARRAY_FINALIZE (supported_capabilities)
@@ -32,6 +32,7 @@
 #include "mm-errors-types.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
+#include "mm-iface-modem-3gpp-profile-manager.h"
 #include "mm-iface-modem-messaging.h"
 #include "mm-iface-modem-location.h"
 #include "mm-iface-modem-voice.h"
@@ -1243,6 +1244,9 @@ set_initial_eps_cgdcont_ready (MMBaseModem  *_self,
 
     ctx = (SetInitialEpsContext *) g_task_get_task_data (task);
 
+    /* The context is also listed as a profile */
+    mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (MM_IFACE_MODEM_3GPP_PROFILE_MANAGER (self));
+
     if (!mm_base_modem_at_command_finish (_self, res, &ctx->saved_error)) {
         mm_obj_warn (self, "couldn't configure context %d settings: %s",
                      self->priv->initial_eps_bearer_cid, ctx->saved_error->message);
@@ -26,12 +26,14 @@
 
 #include "mm-log.h"
 #include "mm-kernel-device-generic-rules.h"
+#include "mm-kernel-device-helpers.h"
 
 static void
 udev_rule_match_clear (MMUdevRuleMatch *rule_match)
 {
     g_free (rule_match->parameter);
     g_free (rule_match->value);
+    g_free (rule_match->value_prefix);
 }
 
 static void
@@ -154,6 +156,17 @@ load_rule_result (MMUdevRuleResult  *rule_result,
         rule_result->type = MM_UDEV_RULE_RESULT_TYPE_PROPERTY;
         rule_result->content.property.name = g_strndup (left + 4, left_len - 5);
         rule_result->content.property.value = right;
+        rule_result->content.property.name_quark = g_quark_from_string (rule_result->content.property.name);
+        if (g_str_equal (right, "$attr{bInterfaceClass}"))
+            rule_result->content.property.source = MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_CLASS;
+        else if (g_str_equal (right, "$attr{bInterfaceSubClass}"))
+            rule_result->content.property.source = MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_SUBCLASS;
+        else if (g_str_equal (right, "$attr{bInterfaceProtocol}"))
+            rule_result->content.property.source = MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_PROTOCOL;
+        else if (g_str_equal (right, "$attr{bInterfaceNumber}"))
+            rule_result->content.property.source = MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_NUMBER;
+        else
+            rule_result->content.property.source = MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_VALUE;
         right = NULL;
         goto out;
     }
@@ -174,6 +187,74 @@ out:
     return TRUE;
 }
 
+static void
+compile_rule_match (MMUdevRuleMatch *rule_match)
+{
+    const gchar *parameter = rule_match->parameter;
+
+    if (g_str_equal (parameter, "ACTION"))
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_ACTION;
+    else if (g_str_equal (parameter, "SUBSYSTEM"))
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM;
+    else if (g_str_equal (parameter, "SUBSYSTEMS"))
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS;
+    else if (g_str_equal (parameter, "DRIVER"))
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_DRIVER;
+    else if (g_str_equal (parameter, "DRIVERS"))
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS;
+    else if (g_str_equal (parameter, "KERNEL"))
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_KERNEL;
+    else if (g_str_equal (parameter, "DEVPATH")) {
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH;
+        /* If not already doing a prefix match, do an implicit one. This is so that
+         * we can add properties to the usb_device owning all ports, and then apply
+         * the property to all ports individually processed here. */
+        if (rule_match->value[0] && rule_match->value[strlen (rule_match->value) - 1] != '*')
+            rule_match->value_prefix = g_strdup_printf ("%s/*", rule_match->value);
+    } else if (g_str_has_prefix (parameter, "ATTR")) {
+        g_autofree gchar *attribute = NULL;
+
+        attribute = g_strdup (&parameter[5]);
+        g_strdelimit (attribute, "{}", ' ');
+        g_strstrip (attribute);
+
+        if (g_str_equal (attribute, "idVendor") || g_str_equal (attribute, "vendor"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_VENDOR_ID;
+        else if (g_str_equal (attribute, "idProduct") || g_str_equal (attribute, "device"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT_ID;
+        else if (g_str_equal (attribute, "manufacturer"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_MANUFACTURER;
+        else if (g_str_equal (attribute, "product"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT;
+        else if (g_str_equal (attribute, "bInterfaceClass"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_CLASS;
+        else if (g_str_equal (attribute, "bInterfaceSubClass"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_SUBCLASS;
+        else if (g_str_equal (attribute, "bInterfaceProtocol"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_PROTOCOL;
+        else if (g_str_equal (attribute, "bInterfaceNumber"))
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_NUMBER;
+        else {
+            rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_ATTRIBUTE;
+            rule_match->name = g_intern_string (attribute);
+            rule_match->lookup_parents = g_str_has_prefix (parameter, "ATTRS");
+        }
+    } else if (g_str_has_prefix (parameter, "ENV")) {
+        g_autofree gchar *property = NULL;
+
+        property = g_strdup (&parameter[3]);
+        g_strdelimit (property, "{}", ' ');
+        g_strstrip (property);
+
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_PROPERTY;
+        rule_match->name_quark = g_quark_from_string (property);
+    } else
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN;
+
+    rule_match->value_any = g_str_equal (rule_match->value, "?*");
+    rule_match->value_uint_valid = mm_get_uint_from_hex_str (rule_match->value, &rule_match->value_uint);
+}
+
 static gboolean
 load_rule_match (MMUdevRuleMatch  *rule_match,
                  const gchar      *item,
@@ -203,6 +284,7 @@ load_rule_match (MMUdevRuleMatch  *rule_match,
     g_free (operator);
     rule_match->parameter = left;
     rule_match->value     = right;
+    compile_rule_match (rule_match);
     return TRUE;
 }
 
@@ -304,6 +386,50 @@ process_goto_tags (GArray  *rules,
     return TRUE;
 }
 
+static void
+build_vendor_index (GArray *rules,
+                    guint   first_rule_index)
+{
+    guint i;
+
+    for (i = first_rule_index; i < rules->len; i++) {
+        MMUdevRule *rule;
+        guint       j;
+
+        rule = &g_array_index (rules, MMUdevRule, i);
+        if (!rule->conditions)
+            continue;
+
+        for (j = 0; j < rule->conditions->len; j++) {
+            MMUdevRuleMatch *match;
+
+            match = &g_array_index (rule->conditions, MMUdevRuleMatch, j);
+            if (match->parameter_id == MM_UDEV_RULE_MATCH_PARAMETER_VENDOR_ID &&
+                match->type == MM_UDEV_RULE_MATCH_TYPE_EQUAL &&
+                match->value_uint_valid &&
+                match->value_uint) {
+                rule->vendor_id = match->value_uint;
+                break;
+            }
+        }
+    }
+
+    /* Walk backwards, so that each rule can reuse the skip index of the next
+     * one if both require the same vendor id */
+    for (i = rules->len; i > first_rule_index; i--) {
+        MMUdevRule *rule;
+
+        rule = &g_array_index (rules, MMUdevRule, i - 1);
+        if (!rule->vendor_id)
+            continue;
+
+        if (i < rules->len && g_array_index (rules, MMUdevRule, i).vendor_id == rule->vendor_id)
+            rule->vendor_skip_index = g_array_index (rules, MMUdevRule, i).vendor_skip_index;
+        else
+            rule->vendor_skip_index = i;
+    }
+}
+
 static gboolean
 load_rules_from_file (GArray       *rules,
                       const gchar  *path,
@@ -358,6 +484,7 @@ out:
     if (first_rule_index < rules->len && !process_goto_tags (rules, first_rule_index, error))
         return FALSE;
 
+    build_vendor_index (rules, first_rule_index);
     return TRUE;
 }
 
@@ -440,3 +567,213 @@ out:
 
     return rules;
 }
+
+/*****************************************************************************/
+
+static gboolean
+check_condition (MMUdevRulesDevice *device,
+                 MMUdevRuleMatch   *match)
+{
+    gboolean condition_equal;
+
+    condition_equal = (match->type == MM_UDEV_RULE_MATCH_TYPE_EQUAL);
+
+    switch (match->parameter_id) {
+    case MM_UDEV_RULE_MATCH_PARAMETER_ACTION:
+        /* We only apply 'add' rules */
+        return ((!!strstr (match->value, "add")) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM:
+        /* Exact SUBSYSTEM match */
+        return ((device->subsystems && !g_strcmp0 (device->subsystems[0], match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS:
+        /* Loose SUBSYSTEMS match */
+        return ((device->subsystems && g_strv_contains (device->subsystems, match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVER:
+        /* Exact DRIVER match */
+        return ((device->drivers && !g_strcmp0 (device->drivers[0], match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS:
+        /* Loose DRIVERS match */
+        return ((device->drivers && g_strv_contains (device->drivers, match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_KERNEL:
+        /* Device name checks */
+        return (mm_kernel_device_generic_string_match (device->name, match->value, device->log_object) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH:
+        /* Device sysfs path checks; we allow both a direct match and a prefix patch */
+
+        /* If sysfs path invalid (e.g. path doesn't exist), no match */
+        if (!device->sysfs_path)
+            return FALSE;
+
+        if ((mm_kernel_device_generic_string_match (device->sysfs_path, match->value, device->log_object) == condition_equal) ||
+            (match->value_prefix && mm_kernel_device_generic_string_match (device->sysfs_path, match->value_prefix, device->log_object) == condition_equal))
+            return TRUE;
+
+        if (g_str_has_prefix (device->sysfs_path, "/sys")) {
+            if ((mm_kernel_device_generic_string_match (&device->sysfs_path[4], match->value, device->log_object) == condition_equal) ||
+                (match->value_prefix && mm_kernel_device_generic_string_match (&device->sysfs_path[4], match->value_prefix, device->log_object) == condition_equal))
+                return TRUE;
+        }
+        return FALSE;
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_VENDOR_ID:
+        /* VID/PID directly from our API */
+        return (match->value_uint_valid && ((device->vendor_id == match->value_uint) == condition_equal));
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT_ID:
+        return (match->value_uint_valid && ((device->product_id == match->value_uint) == condition_equal));
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_MANUFACTURER:
+        /* manufacturer in the physdev */
+        return ((device->manufacturer && g_str_equal (device->manufacturer, match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT:
+        /* product in the physdev */
+        return ((device->product && g_str_equal (device->product, match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_CLASS:
+        /* interface class/subclass/protocol/number in the interface */
+        return (match->value_any || (match->value_uint_valid && ((device->interface_class == match->value_uint) == condition_equal)));
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_SUBCLASS:
+        return (match->value_any || (match->value_uint_valid && ((device->interface_subclass == match->value_uint) == condition_equal)));
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_PROTOCOL:
+        return (match->value_any || (match->value_uint_valid && ((device->interface_protocol == match->value_uint) == condition_equal)));
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_NUMBER:
+        return (match->value_any || (match->value_uint_valid && ((device->interface_number == match->value_uint) == condition_equal)));
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_ATTRIBUTE: {
+        g_autofree gchar *found_value = NULL;
+
+        /* Attributes checks */
+        found_value = device->lookup_attribute (device->user_data, match->name, match->lookup_parents);
+        return ((found_value && g_str_equal (found_value, match->value)) == condition_equal);
+    }
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_PROPERTY:
+        /* Previously set property checks */
+        return ((!g_strcmp0 (device->get_property (device->user_data, match->name_quark), match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN:
+    default:
+        break;
+    }
+
+    mm_obj_warn (device->log_object, "unknown match condition parameter: %s", match->parameter);
+    return FALSE;
+}
+
+static guint
+apply_rule (GArray            *rules,
+            guint              rule_i,
+            MMUdevRulesDevice *device)
+{
+    MMUdevRule *rule;
+    gboolean    apply = TRUE;
+
+    g_assert (rule_i < rules->len);
+
+    rule = &g_array_index (rules, MMUdevRule, rule_i);
+    if (rule->conditions) {
+        guint condition_i;
+
+        for (condition_i = 0; condition_i < rule->conditions->len; condition_i++) {
+            MMUdevRuleMatch *match;
+
+            match = &g_array_index (rule->conditions, MMUdevRuleMatch, condition_i);
+            if (!check_condition (device, match)) {
+                apply = FALSE;
+                break;
+            }
+        }
+    }
+
+    if (apply) {
+        switch (rule->result.type) {
+        case MM_UDEV_RULE_RESULT_TYPE_PROPERTY: {
+            MMUdevRuleResultProperty *property = &rule->result.content.property;
+            gchar                    *property_value_read = NULL;
+
+            switch (property->source) {
+            case MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_CLASS:
+                property_value_read = g_strdup_printf ("%02x", device->interface_class);
+                break;
+            case MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_SUBCLASS:
+                property_value_read = g_strdup_printf ("%02x", device->interface_subclass);
+                break;
+            case MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_PROTOCOL:
+                property_value_read = g_strdup_printf ("%02x", device->interface_protocol);
+                break;
+            case MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_NUMBER:
+                property_value_read = g_strdup_printf ("%02x", device->interface_number);
+                break;
+            case MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_VALUE:
+            default:
+                break;
+            }
+
+            /* add new property */
+            mm_obj_dbg (device->log_object, "property added: %s=%s",
+                        property->name,
+                        property_value_read ? property_value_read : property->value);
+
+            if (!property_value_read)
+                /* NOTE: the list of rules is owned by the device, so it isn't an
+                 * issue if we re-use the same string (i.e. without g_strdup-ing it)
+                 * as a property value. */
+                device->set_property (device->user_data, property->name_quark, property->value, NULL);
+            else
+                device->set_property (device->user_data, property->name_quark, property_value_read, g_free);
+            break;
+        }
+
+        case MM_UDEV_RULE_RESULT_TYPE_LABEL:
+            /* noop */
+            break;
+
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX:
+            /* Jump to a new index */
+            return rule->result.content.index;
+
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG:
+        case MM_UDEV_RULE_RESULT_TYPE_UNKNOWN:
+        default:
+            g_assert_not_reached ();
+        }
+    }
+
+    /* Go to the next rule */
+    return rule_i + 1;
+}
+
+void
+mm_kernel_device_generic_rules_apply (GArray            *rules,
+                                      MMUdevRulesDevice *device,
+                                      gboolean           use_index)
+{
+    guint i = 0;
+
+    g_assert (rules);
+    g_assert (device->lookup_attribute && device->get_property && device->set_property);
+
+    while (i < rules->len) {
+        MMUdevRule *rule;
+
+        /* Skip all consecutive rules that require a different vendor, none
+         * of them would apply */
+        rule = &g_array_index (rules, MMUdevRule, i);
+        if (use_index && rule->vendor_id && rule->vendor_id != device->vendor_id) {
+            i = rule->vendor_skip_index;
+            continue;
+        }
+
+        i = apply_rule (rules, i, device);
+    }
+}
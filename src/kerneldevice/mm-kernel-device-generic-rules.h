@@ -23,10 +23,41 @@ typedef enum {
     MM_UDEV_RULE_MATCH_TYPE_NOT_EQUAL,
 } MMUdevRuleMatchType;
 
+typedef enum {
+    MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN,
+    MM_UDEV_RULE_MATCH_PARAMETER_ACTION,
+    MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM,
+    MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS,
+    MM_UDEV_RULE_MATCH_PARAMETER_DRIVER,
+    MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS,
+    MM_UDEV_RULE_MATCH_PARAMETER_KERNEL,
+    MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH,
+    MM_UDEV_RULE_MATCH_PARAMETER_VENDOR_ID,
+    MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT_ID,
+    MM_UDEV_RULE_MATCH_PARAMETER_MANUFACTURER,
+    MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT,
+    MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_CLASS,
+    MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_SUBCLASS,
+    MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_PROTOCOL,
+    MM_UDEV_RULE_MATCH_PARAMETER_INTERFACE_NUMBER,
+    MM_UDEV_RULE_MATCH_PARAMETER_ATTRIBUTE,
+    MM_UDEV_RULE_MATCH_PARAMETER_PROPERTY,
+} MMUdevRuleMatchParameter;
+
 typedef struct {
     MMUdevRuleMatchType  type;
     gchar               *parameter;
     gchar               *value;
+
+    /* Precompiled when loading the rule */
+    MMUdevRuleMatchParameter  parameter_id;
+    const gchar              *name;           /* interned attribute name */
+    GQuark                    name_quark;     /* property name */
+    gboolean                  lookup_parents; /* ATTRS instead of ATTR */
+    gboolean                  value_any;      /* value is "?*" */
+    gboolean                  value_uint_valid;
+    guint                     value_uint;
+    gchar                    *value_prefix;   /* implicit DEVPATH prefix match */
 } MMUdevRuleMatch;
 
 typedef enum {
@@ -37,9 +68,20 @@ typedef enum {
     MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG, /* internal use only */
 } MMUdevRuleResultType;
 
+typedef enum {
+    MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_VALUE,
+    MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_CLASS,
+    MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_SUBCLASS,
+    MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_PROTOCOL,
+    MM_UDEV_RULE_RESULT_PROPERTY_SOURCE_INTERFACE_NUMBER,
+} MMUdevRuleResultPropertySource;
+
 typedef struct {
-    gchar *name;
-    gchar *value;
+    gchar                          *name;
+    gchar                          *value;
+    /* Precompiled when loading the rule */
+    GQuark                          name_quark;
+    MMUdevRuleResultPropertySource  source;
 } MMUdevRuleResultProperty;
 
 typedef struct {
@@ -54,9 +96,54 @@ typedef struct {
 typedef struct {
     GArray           *conditions;
     MMUdevRuleResult  result;
+
+    /* Index built when loading the rules: if the rule only applies to a given
+     * vendor id, the index of the first rule after the sequence of rules
+     * requiring the same vendor id, so that they can all be skipped at once
+     * for devices of other vendors. */
+    guint             vendor_id;
+    guint             vendor_skip_index;
 } MMUdevRule;
 
 GArray *mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
                                              GError      **error);
 
+/* Device information the rules are applied to */
+typedef struct _MMUdevRulesDevice MMUdevRulesDevice;
+struct _MMUdevRulesDevice {
+    const gchar         *name;
+    const gchar         *sysfs_path;
+    const gchar * const *subsystems;
+    const gchar * const *drivers;
+    guint16              vendor_id;
+    guint16              product_id;
+    const gchar         *manufacturer;
+    const gchar         *product;
+    guint8               interface_class;
+    guint8               interface_subclass;
+    guint8               interface_protocol;
+    guint8               interface_number;
+
+    /* Lookup of any other sysfs attribute, in the device itself or also in
+     * its parents */
+    gchar       * (* lookup_attribute) (gpointer     user_data,
+                                        const gchar *attribute,
+                                        gboolean     lookup_parents);
+    /* Properties previously set by the rules */
+    const gchar * (* get_property)     (gpointer        user_data,
+                                        GQuark          property);
+    void          (* set_property)     (gpointer        user_data,
+                                        GQuark          property,
+                                        gchar          *value,
+                                        GDestroyNotify  value_free);
+    gpointer             user_data;
+    gpointer             log_object;
+};
+
+/* Apply the rules to the device. The vendor index should only be disabled
+ * for benchmarking purposes. */
+void mm_kernel_device_generic_rules_apply (GArray            *rules,
+                                           MMUdevRulesDevice *device,
+                                           gboolean           use_index);
+
 G_END_DECLS
@@ -739,225 +739,59 @@ kernel_device_cmp (MMKernelDevice *a,
 
 /*****************************************************************************/
 
-static gboolean
-check_condition (MMKernelDeviceGeneric *self,
-                 MMUdevRuleMatch       *match)
+static gchar *
+rules_device_lookup_attribute (gpointer     self,
+                               const gchar *attribute,
+                               gboolean     lookup_parents)
 {
-    gboolean condition_equal;
-
-    condition_equal = (match->type == MM_UDEV_RULE_MATCH_TYPE_EQUAL);
-
-    /* We only apply 'add' rules */
-    if (g_str_equal (match->parameter, "ACTION"))
-        return ((!!strstr (match->value, "add")) == condition_equal);
-
-    /* Exact SUBSYSTEM match */
-    if (g_str_equal (match->parameter, "SUBSYSTEM"))
-        return ((self->priv->subsystems && !g_strcmp0 (self->priv->subsystems[0], match->value)) == condition_equal);
-
-    /* Loose SUBSYSTEMS match */
-    if (g_str_equal (match->parameter, "SUBSYSTEMS"))
-        return ((self->priv->subsystems && g_strv_contains ((const gchar * const *) self->priv->subsystems, match->value)) == condition_equal);
-
-    /* Exact DRIVER match */
-    if (g_str_equal (match->parameter, "DRIVER"))
-        return ((self->priv->drivers && !g_strcmp0 (self->priv->drivers[0], match->value)) == condition_equal);
-
-    /* Loose DRIVERS match */
-    if (g_str_equal (match->parameter, "DRIVERS"))
-        return ((self->priv->drivers && g_strv_contains ((const gchar * const *) self->priv->drivers, match->value)) == condition_equal);
-
-    /* Device name checks */
-    if (g_str_equal (match->parameter, "KERNEL"))
-        return (mm_kernel_device_generic_string_match (mm_kernel_device_get_name (MM_KERNEL_DEVICE (self)), match->value, self) == condition_equal);
-
-    /* Device sysfs path checks; we allow both a direct match and a prefix patch */
-    if (g_str_equal (match->parameter, "DEVPATH")) {
-        g_autofree gchar *prefix_match = NULL;
-
-        /* If sysfs path invalid (e.g. path doesn't exist), no match */
-        if (!self->priv->sysfs_path)
-            return FALSE;
-
-        /* If not already doing a prefix match, do an implicit one. This is so that
-         * we can add properties to the usb_device owning all ports, and then apply
-         * the property to all ports individually processed here. */
-        if (match->value[0] && match->value[strlen (match->value) - 1] != '*')
-            prefix_match = g_strdup_printf ("%s/*", match->value);
-
-        if ((mm_kernel_device_generic_string_match (self->priv->sysfs_path, match->value, self) == condition_equal) ||
-            (prefix_match && mm_kernel_device_generic_string_match (self->priv->sysfs_path, prefix_match, self) == condition_equal))
-            return TRUE;
-
-        if (g_str_has_prefix (self->priv->sysfs_path, "/sys")) {
-            if ((mm_kernel_device_generic_string_match (&self->priv->sysfs_path[4], match->value, self) == condition_equal) ||
-                (prefix_match && mm_kernel_device_generic_string_match (&self->priv->sysfs_path[4], prefix_match, self) == condition_equal))
-                return TRUE;
-        }
-        return FALSE;
-    }
-
-    /* Attributes checks */
-    if (g_str_has_prefix (match->parameter, "ATTR")) {
-        gchar    *attribute;
-        gchar    *contents = NULL;
-        gboolean  result = FALSE;
-        guint     val;
-
-        attribute = g_strdup (&match->parameter[5]);
-        g_strdelimit (attribute, "{}", ' ');
-        g_strstrip (attribute);
-
-        /* VID/PID directly from our API */
-        if (g_str_equal (attribute, "idVendor") || g_str_equal (attribute, "vendor"))
-            result = ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                      ((mm_kernel_device_get_physdev_vid (MM_KERNEL_DEVICE (self)) == val) == condition_equal));
-        else if (g_str_equal (attribute, "idProduct") || g_str_equal (attribute, "device"))
-            result = ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                      ((mm_kernel_device_get_physdev_pid (MM_KERNEL_DEVICE (self)) == val) == condition_equal));
-        /* manufacturer in the physdev */
-        else if (g_str_equal (attribute, "manufacturer"))
-            result = ((self->priv->physdev_manufacturer && g_str_equal (self->priv->physdev_manufacturer, match->value)) == condition_equal);
-        /* product in the physdev */
-        else if (g_str_equal (attribute, "product"))
-            result = ((self->priv->physdev_product && g_str_equal (self->priv->physdev_product, match->value)) == condition_equal);
-        /* interface class/subclass/protocol/number in the interface */
-        else if (g_str_equal (attribute, "bInterfaceClass"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_class == val) == condition_equal)));
-        else if (g_str_equal (attribute, "bInterfaceSubClass"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_subclass == val) == condition_equal)));
-        else if (g_str_equal (attribute, "bInterfaceProtocol"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_protocol == val) == condition_equal)));
-        else if (g_str_equal (attribute, "bInterfaceNumber"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_number == val) == condition_equal)));
-        else {
-            g_autofree gchar *found_value = NULL;
-
-            found_value = lookup_sysfs_attribute_as_string (self, attribute, g_str_has_prefix (match->parameter, "ATTRS"));
-            result = ((found_value && g_str_equal (found_value, match->value)) == condition_equal);
-        }
-
-        g_free (contents);
-        g_free (attribute);
-        return result;
-    }
-
-    /* Previously set property checks */
-    if (g_str_has_prefix (match->parameter, "ENV")) {
-        gchar    *property;
-        gboolean  result = FALSE;
-
-        property = g_strdup (&match->parameter[3]);
-        g_strdelimit (property, "{}", ' ');
-        g_strstrip (property);
-
-        result = ((!g_strcmp0 ((const gchar *) g_object_get_data (G_OBJECT (self), property), match->value)) == condition_equal);
-
-        g_free (property);
-        return result;
-    }
-
-    mm_obj_warn (self, "unknown match condition parameter: %s", match->parameter);
-    return FALSE;
+    return lookup_sysfs_attribute_as_string (MM_KERNEL_DEVICE_GENERIC (self), attribute, lookup_parents);
 }
 
-static guint
-check_rule (MMKernelDeviceGeneric *self,
-            guint                  rule_i)
+static const gchar *
+rules_device_get_property (gpointer self,
+                           GQuark   property)
 {
-    MMUdevRule *rule;
-    gboolean    apply = TRUE;
-
-    g_assert (rule_i < self->priv->rules->len);
-
-    rule = &g_array_index (self->priv->rules, MMUdevRule, rule_i);
-    if (rule->conditions) {
-        guint condition_i;
-
-        for (condition_i = 0; condition_i < rule->conditions->len; condition_i++) {
-            MMUdevRuleMatch *match;
-
-            match = &g_array_index (rule->conditions, MMUdevRuleMatch, condition_i);
-            if (!check_condition (self, match)) {
-                apply = FALSE;
-                break;
-            }
-        }
-    }
-
-    if (apply) {
-        switch (rule->result.type) {
-        case MM_UDEV_RULE_RESULT_TYPE_PROPERTY: {
-            gchar *property_value_read = NULL;
-
-            if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceClass}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_class);
-            else if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceSubClass}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_subclass);
-            else if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceProtocol}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_protocol);
-            else if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceNumber}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_number);
-
-            /* add new property */
-            mm_obj_dbg (self, "property added: %s=%s",
-                        rule->result.content.property.name,
-                        property_value_read ? property_value_read : rule->result.content.property.value);
-
-            if (!property_value_read)
-                /* NOTE: we keep a reference to the list of rules ourselves, so it isn't
-                 * an issue if we re-use the same string (i.e. without g_strdup-ing it)
-                 * as a property value. */
-                g_object_set_data (G_OBJECT (self),
-                                   rule->result.content.property.name,
-                                   rule->result.content.property.value);
-            else
-                g_object_set_data_full (G_OBJECT (self),
-                                        rule->result.content.property.name,
-                                        property_value_read,
-                                        g_free);
-            break;
-        }
-
-        case MM_UDEV_RULE_RESULT_TYPE_LABEL:
-            /* noop */
-            break;
-
-        case MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX:
-            /* Jump to a new index */
-            return rule->result.content.index;
-
-        case MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG:
-        case MM_UDEV_RULE_RESULT_TYPE_UNKNOWN:
-        default:
-            g_assert_not_reached ();
-        }
-    }
+    return (const gchar *) g_object_get_qdata (G_OBJECT (self), property);
+}
 
-    /* Go to the next rule */
-    return rule_i + 1;
+static void
+rules_device_set_property (gpointer        self,
+                           GQuark          property,
+                           gchar          *value,
+                           GDestroyNotify  value_free)
+{
+    /* NOTE: we keep a reference to the list of rules ourselves, so it isn't
+     * an issue if the value is a string owned by the rules. */
+    g_object_set_qdata_full (G_OBJECT (self), property, value, value_free);
 }
 
 static void
 preload_rule_properties (MMKernelDeviceGeneric *self)
 {
-    guint i;
+    MMUdevRulesDevice device = {
+        .name               = mm_kernel_device_get_name (MM_KERNEL_DEVICE (self)),
+        .sysfs_path         = self->priv->sysfs_path,
+        .subsystems         = (const gchar * const *) self->priv->subsystems,
+        .drivers            = (const gchar * const *) self->priv->drivers,
+        .vendor_id          = self->priv->physdev_vid,
+        .product_id         = self->priv->physdev_pid,
+        .manufacturer       = self->priv->physdev_manufacturer,
+        .product            = self->priv->physdev_product,
+        .interface_class    = self->priv->interface_class,
+        .interface_subclass = self->priv->interface_subclass,
+        .interface_protocol = self->priv->interface_protocol,
+        .interface_number   = self->priv->interface_number,
+        .lookup_attribute   = rules_device_lookup_attribute,
+        .get_property       = rules_device_get_property,
+        .set_property       = rules_device_set_property,
+        .user_data          = self,
+        .log_object         = self,
+    };
 
     g_assert (self->priv->rules);
     g_assert (self->priv->rules->len > 0);
 
-    /* Start to process rules */
-    i = 0;
-    while (i < self->priv->rules->len) {
-        guint next_rule;
-
-        next_rule = check_rule (self, i);
-        i = next_rule;
-    }
+    mm_kernel_device_generic_rules_apply (self->priv->rules, &device, TRUE);
 }
 
 static void
@@ -14,6 +14,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib-object.h>
@@ -65,6 +66,134 @@ mm_kernel_device_get_lower_device_name (const gchar *sysfs_path)
 
 /******************************************************************************/
 
+/* Interface classes never exposing ports */
+static const guint8 usb_non_port_interface_classes[] = {
+    0x01, /* audio */
+    0x03, /* HID */
+    0x07, /* printer */
+    0x08, /* mass storage */
+    0x0a, /* CDC data, ports are exposed in the CDC control interface */
+    0x0e, /* video */
+};
+
+/* Drivers never exposing ports */
+static const gchar *usb_non_port_drivers[] = {
+    "usbfs",
+    "usb-storage",
+    "uas",
+    "usbhid",
+    "snd-usb-audio",
+    "uvcvideo",
+};
+
+static gchar *
+read_sysfs_attribute (const gchar *path,
+                      const gchar *attribute)
+{
+    g_autofree gchar *aux = NULL;
+    gchar            *contents = NULL;
+
+    aux = g_build_filename (path, attribute, NULL);
+    if (!g_file_get_contents (aux, &contents, NULL, NULL))
+        return NULL;
+    return g_strstrip (contents);
+}
+
+gboolean
+mm_kernel_device_get_usb_port_interfaces (const gchar *physdev_sysfs_path,
+                                          guint64     *interfaces)
+{
+    g_autoptr(GFile)           dirfile = NULL;
+    g_autoptr(GFileEnumerator) direnum = NULL;
+    g_autofree gchar          *num_interfaces_str = NULL;
+    guint                      num_interfaces;
+    guint                      n_found = 0;
+    guint64                    mask = 0;
+
+    num_interfaces_str = read_sysfs_attribute (physdev_sysfs_path, "bNumInterfaces");
+    if (!num_interfaces_str)
+        return FALSE;
+    num_interfaces = (guint) strtoul (num_interfaces_str, NULL, 10);
+    if (!num_interfaces)
+        return FALSE;
+
+    dirfile = g_file_new_for_path (physdev_sysfs_path);
+    direnum = g_file_enumerate_children (dirfile,
+                                         G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                         G_FILE_QUERY_INFO_NONE,
+                                         NULL,
+                                         NULL);
+    if (!direnum)
+        return FALSE;
+
+    while (TRUE) {
+        GFileInfo        *info;
+        g_autofree gchar *filename = NULL;
+        g_autofree gchar *interface_path = NULL;
+        g_autofree gchar *number_str = NULL;
+        g_autofree gchar *class_str = NULL;
+        g_autofree gchar *driver_link = NULL;
+        g_autofree gchar *driver_path = NULL;
+        g_autofree gchar *driver = NULL;
+        guint             number;
+        guint             class;
+        guint             i;
+
+        if (!g_file_enumerator_iterate (direnum, &info, NULL, NULL, NULL) || !info)
+            break;
+
+        /* Interfaces are named as <busnum>-<devpath>:<config>.<interface> */
+        filename = g_file_info_get_attribute_as_string (info, G_FILE_ATTRIBUTE_STANDARD_NAME);
+        if (!filename || !strchr (filename, ':'))
+            continue;
+
+        interface_path = g_build_filename (physdev_sysfs_path, filename, NULL);
+        number_str = read_sysfs_attribute (interface_path, "bInterfaceNumber");
+        class_str = read_sysfs_attribute (interface_path, "bInterfaceClass");
+        if (!number_str || !class_str)
+            continue;
+        n_found++;
+
+        number = (guint) strtoul (number_str, NULL, 16);
+        class = (guint) strtoul (class_str, NULL, 16);
+        if (number >= 64)
+            return FALSE;
+
+        for (i = 0; i < G_N_ELEMENTS (usb_non_port_interface_classes); i++) {
+            if (class == usb_non_port_interface_classes[i])
+                break;
+        }
+        if (i < G_N_ELEMENTS (usb_non_port_interface_classes))
+            continue;
+
+        /* If the interface is not bound to a driver yet, we cannot know
+         * whether it will expose ports or not */
+        driver_link = g_build_filename (interface_path, "driver", NULL);
+        driver_path = realpath (driver_link, NULL);
+        if (!driver_path)
+            return FALSE;
+
+        driver = g_path_get_basename (driver_path);
+        for (i = 0; i < G_N_ELEMENTS (usb_non_port_drivers); i++) {
+            if (g_str_equal (driver, usb_non_port_drivers[i]))
+                break;
+        }
+        if (i < G_N_ELEMENTS (usb_non_port_drivers))
+            continue;
+
+        mask |= ((guint64) 1 << number);
+    }
+
+    /* Not all interfaces registered yet */
+    if (n_found < num_interfaces)
+        return FALSE;
+
+    *interfaces = mask;
+    return (mask != 0);
+}
+
+/******************************************************************************/
+
 static gchar *
 build_string_match_pattern (const gchar *str)
 {
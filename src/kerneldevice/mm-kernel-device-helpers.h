@@ -23,6 +23,14 @@
  * (e.g. lower_device_name(qmimux0) == wwan0) */
 gchar *mm_kernel_device_get_lower_device_name (const gchar *sysfs_path);
 
+/* For USB devices, get the mask of interface numbers which are expected to
+ * expose ports (TTYs, net interfaces, cdc-wdm devices...), based on the class
+ * of each interface and on the driver bound to it. Returns FALSE if the set of
+ * ports cannot be known yet, e.g. if not all interfaces have been registered
+ * or if some of them are not bound to a driver. */
+gboolean mm_kernel_device_get_usb_port_interfaces (const gchar *physdev_sysfs_path,
+                                                   guint64     *interfaces);
+
 /* Generic string matching logic */
 gboolean mm_kernel_device_generic_string_match (const gchar *str,
                                                 const gchar *pattern,
@@ -20,6 +20,7 @@
 #include <libmm-glib.h>
 
 #include "mm-kernel-device.h"
+#include "mm-kernel-device-helpers.h"
 #include "mm-log-object.h"
 
 static void log_object_iface_init (MMLogObjectInterface *iface);
@@ -177,6 +178,27 @@ mm_kernel_device_get_physdev_product (MMKernelDevice *self)
             NULL);
 }
 
+gboolean
+mm_kernel_device_get_physdev_port_interfaces (MMKernelDevice *self,
+                                              guint64        *interfaces)
+{
+    const gchar *physdev_sysfs_path;
+
+    /* when a lower device is available, physdev info taken from it */
+    if (self->priv->lower_device)
+        return mm_kernel_device_get_physdev_port_interfaces (self->priv->lower_device, interfaces);
+
+    /* Only USB devices report which interfaces they have */
+    if (g_strcmp0 (mm_kernel_device_get_physdev_subsystem (self), "usb") != 0)
+        return FALSE;
+
+    physdev_sysfs_path = mm_kernel_device_get_physdev_sysfs_path (self);
+    if (!physdev_sysfs_path)
+        return FALSE;
+
+    return mm_kernel_device_get_usb_port_interfaces (physdev_sysfs_path, interfaces);
+}
+
 MMKernelDevice *
 mm_kernel_device_peek_lower_device (MMKernelDevice *self)
 {
@@ -97,6 +97,9 @@ const gchar *mm_kernel_device_get_physdev_subsystem    (MMKernelDevice *self);
 const gchar *mm_kernel_device_get_physdev_manufacturer (MMKernelDevice *self);
 const gchar *mm_kernel_device_get_physdev_product      (MMKernelDevice *self);
 
+gboolean     mm_kernel_device_get_physdev_port_interfaces (MMKernelDevice *self,
+                                                           guint64        *interfaces);
+
 MMKernelDevice *mm_kernel_device_peek_lower_device (MMKernelDevice *self);
 
 gboolean     mm_kernel_device_cmp (MMKernelDevice *a, MMKernelDevice *b);
@@ -30,6 +30,8 @@
 #include "mm-log.h"
 #include "mm-base-manager.h"
 #include "mm-context.h"
+#include "mm-identity-cache.h"
+#include "mm-serial-parsers.h"
 
 #if defined WITH_SYSTEMD_SUSPEND_RESUME
 # include "mm-sleep-monitor.h"
@@ -183,6 +185,15 @@ main (int argc, char *argv[])
     /* Detect runtime charset conversion support */
     mm_modem_charsets_init ();
 
+    /* Select AT response parser implementation */
+    mm_serial_parser_v1_set_legacy (mm_context_get_test_legacy_at_parser ());
+
+    /* Load the persistent identity cache, never used in test sessions */
+    if (mm_context_get_no_identity_cache () || mm_context_get_test_session ())
+        mm_identity_cache_setup (NULL);
+    else
+        mm_identity_cache_setup (PKGSTATEDIR G_DIR_SEPARATOR_S MM_IDENTITY_CACHE_FILENAME);
+
     /* Acquire name, don't allow replacement */
     name_id = g_bus_own_name (mm_context_get_test_session () ? G_BUS_TYPE_SESSION : G_BUS_TYPE_SYSTEM,
                               MM_DBUS_SERVICE,
@@ -198,7 +209,7 @@ main (int argc, char *argv[])
 
         if (mm_context_get_test_no_suspend_resume())
             mm_dbg ("Suspend/resume support disabled at runtime");
-        else if (mm_context_get_test_quick_suspend_resume()) {
+        else if (mm_context_get_quick_suspend_resume () || mm_context_get_test_quick_suspend_resume ()) {
             mm_dbg ("Quick suspend/resume hooks enabled");
             sleep_monitor = mm_sleep_monitor_get ();
             g_signal_connect (sleep_monitor, MM_SLEEP_MONITOR_RESUMING, G_CALLBACK (resuming_quick_cb), NULL);
@@ -249,6 +260,8 @@ main (int argc, char *argv[])
 
     g_bus_unown_name (name_id);
 
+    mm_identity_cache_shutdown ();
+
     mm_info ("ModemManager is shut down");
 
     mm_log_shutdown ();
@@ -39,6 +39,8 @@
 #include "mm-modem-helpers.h"
 #include "mm-error-helpers.h"
 #include "mm-bearer-stats.h"
+#include "mm-port-net.h"
+#include "mm-timer-wheel.h"
 
 /* We require up to 20s to get a proper IP when using PPP */
 #define BEARER_IP_TIMEOUT_DEFAULT 20
@@ -47,9 +49,16 @@
 
 #define BEARER_STATS_UPDATE_TIMEOUT 30
 
-/* Initial connectivity check after 30s, then each 5s */
+/* Reading the kernel counters of the data interface is cheap and doesn't
+ * involve the modem at all, so they can be refreshed more often */
+#define BEARER_STATS_NETDEV_UPDATE_TIMEOUT 10
+
+/* Initial connectivity check after 30s, then each 5s (polling mode) */
 #define BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT 30
 #define BEARER_CONNECTION_MONITOR_TIMEOUT          5
+/* Once the modem is known to report connection status changes by itself,
+ * polling is only kept as a safety net, backing off up to this interval */
+#define BEARER_CONNECTION_MONITOR_MAX_TIMEOUT     60
 
 static void log_object_iface_init (MMLogObjectInterface *iface);
 
@@ -102,6 +111,17 @@ struct _MMBaseBearerPrivate {
     guint connection_monitor_id;
     /* Flag to specify whether connection monitoring is supported or not */
     gboolean load_connection_status_unsupported;
+    /* Current connection monitoring interval, in seconds */
+    guint connection_monitor_timeout;
+    /* Flag to specify whether the modem is known to report connection status
+     * changes via indications, so that polling can be backed off */
+    gboolean connection_indications_confirmed;
+    /* Set while reporting a status found out by ModemManager itself, i.e. not
+     * received as an indication */
+    gboolean reporting_internal_connection_status;
+    /* Number of connection status polls and indications */
+    guint n_connection_polls;
+    guint n_connection_indications;
 
     /*-- 3GPP specific --*/
     guint deferred_3gpp_unregistration_id;
@@ -126,6 +146,15 @@ struct _MMBaseBearerPrivate {
     GTimer *duration_timer;
     /* Flag to specify whether reloading stats is supported or not */
     gboolean reload_stats_unsupported;
+    /* Data interface whose kernel counters are used as stats source, if any */
+    MMPortNet *stats_netdev;
+    /* Kernel counters of the data interface when the connection started */
+    gboolean   stats_netdev_baseline_set;
+    guint64    stats_netdev_rx_baseline;
+    guint64    stats_netdev_tx_baseline;
+    /* Bytes already reported before the kernel counters were last reset */
+    guint64    stats_netdev_rx_offset;
+    guint64    stats_netdev_tx_offset;
 };
 
 /*****************************************************************************/
@@ -157,11 +186,20 @@ static void
 connection_monitor_stop (MMBaseBearer *self)
 {
     if (self->priv->connection_monitor_id) {
-        g_source_remove (self->priv->connection_monitor_id);
+        mm_timer_wheel_remove (mm_timer_wheel_get (), self->priv->connection_monitor_id);
         self->priv->connection_monitor_id = 0;
     }
 }
 
+static void
+report_connection_status_internal (MMBaseBearer             *self,
+                                   MMBearerConnectionStatus  status)
+{
+    self->priv->reporting_internal_connection_status = TRUE;
+    mm_base_bearer_report_connection_status (self, status);
+    self->priv->reporting_internal_connection_status = FALSE;
+}
+
 static void
 load_connection_status_ready (MMBaseBearer *self,
                               GAsyncResult *res)
@@ -190,36 +228,59 @@ load_connection_status_ready (MMBaseBearer *self,
     /* Report connection or disconnection */
     g_assert (status == MM_BEARER_CONNECTION_STATUS_CONNECTED || status == MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
     mm_obj_dbg (self, "connection status loaded: %s", mm_bearer_connection_status_get_string (status));
-    mm_base_bearer_report_connection_status (self, status);
+
+    /* If the safety net caught a disconnection that wasn't indicated, we
+     * cannot rely on indications any more */
+    if (status == MM_BEARER_CONNECTION_STATUS_DISCONNECTED &&
+        self->priv->status == MM_BEARER_STATUS_CONNECTED &&
+        self->priv->connection_indications_confirmed) {
+        mm_obj_dbg (self, "disconnection not indicated by the modem: connection monitoring back to regular polling");
+        self->priv->connection_indications_confirmed = FALSE;
+    }
+
+    report_connection_status_internal (self, status);
 }
 
-static gboolean
-connection_monitor_cb (MMBaseBearer *self)
+static gboolean connection_monitor_cb (MMBaseBearer *self);
+
+static void
+connection_monitor_schedule (MMBaseBearer *self,
+                             guint         timeout)
 {
-    /* If the implementation knows how to load connection status, run it */
-    if (self->priv->status == MM_BEARER_STATUS_CONNECTED)
-        MM_BASE_BEARER_GET_CLASS (self)->load_connection_status (
-            self,
-            (GAsyncReadyCallback)load_connection_status_ready,
-            NULL);
-    return G_SOURCE_CONTINUE;
+    connection_monitor_stop (self);
+    self->priv->connection_monitor_timeout = timeout;
+    self->priv->connection_monitor_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                                    self,
+                                                                    "connection-monitor",
+                                                                    timeout,
+                                                                    (GSourceFunc) connection_monitor_cb,
+                                                                    self);
 }
 
 static gboolean
-initial_connection_monitor_cb (MMBaseBearer *self)
+connection_monitor_cb (MMBaseBearer *self)
 {
-    if (self->priv->status == MM_BEARER_STATUS_CONNECTED)
+    guint timeout;
+
+    self->priv->connection_monitor_id = 0;
+
+    /* If the implementation knows how to load connection status, run it */
+    if (self->priv->status == MM_BEARER_STATUS_CONNECTED) {
+        self->priv->n_connection_polls++;
         MM_BASE_BEARER_GET_CLASS (self)->load_connection_status (
             self,
             (GAsyncReadyCallback)load_connection_status_ready,
             NULL);
+    }
 
-    /* Add new monitor timeout at a higher rate */
-    self->priv->connection_monitor_id = g_timeout_add_seconds (BEARER_CONNECTION_MONITOR_TIMEOUT,
-                                                               (GSourceFunc) connection_monitor_cb,
-                                                               self);
+    /* Keep on polling at a high rate, unless the modem is known to report
+     * connection status changes itself; then just back off */
+    if (self->priv->connection_indications_confirmed)
+        timeout = MIN (self->priv->connection_monitor_timeout * 2, BEARER_CONNECTION_MONITOR_MAX_TIMEOUT);
+    else
+        timeout = BEARER_CONNECTION_MONITOR_TIMEOUT;
+    connection_monitor_schedule (self, timeout);
 
-    /* Remove the initial connection monitor timeout as we added a new one */
     return G_SOURCE_REMOVE;
 }
 
@@ -236,9 +297,7 @@ connection_monitor_start (MMBaseBearer *self)
 
     /* Schedule initial check */
     g_assert (!self->priv->connection_monitor_id);
-    self->priv->connection_monitor_id = g_timeout_add_seconds (BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT,
-                                                               (GSourceFunc) initial_connection_monitor_cb,
-                                                               self);
+    connection_monitor_schedule (self, BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT);
 }
 
 /*****************************************************************************/
@@ -381,7 +440,7 @@ bearer_stats_stop (MMBaseBearer *self)
     }
 
     if (self->priv->stats_update_id) {
-        g_source_remove (self->priv->stats_update_id);
+        mm_timer_wheel_remove (mm_timer_wheel_get (), self->priv->stats_update_id);
         self->priv->stats_update_id = 0;
     }
 }
@@ -418,13 +477,9 @@ reload_stats_ready (MMBaseBearer *self,
                                         tx_bytes);
 }
 
-static gboolean
-stats_update_cb (MMBaseBearer *self)
+static void
+bearer_reload_modem_stats (MMBaseBearer *self)
 {
-    /* Ignore stats update if we're not connected */
-    if (self->priv->status != MM_BEARER_STATUS_CONNECTED)
-        return G_SOURCE_CONTINUE;
-
     /* If the implementation knows how to update stat values, run it */
     if (!self->priv->reload_stats_unsupported &&
         MM_BASE_BEARER_GET_CLASS (self)->reload_stats &&
@@ -433,7 +488,7 @@ stats_update_cb (MMBaseBearer *self)
             self,
             (GAsyncReadyCallback)reload_stats_ready,
             NULL);
-        return G_SOURCE_CONTINUE;
+        return;
     }
 
     /* Otherwise, just update duration and we're done */
@@ -441,21 +496,117 @@ stats_update_cb (MMBaseBearer *self)
                                         (guint32) g_timer_elapsed (self->priv->duration_timer, NULL),
                                         0,
                                         0);
+}
+
+static gboolean stats_update_cb (MMBaseBearer *self);
+
+static void
+bearer_stats_schedule (MMBaseBearer *self)
+{
+    if (self->priv->stats_update_id)
+        mm_timer_wheel_remove (mm_timer_wheel_get (), self->priv->stats_update_id);
+    self->priv->stats_update_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                              self,
+                                                              "stats-update",
+                                                              self->priv->stats_netdev ?
+                                                              BEARER_STATS_NETDEV_UPDATE_TIMEOUT :
+                                                              BEARER_STATS_UPDATE_TIMEOUT,
+                                                              (GSourceFunc) stats_update_cb,
+                                                              self);
+}
+
+static void
+netdev_reload_stats_ready (MMPortNet    *port,
+                           GAsyncResult *res,
+                           MMBaseBearer *self)
+{
+    g_autoptr(GError) error = NULL;
+    guint64           rx_bytes = 0;
+    guint64           tx_bytes = 0;
+
+    if (!mm_port_net_reload_stats_finish (port, res, &rx_bytes, &tx_bytes, &error)) {
+        /* Only fall back to the modem if the interface is still the one in use */
+        if (self->priv->stats_netdev == port && self->priv->duration_timer) {
+            mm_obj_dbg (self, "couldn't read kernel stats of %s, falling back to modem stats: %s",
+                        mm_port_get_device (MM_PORT (port)), error->message);
+            g_clear_object (&self->priv->stats_netdev);
+            bearer_stats_schedule (self);
+            bearer_reload_modem_stats (self);
+        }
+        g_object_unref (self);
+        return;
+    }
+
+    /* Ignore results that arrive after a disconnection or reconnection */
+    if (self->priv->stats_netdev != port || !self->priv->duration_timer) {
+        g_object_unref (self);
+        return;
+    }
+
+    /* The kernel counters are not reset on connection, so report them
+     * relative to the ones found when the connection started. If they
+     * ever go backwards, the interface was recreated and counts from 0,
+     * so keep on counting from the values already reported. */
+    if (!self->priv->stats_netdev_baseline_set) {
+        self->priv->stats_netdev_baseline_set = TRUE;
+        self->priv->stats_netdev_rx_baseline = rx_bytes;
+        self->priv->stats_netdev_tx_baseline = tx_bytes;
+        self->priv->stats_netdev_rx_offset = 0;
+        self->priv->stats_netdev_tx_offset = 0;
+    } else if (self->priv->stats_netdev_rx_offset + rx_bytes < self->priv->stats_netdev_rx_baseline + mm_bearer_stats_get_rx_bytes (self->priv->stats) ||
+               self->priv->stats_netdev_tx_offset + tx_bytes < self->priv->stats_netdev_tx_baseline + mm_bearer_stats_get_tx_bytes (self->priv->stats)) {
+        mm_obj_dbg (self, "kernel stats of %s were reset", mm_port_get_device (MM_PORT (port)));
+        self->priv->stats_netdev_rx_baseline = 0;
+        self->priv->stats_netdev_tx_baseline = 0;
+        self->priv->stats_netdev_rx_offset = mm_bearer_stats_get_rx_bytes (self->priv->stats);
+        self->priv->stats_netdev_tx_offset = mm_bearer_stats_get_tx_bytes (self->priv->stats);
+    }
+
+    bearer_set_ongoing_interface_stats (self,
+                                        (guint32) g_timer_elapsed (self->priv->duration_timer, NULL),
+                                        self->priv->stats_netdev_rx_offset + rx_bytes - self->priv->stats_netdev_rx_baseline,
+                                        self->priv->stats_netdev_tx_offset + tx_bytes - self->priv->stats_netdev_tx_baseline);
+    g_object_unref (self);
+}
+
+static gboolean
+stats_update_cb (MMBaseBearer *self)
+{
+    /* Ignore stats update if we're not connected */
+    if (self->priv->status != MM_BEARER_STATUS_CONNECTED)
+        return G_SOURCE_CONTINUE;
+
+    /* Prefer the kernel counters of the data interface, if any */
+    if (self->priv->stats_netdev) {
+        mm_port_net_reload_stats (self->priv->stats_netdev,
+                                  NULL,
+                                  (GAsyncReadyCallback)netdev_reload_stats_ready,
+                                  g_object_ref (self));
+        return G_SOURCE_CONTINUE;
+    }
+
+    bearer_reload_modem_stats (self);
     return G_SOURCE_CONTINUE;
 }
 
 static void
-bearer_stats_start (MMBaseBearer *self)
+bearer_stats_start (MMBaseBearer *self,
+                    MMPort       *data)
 {
     /* Start duration timer */
     g_assert (!self->priv->duration_timer);
     self->priv->duration_timer = g_timer_new ();
 
+    /* Net data ports expose exact traffic counters in the kernel; PPP
+     * interfaces are not known to us, so those rely on the modem */
+    g_clear_object (&self->priv->stats_netdev);
+    self->priv->stats_netdev_baseline_set = FALSE;
+    if (data && MM_IS_PORT_NET (data))
+        self->priv->stats_netdev = MM_PORT_NET (g_object_ref (data));
+
     /* Schedule */
     g_assert (!self->priv->stats_update_id);
-    self->priv->stats_update_id = g_timeout_add_seconds (BEARER_STATS_UPDATE_TIMEOUT,
-                                                         (GSourceFunc) stats_update_cb,
-                                                         self);
+    bearer_stats_schedule (self);
     /* Load initial values */
     stats_update_cb (self);
 }
@@ -512,18 +663,25 @@ bearer_update_status (MMBaseBearer *self,
                                 "connection #%u finished: duration %us",
                                 mm_bearer_stats_get_attempts (self->priv->stats),
                                 mm_bearer_stats_get_duration (self->priv->stats));
-        if (!self->priv->reload_stats_unsupported)
+        if (self->priv->stats_netdev || !self->priv->reload_stats_unsupported)
             g_string_append_printf (report,
                                     ", tx: %" G_GUINT64_FORMAT " bytes, rx: %" G_GUINT64_FORMAT " bytes",
                                     mm_bearer_stats_get_tx_bytes (self->priv->stats),
                                     mm_bearer_stats_get_rx_bytes (self->priv->stats));
+        g_string_append_printf (report,
+                                ", connection status polls: %u, indications: %u",
+                                self->priv->n_connection_polls,
+                                self->priv->n_connection_indications);
+        self->priv->n_connection_polls = 0;
+        self->priv->n_connection_indications = 0;
         mm_obj_info (self, "%s", report->str);
+        g_clear_object (&self->priv->stats_netdev);
     }
 }
 
 static void
 bearer_update_status_connected (MMBaseBearer     *self,
-                                const gchar      *interface,
+                                MMPort           *data,
                                 gboolean          multiplexed,
                                 gint              profile_id,
                                 MMBearerIpConfig *ipv4_config,
@@ -533,7 +691,7 @@ bearer_update_status_connected (MMBaseBearer     *self,
     mm_gdbus_bearer_set_multiplexed (MM_GDBUS_BEARER (self), multiplexed);
     mm_gdbus_bearer_set_connected (MM_GDBUS_BEARER (self), TRUE);
     mm_gdbus_bearer_set_suspended (MM_GDBUS_BEARER (self), FALSE);
-    mm_gdbus_bearer_set_interface (MM_GDBUS_BEARER (self), interface);
+    mm_gdbus_bearer_set_interface (MM_GDBUS_BEARER (self), mm_port_get_device (data));
     mm_gdbus_bearer_set_ip4_config (
         MM_GDBUS_BEARER (self),
         mm_bearer_ip_config_get_dictionary (ipv4_config));
@@ -556,7 +714,7 @@ bearer_update_status_connected (MMBaseBearer     *self,
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_STATUS]);
 
     /* Start statistics */
-    bearer_stats_start (self);
+    bearer_stats_start (self, data);
 
     /* Start connection monitor, if supported */
     connection_monitor_start (self);
@@ -846,7 +1004,7 @@ disconnect_after_cancel_ready (MMBaseBearer *self,
      * chance to correctly update their own connection state, in case this base
      * class ignores a failed disconnection attempt.
      */
-    mm_base_bearer_report_connection_status (self, MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
+    report_connection_status_internal (self, MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
 }
 
 static void
@@ -893,7 +1051,7 @@ connect_ready (MMBaseBearer *self,
         /* Update bearer and interface status */
         bearer_update_status_connected (
             self,
-            mm_port_get_device (mm_bearer_connect_result_peek_data (result)),
+            mm_bearer_connect_result_peek_data (result),
             mm_bearer_connect_result_get_multiplexed (result),
             mm_bearer_connect_result_get_profile_id (result),
             mm_bearer_connect_result_peek_ipv4_config (result),
@@ -1382,7 +1540,7 @@ disconnect_force_ready (MMBaseBearer *self,
      * chance to correctly update their own connection state, in case this base
      * class ignores a failed disconnection attempt.
      */
-    mm_base_bearer_report_connection_status (self, MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
+    report_connection_status_internal (self, MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
 }
 
 void
@@ -1464,6 +1622,17 @@ mm_base_bearer_report_connection_status_detailed (MMBaseBearer             *self
                                                   MMBearerConnectionStatus  status,
                                                   const GError             *connection_error)
 {
+    /* Any unsolicited report received while connected proves that the modem
+     * reports connection status changes itself */
+    if (!self->priv->reporting_internal_connection_status &&
+        self->priv->status == MM_BEARER_STATUS_CONNECTED) {
+        self->priv->n_connection_indications++;
+        if (!self->priv->connection_indications_confirmed) {
+            mm_obj_dbg (self, "connection status indications confirmed: connection monitoring backing off");
+            self->priv->connection_indications_confirmed = TRUE;
+        }
+    }
+
     /* Reporting disconnection? */
     if (status == MM_BEARER_CONNECTION_STATUS_DISCONNECTED || status == MM_BEARER_CONNECTION_STATUS_CONNECTION_FAILED) {
         if (self->priv->ignore_disconnection_reports) {
@@ -1536,7 +1705,7 @@ reload_connection_status_ready (MMBaseBearer *self,
     else if ((ctx->status == MM_BEARER_STATUS_CONNECTED) &&
              (reloaded_status == MM_BEARER_CONNECTION_STATUS_DISCONNECTED)) {
         mm_obj_dbg (self, "disconnection detected during status synchronization");
-        mm_base_bearer_report_connection_status (self, reloaded_status);
+        report_connection_status_internal (self, reloaded_status);
     }
 
     /* Go on to the next step */
@@ -1562,8 +1731,12 @@ interface_syncing_step (GTask *task)
         /*
          * AT+PPP based connections should not be synced.
          * When a AT+PPP connection bearer is connected, the 'ignore_disconnection_reports' flag is set.
+         * Bearers that weren't connected before the suspend are not synced either, as
+         * only a connected->disconnected transition is processed.
          */
-        if (!self->priv->ignore_disconnection_reports) {
+        if (ctx->status != MM_BEARER_STATUS_CONNECTED)
+            mm_obj_dbg (self, "not connected before suspend, connection status not refreshed");
+        else if (!self->priv->ignore_disconnection_reports) {
             if (!MM_BASE_BEARER_GET_CLASS (self)->reload_connection_status)
                 mm_obj_warn (self, "unable to reload connection status, method not implemented");
             else {
@@ -1779,6 +1952,7 @@ dispose (GObject *object)
     connection_monitor_stop (self);
     bearer_stats_stop (self);
     g_clear_object (&self->priv->stats);
+    g_clear_object (&self->priv->stats_netdev);
 
     if (self->priv->connection) {
         base_bearer_dbus_unexport (self);
@@ -53,6 +53,13 @@
 #include "mm-filter.h"
 #include "mm-log-object.h"
 #include "mm-base-modem.h"
+#include "mm-port-serial.h"
+#include "mm-base-sim.h"
+#include "mm-bearer-list.h"
+#include "mm-iface-modem.h"
+#include "mm-timer-wheel.h"
+#include "mm-identity-cache.h"
+#include "mm-port-probe.h"
 
 static void initable_iface_init   (GInitableIface       *iface);
 static void log_object_iface_init (MMLogObjectInterface *iface);
@@ -98,6 +105,11 @@ struct _MMBaseManagerPrivate {
     GDBusObjectManagerServer *object_manager;
     /* The map of inhibited devices */
     GHashTable *inhibited_devices;
+    /* Last state reported for each object, and removed objects */
+    guint64     state_generation;
+    GHashTable *state_entries;
+    GQueue     *state_removed;
+    guint64     state_removed_horizon;
 
     /* The Test interface support */
     MmGdbusTest *test_skeleton;
@@ -110,6 +122,13 @@ struct _MMBaseManagerPrivate {
     /* The Qrtr Bus Watcher */
     MMQrtrBusWatcher *qrtr_bus_watcher;
 #endif
+#if defined WITH_SYSTEMD_SUSPEND_RESUME
+    /* Quick resume metrics */
+    guint  n_resumes;
+    guint  n_reconnects;
+    gint64 reconnect_time_total;
+    gint64 reconnect_time_max;
+#endif
 };
 
 /*****************************************************************************/
@@ -220,6 +239,10 @@ device_support_check_ready (MMPluginManager          *plugin_manager,
         mm_obj_warn (ctx->self, "couldn't create modem for device '%s': %s",
                      mm_device_get_uid (ctx->device), error->message);
         g_error_free (error);
+        /* The port probing results were cached when the plugin was found,
+         * don't reuse them the next time */
+        mm_identity_cache_remove_device (mm_device_get_uid (ctx->device));
+        mm_identity_cache_flush ();
         g_hash_table_remove (ctx->self->priv->devices, mm_device_get_uid (ctx->device));
         find_device_support_context_free (ctx);
         return;
@@ -793,19 +816,130 @@ mm_base_manager_num_modems (MMBaseManager *self)
 
 #if defined WITH_SYSTEMD_SUSPEND_RESUME
 
+/* Reconnections happening later than this are not considered a consequence
+ * of the resume, e.g. the user explicitly connecting much later */
+#define RESUME_RECONNECT_TIMEOUT_SECS 300
+
+static GQuark resume_context_quark;
+
+typedef struct {
+    MMBaseManager *self;
+    MMBaseModem   *modem;
+    gint64         resume_time;
+    gulong         state_id;
+} ResumeContext;
+
 static void
-base_modem_sync_ready (MMBaseModem  *self,
-                       GAsyncResult *res,
-                       gpointer      user_data)
+resume_context_free (ResumeContext *ctx)
+{
+    if (ctx->self)
+        g_object_remove_weak_pointer (G_OBJECT (ctx->self), (gpointer *)&ctx->self);
+    if (g_object_get_qdata (G_OBJECT (ctx->modem), resume_context_quark) == ctx)
+        g_object_set_qdata (G_OBJECT (ctx->modem), resume_context_quark, NULL);
+    g_slice_free (ResumeContext, ctx);
+}
+
+static void
+resume_context_stop (ResumeContext *ctx)
+{
+    /* The context is owned by the signal handler if there is one */
+    if (ctx->state_id)
+        g_signal_handler_disconnect (ctx->modem, ctx->state_id);
+    else
+        resume_context_free (ctx);
+}
+
+static void
+resume_context_report_reconnect (ResumeContext *ctx)
+{
+    gint64 elapsed_ms;
+
+    elapsed_ms = (g_get_monotonic_time () - ctx->resume_time) / 1000;
+    if (ctx->self) {
+        ctx->self->priv->n_reconnects++;
+        ctx->self->priv->reconnect_time_total += elapsed_ms;
+        ctx->self->priv->reconnect_time_max = MAX (ctx->self->priv->reconnect_time_max, elapsed_ms);
+        mm_obj_info (ctx->modem, "connected %" G_GINT64_FORMAT "ms after resume "
+                     "(average %" G_GINT64_FORMAT "ms, max %" G_GINT64_FORMAT "ms over %u reconnections)",
+                     elapsed_ms,
+                     ctx->self->priv->reconnect_time_total / ctx->self->priv->n_reconnects,
+                     ctx->self->priv->reconnect_time_max,
+                     ctx->self->priv->n_reconnects);
+    } else
+        mm_obj_info (ctx->modem, "connected %" G_GINT64_FORMAT "ms after resume", elapsed_ms);
+}
+
+static gboolean
+resume_context_modem_connected (ResumeContext *ctx)
+{
+    MMModemState state = MM_MODEM_STATE_UNKNOWN;
+
+    g_object_get (ctx->modem,
+                  MM_IFACE_MODEM_STATE, &state,
+                  NULL);
+    return (state == MM_MODEM_STATE_CONNECTED);
+}
+
+static void
+resume_modem_state_changed (MMBaseModem   *modem,
+                            GParamSpec    *pspec,
+                            ResumeContext *ctx)
+{
+    if (g_get_monotonic_time () - ctx->resume_time > RESUME_RECONNECT_TIMEOUT_SECS * G_USEC_PER_SEC) {
+        mm_obj_dbg (modem, "not connected within %us after resume", RESUME_RECONNECT_TIMEOUT_SECS);
+        resume_context_stop (ctx);
+        return;
+    }
+
+    if (!resume_context_modem_connected (ctx))
+        return;
+
+    resume_context_report_reconnect (ctx);
+    resume_context_stop (ctx);
+}
+
+static void
+base_modem_sync_ready (MMBaseModem   *self,
+                       GAsyncResult  *res,
+                       ResumeContext *ctx)
 {
     g_autoptr(GError) error = NULL;
+    gint64            elapsed_ms;
+
+    elapsed_ms = (g_get_monotonic_time () - ctx->resume_time) / 1000;
 
     mm_base_modem_sync_finish (self, res, &error);
+
+    /* A new resume happened while this one was still being synchronized */
+    if (g_object_get_qdata (G_OBJECT (self), resume_context_quark) != ctx) {
+        resume_context_free (ctx);
+        return;
+    }
+
     if (error) {
-        mm_obj_warn (self, "synchronization failed: %s", error->message);
+        mm_obj_warn (self, "synchronization failed after %" G_GINT64_FORMAT "ms: %s", elapsed_ms, error->message);
+        resume_context_stop (ctx);
         return;
     }
-    mm_obj_info (self, "synchronization finished");
+    mm_obj_info (self, "synchronization finished in %" G_GINT64_FORMAT "ms", elapsed_ms);
+
+    /* If the connection survived the suspend, that's our reconnection time;
+     * otherwise wait for the modem to get connected again */
+    if (!MM_IS_IFACE_MODEM (self)) {
+        resume_context_stop (ctx);
+        return;
+    }
+    if (resume_context_modem_connected (ctx)) {
+        resume_context_report_reconnect (ctx);
+        resume_context_stop (ctx);
+        return;
+    }
+    ctx->state_id = g_signal_connect_data (self,
+                                           "notify::" MM_IFACE_MODEM_STATE,
+                                           G_CALLBACK (resume_modem_state_changed),
+                                           ctx,
+                                           (GClosureNotify) resume_context_free,
+                                           0);
 }
 
 void
@@ -813,20 +947,44 @@ mm_base_manager_sync (MMBaseManager *self)
 {
     GHashTableIter iter;
     gpointer       key, value;
+    gint64         resume_time;
 
     g_return_if_fail (self != NULL);
     g_return_if_fail (MM_IS_BASE_MANAGER (self));
 
+    if (G_UNLIKELY (!resume_context_quark))
+        resume_context_quark = g_quark_from_static_string ("mm-base-manager-resume-context");
+
+    resume_time = g_get_monotonic_time ();
+    self->priv->n_resumes++;
+    mm_obj_info (self, "resume #%u: synchronizing %u modems", self->priv->n_resumes, mm_base_manager_num_modems (self));
+
     /* Refresh each device */
     g_hash_table_iter_init (&iter, self->priv->devices);
     while (g_hash_table_iter_next (&iter, &key, &value)) {
-        MMBaseModem *modem;
+        MMBaseModem   *modem;
+        ResumeContext *ctx;
 
         modem = mm_device_peek_modem (MM_DEVICE (value));
+        if (!modem)
+            continue;
+
+        /* Still waiting for the modem to reconnect after a previous resume?
+         * If that one is still being synchronized instead, it will notice it
+         * was superseded once done. */
+        ctx = g_object_get_qdata (G_OBJECT (modem), resume_context_quark);
+        if (ctx && ctx->state_id)
+            resume_context_stop (ctx);
+
+        ctx = g_slice_new0 (ResumeContext);
+        ctx->self = self;
+        g_object_add_weak_pointer (G_OBJECT (self), (gpointer *)&ctx->self);
+        ctx->modem = modem;
+        ctx->resume_time = resume_time;
+        g_object_set_qdata (G_OBJECT (modem), resume_context_quark, ctx);
 
         /* We just want to start the synchronization, we don't need the result */
-        if (modem)
-            mm_base_modem_sync (modem, (GAsyncReadyCallback)base_modem_sync_ready, NULL);
+        mm_base_modem_sync (modem, (GAsyncReadyCallback)base_modem_sync_ready, ctx);
     }
 }
 
@@ -863,6 +1021,9 @@ set_logging_auth_ready (MMAuthProvider    *authp,
         g_dbus_method_invocation_take_error (ctx->invocation, error);
     else {
         mm_obj_info (ctx->self, "logging: level '%s'", ctx->level);
+        /* Dump the periodic timers when switching to debug */
+        if (g_ascii_strcasecmp (ctx->level, "DEBUG") == 0)
+            mm_timer_wheel_log_timers (mm_timer_wheel_get ());
         mm_gdbus_org_freedesktop_modem_manager1_complete_set_logging (
             MM_GDBUS_ORG_FREEDESKTOP_MODEM_MANAGER1 (ctx->self),
             ctx->invocation);
@@ -892,6 +1053,243 @@ handle_set_logging (MmGdbusOrgFreedesktopModemManager1 *manager,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Get state */
+
+/* Maximum number of removed objects remembered; clients asking for changes
+ * since a generation older than the oldest forgotten removal get a full
+ * snapshot instead */
+#define STATE_REMOVED_MAX 64
+
+typedef struct {
+    GVariant *properties;
+    guint64   generation;
+} StateEntry;
+
+static void
+state_entry_free (StateEntry *entry)
+{
+    g_variant_unref (entry->properties);
+    g_slice_free (StateEntry, entry);
+}
+
+typedef struct {
+    gchar   *path;
+    guint64  generation;
+} StateRemoved;
+
+static void
+state_removed_free (StateRemoved *removed)
+{
+    g_free (removed->path);
+    g_slice_free (StateRemoved, removed);
+}
+
+static void
+state_add_interface (GHashTable             *current,
+                     const gchar            *path,
+                     GDBusInterfaceSkeleton *skeleton)
+{
+    GVariantBuilder *builder;
+
+    /* Not exported, not reported */
+    if (!path)
+        return;
+
+    builder = g_hash_table_lookup (current, path);
+    if (!builder) {
+        builder = g_variant_builder_new (G_VARIANT_TYPE ("a{sa{sv}}"));
+        g_hash_table_insert (current, g_strdup (path), builder);
+    }
+    g_variant_builder_add (builder, "{s@a{sv}}",
+                           g_dbus_interface_skeleton_get_info (skeleton)->name,
+                           g_dbus_interface_skeleton_get_properties (skeleton));
+}
+
+static void
+state_add_bearer (MMBaseBearer *bearer,
+                  GHashTable   *current)
+{
+    state_add_interface (current,
+                         g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (bearer)),
+                         G_DBUS_INTERFACE_SKELETON (bearer));
+}
+
+static void
+state_add_sim (GHashTable *current,
+               MMBaseSim  *sim)
+{
+    if (sim)
+        state_add_interface (current,
+                             g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (sim)),
+                             G_DBUS_INTERFACE_SKELETON (sim));
+}
+
+static void
+state_add_modem (GHashTable  *current,
+                 GDBusObject *object)
+{
+    g_autoptr(MMBearerList)  bearer_list = NULL;
+    g_autoptr(MMBaseSim)     sim = NULL;
+    g_autoptr(GPtrArray)     sim_slots = NULL;
+    GList                   *interfaces;
+    GList                   *l;
+
+    interfaces = g_dbus_object_get_interfaces (object);
+    for (l = interfaces; l; l = g_list_next (l))
+        state_add_interface (current,
+                             g_dbus_object_get_object_path (object),
+                             G_DBUS_INTERFACE_SKELETON (l->data));
+    g_list_free_full (interfaces, g_object_unref);
+
+    if (!MM_IS_IFACE_MODEM (object))
+        return;
+
+    g_object_get (object,
+                  MM_IFACE_MODEM_BEARER_LIST, &bearer_list,
+                  MM_IFACE_MODEM_SIM,         &sim,
+                  MM_IFACE_MODEM_SIM_SLOTS,   &sim_slots,
+                  NULL);
+    if (bearer_list)
+        mm_bearer_list_foreach (bearer_list, (MMBearerListForeachFunc) state_add_bearer, current);
+    state_add_sim (current, sim);
+    if (sim_slots) {
+        guint i;
+
+        /* The active SIM is also in the slots, adding it again just replaces it */
+        for (i = 0; i < sim_slots->len; i++) {
+            MMBaseSim *slot_sim;
+
+            slot_sim = g_ptr_array_index (sim_slots, i);
+            if (slot_sim && slot_sim != sim)
+                state_add_sim (current, slot_sim);
+        }
+    }
+}
+
+/* Compares the current state of all exported modems, bearers and SIMs with
+ * the last one reported, and updates the generation of the ones that
+ * changed. */
+static void
+state_update (MMBaseManager *self)
+{
+    g_autoptr(GHashTable)  current = NULL;
+    GList                 *objects;
+    GList                 *l;
+    GHashTableIter         iter;
+    gpointer               key;
+    gpointer               value;
+    guint64                generation;
+    gboolean               changed = FALSE;
+
+    current = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_builder_unref);
+    objects = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (self->priv->object_manager));
+    for (l = objects; l; l = g_list_next (l))
+        state_add_modem (current, G_DBUS_OBJECT (l->data));
+    g_list_free_full (objects, g_object_unref);
+
+    /* All changes found in this update share the same generation, which is
+     * never behind the wall clock */
+    generation = MAX (self->priv->state_generation + 1, (guint64) g_get_real_time ());
+
+    g_hash_table_iter_init (&iter, self->priv->state_entries);
+    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+        StateRemoved *removed;
+
+        if (g_hash_table_contains (current, key))
+            continue;
+
+        removed = g_slice_new (StateRemoved);
+        removed->path = g_strdup (key);
+        removed->generation = generation;
+        g_queue_push_tail (self->priv->state_removed, removed);
+        g_hash_table_iter_remove (&iter);
+        changed = TRUE;
+    }
+
+    while (g_queue_get_length (self->priv->state_removed) > STATE_REMOVED_MAX) {
+        StateRemoved *removed;
+
+        removed = g_queue_pop_head (self->priv->state_removed);
+        self->priv->state_removed_horizon = removed->generation;
+        state_removed_free (removed);
+    }
+
+    g_hash_table_iter_init (&iter, current);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        g_autoptr(GVariant)  properties = NULL;
+        StateEntry          *entry;
+
+        properties = g_variant_ref_sink (g_variant_builder_end ((GVariantBuilder *) value));
+        entry = g_hash_table_lookup (self->priv->state_entries, key);
+        if (entry && g_variant_equal (entry->properties, properties))
+            continue;
+
+        if (!entry) {
+            entry = g_slice_new0 (StateEntry);
+            g_hash_table_insert (self->priv->state_entries, g_strdup (key), entry);
+        } else
+            g_variant_unref (entry->properties);
+        entry->properties = g_steal_pointer (&properties);
+        entry->generation = generation;
+        changed = TRUE;
+    }
+
+    if (changed)
+        self->priv->state_generation = generation;
+}
+
+static gboolean
+handle_get_state (MmGdbusOrgFreedesktopModemManager1 *manager,
+                  GDBusMethodInvocation              *invocation,
+                  guint64                             since_generation)
+{
+    MMBaseManager   *self = MM_BASE_MANAGER (manager);
+    GVariantBuilder  objects;
+    GPtrArray       *removed;
+    GHashTableIter   iter;
+    gpointer         key;
+    gpointer         value;
+    GList           *l;
+
+    state_update (self);
+
+    /* Too old or unknown generation, report everything */
+    if (since_generation < self->priv->state_removed_horizon ||
+        since_generation > self->priv->state_generation)
+        since_generation = 0;
+
+    g_variant_builder_init (&objects, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+    g_hash_table_iter_init (&iter, self->priv->state_entries);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        StateEntry *entry = value;
+
+        if (entry->generation > since_generation)
+            g_variant_builder_add (&objects, "{o@a{sa{sv}}}", key, entry->properties);
+    }
+
+    removed = g_ptr_array_new ();
+    if (since_generation > 0) {
+        for (l = g_queue_peek_head_link (self->priv->state_removed); l; l = g_list_next (l)) {
+            StateRemoved *item = l->data;
+
+            if (item->generation > since_generation)
+                g_ptr_array_add (removed, item->path);
+        }
+    }
+    g_ptr_array_add (removed, NULL);
+
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_state (
+        manager,
+        invocation,
+        self->priv->state_generation,
+        (since_generation == 0),
+        g_variant_builder_end (&objects),
+        (const gchar *const *) removed->pdata);
+    g_ptr_array_unref (removed);
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Manual scan */
 
@@ -920,7 +1318,9 @@ scan_devices_auth_ready (MMAuthProvider *authp,
     else {
 #if defined WITH_UDEV
         if (!mm_context_get_test_no_udev ()) {
-            /* Otherwise relaunch device scan */
+            /* Otherwise relaunch device scan, fully probing the ports
+             * found, even if there are cached probing results */
+            mm_port_probe_cache_clear ();
             mm_base_manager_start (MM_BASE_MANAGER (ctx->self), TRUE);
             mm_gdbus_org_freedesktop_modem_manager1_complete_scan_devices (
                 MM_GDBUS_ORG_FREEDESKTOP_MODEM_MANAGER1 (ctx->self),
@@ -1422,6 +1822,63 @@ out:
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Test port traffic dump */
+
+static gboolean
+handle_dump_port_traffic (MmGdbusTest           *skeleton,
+                          GDBusMethodInvocation *invocation,
+                          const gchar           *directory,
+                          MMBaseManager         *self)
+{
+    GHashTableIter  iter;
+    gpointer        value;
+    GError         *error = NULL;
+
+    mm_obj_info (self, "dumping port traffic...");
+
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        MMBaseModem *modem;
+        GList       *ports;
+        GList       *l;
+
+        modem = mm_device_peek_modem (MM_DEVICE (value));
+        if (!modem)
+            continue;
+
+        ports = mm_base_modem_find_ports (modem, MM_PORT_SUBSYS_UNKNOWN, MM_PORT_TYPE_UNKNOWN);
+        for (l = ports; l; l = g_list_next (l)) {
+            MMPortSerial *port;
+
+            if (!MM_IS_PORT_SERIAL (l->data))
+                continue;
+            port = MM_PORT_SERIAL (l->data);
+
+            mm_port_serial_dump_traffic (port);
+
+            if (!error && directory && directory[0]) {
+                g_autofree gchar *filename = NULL;
+                g_autofree gchar *path = NULL;
+
+                filename = g_strdup_printf ("%s.pcap", mm_port_get_device (MM_PORT (port)));
+                path = g_build_filename (directory, filename, NULL);
+                if (mm_port_serial_write_traffic_pcap (port, path, &error))
+                    mm_obj_info (self, "port traffic written to %s", path);
+            }
+        }
+        g_list_free_full (ports, g_object_unref);
+    }
+
+    if (error) {
+        mm_obj_warn (self, "couldn't write port traffic: %s", error->message);
+        g_dbus_method_invocation_take_error (invocation, error);
+    } else
+        mm_gdbus_test_complete_dump_port_traffic (skeleton, invocation);
+
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 static gchar *
@@ -1559,6 +2016,15 @@ mm_base_manager_init (MMBaseManager *self)
     /* Setup internal list of inhibited devices */
     self->priv->inhibited_devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)inhibited_device_info_free);
 
+    /* Setup internal state reporting */
+    self->priv->state_entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)state_entry_free);
+    self->priv->state_removed = g_queue_new ();
+    /* Generations follow the wall clock, so that the ones given by a previous
+     * daemon instance are always older than the ones given by this one, and
+     * clients holding them get a full snapshot */
+    self->priv->state_generation = (guint64) g_get_real_time ();
+    self->priv->state_removed_horizon = self->priv->state_generation;
+
     /* By default, enable autoscan */
     self->priv->auto_scan = TRUE;
 
@@ -1574,6 +2040,7 @@ mm_base_manager_init (MMBaseManager *self)
                       "signal::handle-scan-devices",        G_CALLBACK (handle_scan_devices),        NULL,
                       "signal::handle-report-kernel-event", G_CALLBACK (handle_report_kernel_event), NULL,
                       "signal::handle-inhibit-device",      G_CALLBACK (handle_inhibit_device),      NULL,
+                      "signal::handle-get-state",           G_CALLBACK (handle_get_state),           NULL,
                       NULL);
 }
 
@@ -1636,6 +2103,10 @@ initable_init (GInitable     *initable,
                           "handle-set-profile",
                           G_CALLBACK (handle_set_profile),
                           initable);
+        g_signal_connect (self->priv->test_skeleton,
+                          "handle-dump-port-traffic",
+                          G_CALLBACK (handle_dump_port_traffic),
+                          initable);
         if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->priv->test_skeleton),
                                                self->priv->connection,
                                                MM_DBUS_PATH,
@@ -1657,6 +2128,8 @@ finalize (GObject *object)
 
     g_hash_table_destroy (self->priv->inhibited_devices);
     g_hash_table_destroy (self->priv->devices);
+    g_hash_table_destroy (self->priv->state_entries);
+    g_queue_free_full (self->priv->state_removed, (GDestroyNotify)state_removed_free);
 
 #if defined WITH_UDEV
     if (self->priv->udev)
@@ -13,6 +13,8 @@
  * Copyright (C) 2011 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 
@@ -20,6 +22,227 @@
 
 #include "mm-base-modem-at.h"
 #include "mm-errors-types.h"
+#include "mm-log-object.h"
+
+/*****************************************************************************/
+/* AT command scheduling across ports
+ *
+ * Commands issued without an explicit port are by default sent to the best
+ * AT port available (usually the primary one). Read-only queries whose
+ * response doesn't depend on any per-channel setting (e.g. error or
+ * registration reporting formats, or the character set) may instead be
+ * sent to any other open AT port that has less pending commands, as long as
+ * there are no state-changing commands pending in the best port, so that
+ * a query issued right after a state change never overtakes it.
+ */
+
+#define AT_SCHEDULER_TAG "at-scheduler"
+static GQuark at_scheduler_quark;
+
+typedef struct {
+    guint n_pending;
+    guint n_pending_ordered;
+} AtPortQueue;
+
+/* Exact commands that are known to be read-only and independent of any
+ * per-channel setting; read/test commands (ending with '?') are matched
+ * separately */
+static const gchar *unordered_commands[] = {
+    "+CGMI",
+    "+GMI",
+    "+CGMM",
+    "+GMM",
+    "+CGMR",
+    "+GMR",
+    "+CGSN",
+    "+GSN",
+    "+CIMI",
+    "+CSQ",
+    "+CESQ",
+    "+GCAP",
+};
+
+/* Read commands whose response format depends on per-channel settings */
+static const gchar *ordered_read_commands[] = {
+    "+COPS?",
+    "+CREG?",
+    "+CGREG?",
+    "+CEREG?",
+    "+C5GREG?",
+    "+CSCS?",
+    "+CMEE?",
+    "+CMGF?",
+};
+
+static gboolean
+at_command_is_unordered (const gchar *command,
+                         gboolean     is_raw)
+{
+    gsize len;
+    guint i;
+
+    if (!command || is_raw)
+        return FALSE;
+
+    if (g_ascii_strncasecmp (command, "AT", 2) == 0)
+        command += 2;
+
+    /* Never split compound commands */
+    if (strchr (command, ';'))
+        return FALSE;
+
+    for (i = 0; i < G_N_ELEMENTS (unordered_commands); i++) {
+        if (g_ascii_strcasecmp (command, unordered_commands[i]) == 0)
+            return TRUE;
+    }
+
+    len = strlen (command);
+    if (len < 2 || command[len - 1] != '?')
+        return FALSE;
+
+    /* Test commands only report capabilities */
+    if (command[len - 2] == '=')
+        return TRUE;
+
+    for (i = 0; i < G_N_ELEMENTS (ordered_read_commands); i++) {
+        if (g_ascii_strcasecmp (command, ordered_read_commands[i]) == 0)
+            return FALSE;
+    }
+
+    /* Only extended read commands from the standard set, vendor-specific ones
+     * may have side effects */
+    return (command[0] == '+' && command[1] == 'C');
+}
+
+static gboolean
+at_sequence_is_unordered (const MMBaseModemAtCommand *sequence)
+{
+    for (; sequence->command; sequence++) {
+        if (!at_command_is_unordered (sequence->command, FALSE))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static GHashTable *
+at_scheduler_peek_queues (MMBaseModem *self)
+{
+    GHashTable *queues;
+
+    if (G_UNLIKELY (!at_scheduler_quark))
+        at_scheduler_quark = g_quark_from_static_string (AT_SCHEDULER_TAG);
+
+    queues = g_object_get_qdata (G_OBJECT (self), at_scheduler_quark);
+    if (!queues) {
+        /* Port keys are not referenced, entries are removed as soon as there
+         * are no more pending commands in the port */
+        queues = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+        g_object_set_qdata_full (G_OBJECT (self), at_scheduler_quark, queues, (GDestroyNotify)g_hash_table_unref);
+    }
+    return queues;
+}
+
+static const AtPortQueue *
+at_scheduler_peek_port_queue (MMBaseModem    *self,
+                              MMPortSerialAt *port)
+{
+    static const AtPortQueue empty = { 0 };
+    AtPortQueue             *queue;
+
+    queue = g_hash_table_lookup (at_scheduler_peek_queues (self), port);
+    return (queue ? queue : &empty);
+}
+
+static void
+at_scheduler_push (MMBaseModem    *self,
+                   MMPortSerialAt *port,
+                   gboolean        ordered)
+{
+    GHashTable  *queues;
+    AtPortQueue *queue;
+
+    queues = at_scheduler_peek_queues (self);
+    queue = g_hash_table_lookup (queues, port);
+    if (!queue) {
+        queue = g_new0 (AtPortQueue, 1);
+        g_hash_table_insert (queues, port, queue);
+    }
+    queue->n_pending++;
+    if (ordered)
+        queue->n_pending_ordered++;
+}
+
+static void
+at_scheduler_pop (MMBaseModem    *self,
+                  MMPortSerialAt *port,
+                  gboolean        ordered,
+                  const gchar    *command,
+                  gint64          start_time)
+{
+    GHashTable  *queues;
+    AtPortQueue *queue;
+
+    queues = at_scheduler_peek_queues (self);
+    queue = g_hash_table_lookup (queues, port);
+    g_assert (queue && queue->n_pending > 0);
+
+    queue->n_pending--;
+    if (ordered) {
+        g_assert (queue->n_pending_ordered > 0);
+        queue->n_pending_ordered--;
+    }
+
+    mm_obj_dbg (self, "(%s) '%s' completed after %" G_GINT64_FORMAT "ms (queue depth: %u)",
+                mm_port_get_device (MM_PORT (port)),
+                command,
+                (g_get_monotonic_time () - start_time) / 1000,
+                queue->n_pending);
+
+    if (!queue->n_pending)
+        g_hash_table_remove (queues, port);
+}
+
+static MMPortSerialAt *
+at_scheduler_peek_port (MMBaseModem  *self,
+                        gboolean      unordered,
+                        GError      **error)
+{
+    MMPortSerialAt    *best;
+    MMPortSerialAt    *candidates[2];
+    const AtPortQueue *best_queue;
+    guint              i;
+
+    best = mm_base_modem_peek_best_at_port (self, error);
+    if (!best || !unordered)
+        return best;
+
+    /* Keep ordering with state changes pending in the best port */
+    best_queue = at_scheduler_peek_port_queue (self, best);
+    if (best_queue->n_pending == 0 || best_queue->n_pending_ordered > 0)
+        return best;
+
+    candidates[0] = mm_base_modem_peek_port_primary (self);
+    candidates[1] = mm_base_modem_peek_port_secondary (self);
+    for (i = 0; i < G_N_ELEMENTS (candidates); i++) {
+        const AtPortQueue *queue;
+
+        /* Only ports already open, we don't want to open and close ports on
+         * every command */
+        if (!candidates[i] ||
+            candidates[i] == best ||
+            mm_port_get_connected (MM_PORT (candidates[i])) ||
+            !mm_port_serial_is_open (MM_PORT_SERIAL (candidates[i])))
+            continue;
+
+        queue = at_scheduler_peek_port_queue (self, candidates[i]);
+        if (queue->n_pending < best_queue->n_pending) {
+            best = candidates[i];
+            best_queue = queue;
+        }
+    }
+
+    return best;
+}
 
 static gboolean
 abort_async_if_port_unusable (MMBaseModem *self,
@@ -102,11 +325,14 @@ typedef struct {
     gpointer                    response_processor_context;
     GDestroyNotify              response_processor_context_free;
     GVariant                   *result;
+    gboolean                    ordered;
+    gint64                      start_time;
 } AtSequenceContext;
 
 static void
 at_sequence_context_free (AtSequenceContext *ctx)
 {
+    at_scheduler_pop (ctx->self, ctx->port, ctx->ordered, ctx->sequence->command, ctx->start_time);
     mm_port_serial_close (MM_PORT_SERIAL (ctx->port));
     g_object_unref (ctx->port);
     g_object_unref (ctx->self);
@@ -278,6 +504,9 @@ mm_base_modem_at_sequence_full (MMBaseModem                *self,
     ctx->current = ctx->sequence = sequence;
     ctx->response_processor_context = response_processor_context;
     ctx->response_processor_context_free = response_processor_context_free;
+    ctx->ordered = !at_sequence_is_unordered (sequence);
+    ctx->start_time = g_get_monotonic_time ();
+    at_scheduler_push (self, port, ctx->ordered);
 
     /* Setup cancellables */
     ctx->modem_cancellable = mm_base_modem_get_cancellable (self);
@@ -332,7 +561,7 @@ mm_base_modem_at_sequence (MMBaseModem *self,
     GError *error = NULL;
 
     /* No port given, so we'll try to guess which is best */
-    port = mm_base_modem_peek_best_at_port (self, &error);
+    port = at_scheduler_peek_port (self, at_sequence_is_unordered (sequence), &error);
     if (!port) {
         g_assert (error != NULL);
         g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
@@ -476,11 +705,15 @@ typedef struct {
     GCancellable *modem_cancellable;
     GCancellable *user_cancellable;
     GSimpleAsyncResult *result;
+    gchar *command;
+    gboolean ordered;
+    gint64 start_time;
 } AtCommandContext;
 
 static void
 at_command_context_free (AtCommandContext *ctx)
 {
+    at_scheduler_pop (ctx->self, ctx->port, ctx->ordered, ctx->command, ctx->start_time);
     mm_port_serial_close (MM_PORT_SERIAL (ctx->port));
 
     if (ctx->cancelled_id)
@@ -494,6 +727,7 @@ at_command_context_free (AtCommandContext *ctx)
     g_object_unref (ctx->port);
     g_object_unref (ctx->result);
     g_object_unref (ctx->self);
+    g_free (ctx->command);
     g_free (ctx);
 }
 
@@ -563,6 +797,10 @@ mm_base_modem_at_command_full (MMBaseModem *self,
                                              callback,
                                              user_data,
                                              mm_base_modem_at_command_full);
+    ctx->command = g_strdup (command);
+    ctx->ordered = !at_command_is_unordered (command, is_raw);
+    ctx->start_time = g_get_monotonic_time ();
+    at_scheduler_push (self, port, ctx->ordered);
 
     /* Setup cancellables */
     ctx->modem_cancellable = mm_base_modem_get_cancellable (self);
@@ -613,7 +851,7 @@ _at_command (MMBaseModem *self,
     GError *error = NULL;
 
     /* No port given, so we'll try to guess which is best */
-    port = mm_base_modem_peek_best_at_port (self, &error);
+    port = at_scheduler_peek_port (self, at_command_is_unordered (command, is_raw), &error);
     if (!port) {
         g_assert (error != NULL);
         g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
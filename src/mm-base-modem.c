@@ -35,6 +35,7 @@
 #endif
 
 #include "mm-log-object.h"
+#include "mm-identity-cache.h"
 #include "mm-port-enums-types.h"
 #include "mm-serial-parsers.h"
 #include "mm-modem-helpers.h"
@@ -231,6 +232,12 @@ base_modem_create_tty_port (MMBaseModem        *self,
                          name, inner_error->message);
     }
 
+    /* Optional user-provided command write chunk size */
+    if (mm_kernel_device_has_property (kernel_device, ID_MM_TTY_SEND_CHUNK_SIZE))
+        g_object_set (port,
+                      MM_PORT_SERIAL_SEND_CHUNK_SIZE, (guint) mm_kernel_device_get_property_as_int (kernel_device, ID_MM_TTY_SEND_CHUNK_SIZE),
+                      NULL);
+
     return port;
 }
 
@@ -630,6 +637,34 @@ mm_base_modem_sync_finish (MMBaseModem   *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
+/* Cheapest possible fingerprint check: if any of the ports went away during
+ * the suspend, the modem will be removed and probed again anyway, so there's
+ * no point in talking to it. */
+static gboolean
+check_ports_present (MMBaseModem  *self,
+                     GError      **error)
+{
+    GHashTableIter  iter;
+    MMPort         *port;
+
+    g_hash_table_iter_init (&iter, self->priv->ports);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer)&port)) {
+        MMKernelDevice *kernel_device;
+        const gchar    *sysfs_path;
+
+        kernel_device = mm_port_peek_kernel_device (port);
+        if (!kernel_device)
+            continue;
+        sysfs_path = mm_kernel_device_get_sysfs_path (kernel_device);
+        if (sysfs_path && !g_file_test (sysfs_path, G_FILE_TEST_EXISTS)) {
+            g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_WRONG_STATE,
+                         "Port '%s' no longer present", mm_port_get_device (port));
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
 static void
 sync_ready (MMBaseModem  *self,
             GAsyncResult *res,
@@ -649,10 +684,17 @@ mm_base_modem_sync (MMBaseModem         *self,
                     GAsyncReadyCallback  callback,
                     gpointer             user_data)
 {
-    GTask *task;
+    GTask  *task;
+    GError *error = NULL;
 
     task = g_task_new (self, NULL, callback, user_data);
 
+    if (!check_ports_present (self, &error)) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
     if (!MM_BASE_MODEM_GET_CLASS (self)->sync ||
         !MM_BASE_MODEM_GET_CLASS (self)->sync_finish) {
         g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED,
@@ -1251,6 +1293,11 @@ initialize_ready (MMBaseModem *self,
      * even trying to enable the Modem interface */
     mm_obj_warn (self, "couldn't initialize: '%s'", error->message);
     g_error_free (error);
+
+    /* Don't reuse any of the cached info (e.g. port probing results) the
+     * next time the device is found */
+    mm_identity_cache_remove_device (self->priv->device);
+    mm_identity_cache_flush ();
 }
 
 static inline void
@@ -1692,10 +1739,40 @@ after_sim_switch_disable_ready (MMBaseModem  *self,
 void
 mm_base_modem_process_sim_event (MMBaseModem *self)
 {
+    /* Cached SIM info is no longer valid */
+    mm_identity_cache_remove_key (self->priv->device, MM_IDENTITY_CACHE_KEY_SIM_IDENTIFIER);
+    mm_identity_cache_remove_key (self->priv->device, MM_IDENTITY_CACHE_KEY_IMSI);
+    mm_identity_cache_flush ();
+
     mm_base_modem_set_reprobe (self, TRUE);
     mm_base_modem_disable (self, (GAsyncReadyCallback) after_sim_switch_disable_ready, NULL);
 }
 
+static void
+after_identity_change_disable_ready (MMBaseModem  *self,
+                                     GAsyncResult *res)
+{
+    g_autoptr(GError) error = NULL;
+
+    mm_base_modem_disable_finish (self, res, &error);
+    if (error)
+        mm_obj_err (self, "failed to disable after identity change: %s", error->message);
+    else
+        mm_base_modem_set_valid (self, FALSE);
+}
+
+void
+mm_base_modem_process_identity_change (MMBaseModem *self)
+{
+    /* A different module behind the same physical device, nothing that was
+     * cached for it is valid any more */
+    mm_identity_cache_remove_device (self->priv->device);
+    mm_identity_cache_flush ();
+
+    mm_base_modem_set_reprobe (self, TRUE);
+    mm_base_modem_disable (self, (GAsyncReadyCallback) after_identity_change_disable_ready, NULL);
+}
+
 /*****************************************************************************/
 
 static gboolean
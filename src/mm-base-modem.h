@@ -254,6 +254,7 @@ gboolean mm_base_modem_sync_finish    (MMBaseModem *self,
 
 #endif
 
-void mm_base_modem_process_sim_event (MMBaseModem *self);
+void mm_base_modem_process_sim_event       (MMBaseModem *self);
+void mm_base_modem_process_identity_change (MMBaseModem *self);
 
 #endif /* MM_BASE_MODEM_H */
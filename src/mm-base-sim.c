@@ -31,6 +31,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
 #include "mm-log-object.h"
+#include "mm-identity-cache.h"
 #include "mm-modem-helpers.h"
 
 static void async_initable_iface_init (GAsyncInitableIface *iface);
@@ -2411,6 +2412,55 @@ STR_REPLY_READY_FN (eid, "EID")
 STR_REPLY_READY_FN (operator_identifier, "operator identifier")
 STR_REPLY_READY_FN (operator_name, "operator name")
 
+/* The IMSI is only taken from the identity cache if it was stored for the same
+ * SIM card, so the SIM identifier must have been loaded already */
+static gchar *
+identity_cache_get_imsi (MMBaseSim *self)
+{
+    const gchar      *device;
+    const gchar      *simid;
+    g_autofree gchar *cached_simid = NULL;
+
+    if (!self->priv->modem || !mm_gdbus_sim_get_active (MM_GDBUS_SIM (self)))
+        return NULL;
+
+    simid = mm_gdbus_sim_get_sim_identifier (MM_GDBUS_SIM (self));
+    if (!simid)
+        return NULL;
+
+    device = mm_base_modem_get_device (self->priv->modem);
+    cached_simid = mm_identity_cache_get_string (device, MM_IDENTITY_CACHE_KEY_SIM_IDENTIFIER);
+    if (g_strcmp0 (simid, cached_simid) != 0)
+        return NULL;
+
+    return mm_identity_cache_get_string (device, MM_IDENTITY_CACHE_KEY_IMSI);
+}
+
+static void
+identity_cache_store (MMBaseSim *self)
+{
+    const gchar *device;
+    const gchar *simid;
+    const gchar *imsi;
+
+    if (!mm_identity_cache_is_enabled () ||
+        !self->priv->modem ||
+        !mm_gdbus_sim_get_active (MM_GDBUS_SIM (self)))
+        return;
+
+    device = mm_base_modem_get_device (self->priv->modem);
+    simid = mm_gdbus_sim_get_sim_identifier (MM_GDBUS_SIM (self));
+    imsi = mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (self));
+    if (simid && imsi) {
+        mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_SIM_IDENTIFIER, simid);
+        mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_IMSI, imsi);
+    } else {
+        mm_identity_cache_remove_key (device, MM_IDENTITY_CACHE_KEY_SIM_IDENTIFIER);
+        mm_identity_cache_remove_key (device, MM_IDENTITY_CACHE_KEY_IMSI);
+    }
+    mm_identity_cache_flush ();
+}
+
 static void
 init_wait_sim_ready (MMBaseSim    *self,
                      GAsyncResult *res,
@@ -2479,6 +2529,15 @@ interface_initialization_step (GTask *task)
         /* IMSI is meant to be loaded only once during the whole
          * lifetime of the modem. Therefore, if we already have them loaded,
          * don't try to load them again. */
+        if (mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (self)) == NULL) {
+            g_autofree gchar *cached = NULL;
+
+            cached = identity_cache_get_imsi (self);
+            if (cached) {
+                mm_obj_dbg (self, "using cached IMSI");
+                mm_gdbus_sim_set_imsi (MM_GDBUS_SIM (self), cached);
+            }
+        }
         if (mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (self)) == NULL &&
             MM_BASE_SIM_GET_CLASS (self)->load_imsi &&
             MM_BASE_SIM_GET_CLASS (self)->load_imsi_finish) {
@@ -2568,6 +2627,8 @@ interface_initialization_step (GTask *task)
         /* Fall through */
 
     case INITIALIZATION_STEP_LAST:
+        identity_cache_store (self);
+
         /* We are done without errors! */
         g_task_return_boolean (task, TRUE);
         g_object_unref (task);
@@ -832,14 +832,47 @@ modem_load_equipment_identifier_finish (MMIfaceModem *self,
 }
 
 static void
-modem_load_equipment_identifier (MMIfaceModem *_self,
-                                 GAsyncReadyCallback callback,
-                                 gpointer user_data)
+equipment_identifier_device_caps_query_ready (MbimDevice   *device,
+                                              GAsyncResult *res,
+                                              GTask        *task)
 {
-    MMBroadbandModemMbim *self = MM_BROADBAND_MODEM_MBIM (_self);
-    GTask *task;
+    MMBroadbandModemMbim   *self;
+    g_autoptr(MbimMessage)  response = NULL;
+    g_autoptr(GError)       error = NULL;
+    g_autofree gchar       *device_id = NULL;
+
+    self = g_task_get_source_object (task);
+
+    /* The device id is reloaded instead of taken from the capabilities loaded
+     * during initialization, so that it can be used to detect a different
+     * module behind the same ports, e.g. after a suspend/resume cycle */
+    response = mbim_device_command_finish (device, res, &error);
+    if (response &&
+        mbim_message_response_get_result (response, MBIM_MESSAGE_TYPE_COMMAND_DONE, &error) &&
+        mbim_message_device_caps_response_parse (
+            response,
+            NULL, /* device_type */
+            NULL, /* cellular_class */
+            NULL, /* voice_class */
+            NULL, /* sim_class */
+            NULL, /* data_class */
+            NULL, /* sms_caps */
+            NULL, /* ctrl_caps */
+            NULL, /* max_sessions */
+            NULL, /* custom_data_class */
+            &device_id,
+            NULL, /* firmware_info */
+            NULL, /* hardware_info */
+            &error) &&
+        device_id) {
+        g_task_return_pointer (task, g_steal_pointer (&device_id), g_free);
+        g_object_unref (task);
+        return;
+    }
+
+    if (error)
+        mm_obj_dbg (self, "couldn't reload device id: %s", error->message);
 
-    task = g_task_new (self, NULL, callback, user_data);
     if (self->priv->caps_device_id)
         g_task_return_pointer (task,
                                g_strdup (self->priv->caps_device_id),
@@ -852,6 +885,28 @@ modem_load_equipment_identifier (MMIfaceModem *_self,
     g_object_unref (task);
 }
 
+static void
+modem_load_equipment_identifier (MMIfaceModem *self,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+    g_autoptr(MbimMessage)  message = NULL;
+    MbimDevice             *device;
+    GTask                  *task;
+
+    if (!peek_device (self, &device, callback, user_data))
+        return;
+
+    task = g_task_new (self, NULL, callback, user_data);
+    message = mbim_message_device_caps_query_new (NULL);
+    mbim_device_command (device,
+                         message,
+                         10,
+                         NULL,
+                         (GAsyncReadyCallback)equipment_identifier_device_caps_query_ready,
+                         task);
+}
+
 /*****************************************************************************/
 /* Device identifier loading (Modem interface) */
 
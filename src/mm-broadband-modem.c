@@ -241,6 +241,12 @@ struct _MMBroadbandModemPrivate {
     MMSmsStorage current_sms_mem1_storage;
     gboolean mem2_storage_locked;
     MMSmsStorage current_sms_mem2_storage;
+    /* Parts notified with +CMTI, pending to be retrieved */
+    GArray *sms_fetch_pending;
+    guint sms_fetch_timeout_id;
+    gboolean sms_fetch_running;
+    guint sms_fetch_n_locks;
+    guint sms_fetch_n_parts;
 
     /*<--- Modem Voice interface --->*/
     /* Properties */
@@ -3118,6 +3124,36 @@ cgev_received (MMPortSerialAt   *port,
         break;
     }
 
+    /* Context activations, deactivations and modifications may all come
+     * with context definitions created, removed or updated by the device
+     * or the network */
+    switch (type) {
+    case MM_3GPP_CGEV_NW_ACT_PRIMARY:
+    case MM_3GPP_CGEV_ME_ACT_PRIMARY:
+    case MM_3GPP_CGEV_NW_DEACT_PRIMARY:
+    case MM_3GPP_CGEV_ME_DEACT_PRIMARY:
+    case MM_3GPP_CGEV_NW_ACT_SECONDARY:
+    case MM_3GPP_CGEV_ME_ACT_SECONDARY:
+    case MM_3GPP_CGEV_NW_DEACT_SECONDARY:
+    case MM_3GPP_CGEV_ME_DEACT_SECONDARY:
+    case MM_3GPP_CGEV_NW_DEACT_PDP:
+    case MM_3GPP_CGEV_ME_DEACT_PDP:
+    case MM_3GPP_CGEV_NW_MODIFY:
+    case MM_3GPP_CGEV_ME_MODIFY:
+    case MM_3GPP_CGEV_NW_REACT:
+        if (MM_IS_IFACE_MODEM_3GPP_PROFILE_MANAGER (self))
+            mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (MM_IFACE_MODEM_3GPP_PROFILE_MANAGER (self));
+        break;
+    case MM_3GPP_CGEV_UNKNOWN:
+    case MM_3GPP_CGEV_NW_DETACH:
+    case MM_3GPP_CGEV_ME_DETACH:
+    case MM_3GPP_CGEV_NW_CLASS:
+    case MM_3GPP_CGEV_ME_CLASS:
+    case MM_3GPP_CGEV_REJECT:
+    default:
+        break;
+    }
+
     g_free (str);
 }
 
@@ -6896,61 +6932,230 @@ modem_messaging_setup_cleanup_unsolicited_events_finish (MMIfaceModemMessaging *
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
+/* +CMTI indications received within this time window are retrieved together,
+ * with a single storage lock */
+#define SMS_FETCH_COALESCE_TIMEOUT_MS 200
+
+/* When in PDU mode, the minimum number of parts pending to be retrieved in
+ * order to list all parts in the storage instead of reading them one by one */
+#define SMS_FETCH_LIST_THRESHOLD 3
+
 typedef struct {
-    guint idx;
-} SmsPartContext;
+    MMSmsStorage storage;
+    guint        idx;
+} SmsPendingPart;
+
+typedef struct {
+    MMSmsStorage  storage;
+    GArray       *indexes;
+    guint         current;
+    guint         n_parts;
+} SmsFetchContext;
+
+static void sms_fetch_start (MMBroadbandModem *self);
+
+static void
+sms_fetch_context_free (SmsFetchContext *ctx)
+{
+    g_array_unref (ctx->indexes);
+    g_slice_free (SmsFetchContext, ctx);
+}
+
+static gboolean
+sms_fetch_timeout_cb (MMBroadbandModem *self)
+{
+    self->priv->sms_fetch_timeout_id = 0;
+    sms_fetch_start (self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+sms_fetch_schedule (MMBroadbandModem *self)
+{
+    /* If already running, pending parts are retrieved right after */
+    if (self->priv->sms_fetch_running || self->priv->sms_fetch_timeout_id)
+        return;
+
+    self->priv->sms_fetch_timeout_id = g_timeout_add (SMS_FETCH_COALESCE_TIMEOUT_MS,
+                                                      (GSourceFunc) sms_fetch_timeout_cb,
+                                                      self);
+}
+
+static void
+sms_fetch_complete (GTask *task)
+{
+    MMBroadbandModem *self;
+    SmsFetchContext  *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* Always always always unlock mem1 storage. Warned you've been. */
+    mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
+
+    self->priv->sms_fetch_n_locks++;
+    self->priv->sms_fetch_n_parts += ctx->n_parts;
+    mm_obj_dbg (self, "retrieved %u SMS parts with a single storage lock (%u parts in %u locks so far)",
+                ctx->n_parts, self->priv->sms_fetch_n_parts, self->priv->sms_fetch_n_locks);
+
+    self->priv->sms_fetch_running = FALSE;
+
+    /* Retrieve the parts notified while we were busy, they've already waited */
+    sms_fetch_start (self);
+
+    g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+static void sms_fetch_next_part (GTask *task);
 
 static void
 sms_part_ready (MMBroadbandModem *self,
                 GAsyncResult *res,
                 GTask *task)
 {
-    SmsPartContext *ctx;
+    SmsFetchContext *ctx;
     MMSmsPart *part;
     MM3gppPduInfo *info;
     const gchar *response;
     GError *error = NULL;
+    guint idx;
 
-    /* Always always always unlock mem1 storage. Warned you've been. */
-    mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
+    ctx = g_task_get_task_data (task);
+    idx = g_array_index (ctx->indexes, guint, ctx->current++);
 
     response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
     if (error) {
         /* We're really ignoring this error afterwards, as we don't have a callback
          * passed to the async operation, so just log the error here. */
         mm_obj_warn (self, "couldn't retrieve SMS part: '%s'", error->message);
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        g_error_free (error);
+        sms_fetch_next_part (task);
         return;
     }
 
-    ctx = g_task_get_task_data (task);
-
-    info = mm_3gpp_parse_cmgr_read_response (response, ctx->idx, &error);
+    info = mm_3gpp_parse_cmgr_read_response (response, idx, &error);
     if (!info) {
         mm_obj_warn (self, "couldn't parse SMS part: '%s'", error->message);
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        g_error_free (error);
+        sms_fetch_next_part (task);
         return;
     }
 
     part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, self, &error);
     if (part) {
-        mm_obj_dbg (self, "correctly parsed PDU (%d)", ctx->idx);
+        mm_obj_dbg (self, "correctly parsed PDU (%d)", idx);
         mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
                                             part,
                                             MM_SMS_STATE_RECEIVED,
                                             self->priv->modem_messaging_sms_default_storage);
+        ctx->n_parts++;
     } else {
         /* Don't treat the error as critical */
-        mm_obj_dbg (self, "error parsing PDU (%d): %s", ctx->idx, error->message);
+        mm_obj_dbg (self, "error parsing PDU (%d): %s", idx, error->message);
         g_error_free (error);
     }
 
-    /* All done */
     mm_3gpp_pdu_info_free (info);
-    g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    sms_fetch_next_part (task);
+}
+
+static void
+sms_fetch_next_part (GTask *task)
+{
+    MMBroadbandModem *self;
+    SmsFetchContext  *ctx;
+    gchar            *command;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* Skip parts already retrieved by other means */
+    while (ctx->current < ctx->indexes->len &&
+           self->priv->modem_messaging_sms_list &&
+           mm_sms_list_has_part (self->priv->modem_messaging_sms_list,
+                                 ctx->storage,
+                                 g_array_index (ctx->indexes, guint, ctx->current)))
+        ctx->current++;
+
+    if (ctx->current == ctx->indexes->len) {
+        sms_fetch_complete (task);
+        return;
+    }
+
+    /* Retrieve the message */
+    command = g_strdup_printf ("+CMGR=%u", g_array_index (ctx->indexes, guint, ctx->current));
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              command,
+                              10,
+                              FALSE,
+                              (GAsyncReadyCallback)sms_part_ready,
+                              task);
+    g_free (command);
+}
+
+static void
+sms_part_list_ready (MMBroadbandModem *self,
+                     GAsyncResult *res,
+                     GTask *task)
+{
+    SmsFetchContext *ctx;
+    const gchar *response;
+    GError *error = NULL;
+    GList *info_list = NULL;
+    GList *l;
+
+    ctx = g_task_get_task_data (task);
+
+    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
+    if (response)
+        info_list = mm_3gpp_parse_pdu_cmgl_response (response, &error);
+    if (error) {
+        /* Fallback to reading the parts one by one, we still hold the lock */
+        mm_obj_dbg (self, "couldn't list SMS parts: '%s'; reading them one by one", error->message);
+        g_error_free (error);
+        sms_fetch_next_part (task);
+        return;
+    }
+
+    for (l = info_list; l; l = g_list_next (l)) {
+        MM3gppPduInfo *info = l->data;
+        MMSmsPart *part;
+        guint i;
+
+        /* Listed parts don't need to be read one by one */
+        for (i = ctx->current; i < ctx->indexes->len; i++) {
+            if (g_array_index (ctx->indexes, guint, i) == (guint) info->index) {
+                g_array_remove_index (ctx->indexes, i);
+                break;
+            }
+        }
+
+        /* Only received parts we didn't process yet */
+        if ((info->status != 0 && info->status != 1) ||
+            !self->priv->modem_messaging_sms_list ||
+            mm_sms_list_has_part (self->priv->modem_messaging_sms_list, ctx->storage, info->index))
+            continue;
+
+        part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, self, &error);
+        if (part) {
+            mm_obj_dbg (self, "correctly parsed PDU (%d)", info->index);
+            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
+                                                part,
+                                                MM_SMS_STATE_RECEIVED,
+                                                self->priv->modem_messaging_sms_default_storage);
+            ctx->n_parts++;
+        } else {
+            /* Don't treat the error as critical */
+            mm_obj_dbg (self, "error parsing PDU (%d): %s", info->index, error->message);
+            g_clear_error (&error);
+        }
+    }
+
+    mm_3gpp_pdu_info_list_free (info_list);
+
+    /* Read one by one the notified parts that weren't listed, if any */
+    sms_fetch_next_part (task);
 }
 
 static void
@@ -6958,30 +7163,80 @@ indication_lock_storages_ready (MMBroadbandModem *self,
                                 GAsyncResult *res,
                                 GTask *task)
 {
-    SmsPartContext *ctx;
-    gchar *command;
+    SmsFetchContext *ctx;
     GError *error = NULL;
 
     if (!mm_broadband_modem_lock_sms_storages_finish (self, res, &error)) {
         /* TODO: we should either make this lock() never fail, by automatically
          * retrying after some time, or otherwise retry here. */
+        mm_obj_warn (self, "couldn't lock SMS storage: '%s'", error->message);
+        self->priv->sms_fetch_running = FALSE;
+        sms_fetch_schedule (self);
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
     /* Storage now set and locked */
-
-    /* Retrieve the message */
     ctx = g_task_get_task_data (task);
-    command = g_strdup_printf ("+CMGR=%d", ctx->idx);
-    mm_base_modem_at_command (MM_BASE_MODEM (self),
-                              command,
-                              10,
-                              FALSE,
-                              (GAsyncReadyCallback)sms_part_ready,
-                              task);
-    g_free (command);
+
+    if (self->priv->modem_messaging_sms_pdu_mode && ctx->indexes->len >= SMS_FETCH_LIST_THRESHOLD) {
+        mm_obj_dbg (self, "listing SMS parts in storage '%s' to retrieve %u notified parts",
+                    mm_sms_storage_get_string (ctx->storage), ctx->indexes->len);
+        mm_base_modem_at_command (MM_BASE_MODEM (self),
+                                  "+CMGL=4",
+                                  20,
+                                  FALSE,
+                                  (GAsyncReadyCallback)sms_part_list_ready,
+                                  task);
+        return;
+    }
+
+    sms_fetch_next_part (task);
+}
+
+static void
+sms_fetch_start (MMBroadbandModem *self)
+{
+    SmsFetchContext *ctx;
+    GTask           *task;
+    guint            i;
+
+    if (self->priv->sms_fetch_running || !self->priv->sms_fetch_pending->len)
+        return;
+
+    if (self->priv->sms_fetch_timeout_id) {
+        g_source_remove (self->priv->sms_fetch_timeout_id);
+        self->priv->sms_fetch_timeout_id = 0;
+    }
+
+    /* Take all pending parts in the same storage as the first one; parts in
+     * other storages will be retrieved afterwards */
+    ctx = g_slice_new0 (SmsFetchContext);
+    ctx->storage = g_array_index (self->priv->sms_fetch_pending, SmsPendingPart, 0).storage;
+    ctx->indexes = g_array_new (FALSE, FALSE, sizeof (guint));
+    for (i = 0; i < self->priv->sms_fetch_pending->len;) {
+        SmsPendingPart *pending;
+
+        pending = &g_array_index (self->priv->sms_fetch_pending, SmsPendingPart, i);
+        if (pending->storage == ctx->storage) {
+            g_array_append_val (ctx->indexes, pending->idx);
+            g_array_remove_index (self->priv->sms_fetch_pending, i);
+        } else
+            i++;
+    }
+
+    self->priv->sms_fetch_running = TRUE;
+
+    task = g_task_new (self, NULL, NULL, NULL);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) sms_fetch_context_free);
+
+    /* First, request to set the proper storage to read from */
+    mm_broadband_modem_lock_sms_storages (self,
+                                          ctx->storage,
+                                          MM_SMS_STORAGE_UNKNOWN,
+                                          (GAsyncReadyCallback)indication_lock_storages_ready,
+                                          task);
 }
 
 static void
@@ -6989,9 +7244,9 @@ cmti_received (MMPortSerialAt *port,
                GMatchInfo *info,
                MMBroadbandModem *self)
 {
-    SmsPartContext *ctx;
-    GTask *task;
+    SmsPendingPart pending;
     guint idx = 0;
+    guint i;
     MMSmsStorage storage;
     gchar *str;
 
@@ -7016,18 +7271,21 @@ cmti_received (MMPortSerialAt *port,
         return;
     }
 
-    ctx = g_new (SmsPartContext, 1);
-    ctx->idx = idx;
+    for (i = 0; i < self->priv->sms_fetch_pending->len; i++) {
+        SmsPendingPart *aux;
 
-    task = g_task_new (self, NULL, NULL, NULL);
-    g_task_set_task_data (task, ctx, g_free);
+        aux = &g_array_index (self->priv->sms_fetch_pending, SmsPendingPart, i);
+        if (aux->storage == storage && aux->idx == idx) {
+            mm_obj_dbg (self, "skipping CMTI indication, part already pending");
+            return;
+        }
+    }
 
-    /* First, request to set the proper storage to read from */
-    mm_broadband_modem_lock_sms_storages (self,
-                                          storage,
-                                          MM_SMS_STORAGE_UNKNOWN,
-                                          (GAsyncReadyCallback)indication_lock_storages_ready,
-                                          task);
+    /* Parts notified in a burst are retrieved together */
+    pending.storage = storage;
+    pending.idx = idx;
+    g_array_append_val (self->priv->sms_fetch_pending, pending);
+    sms_fetch_schedule (self);
 }
 
 static void
@@ -12001,6 +12259,7 @@ enable (MMBaseModem *self,
 
 typedef enum {
     SYNCING_STEP_FIRST,
+    SYNCING_STEP_FINGERPRINT,
     SYNCING_STEP_IFACE_MODEM,
     SYNCING_STEP_IFACE_3GPP,
     SYNCING_STEP_IFACE_TIME,
@@ -12009,6 +12268,8 @@ typedef enum {
 
 typedef struct {
     SyncingStep step;
+    /* Whether the 3GPP registration fingerprint changed during suspend */
+    gboolean    registration_changed;
 } SyncingContext;
 
 static void syncing_step (GTask *task);
@@ -12049,14 +12310,53 @@ iface_modem_3gpp_sync_ready (MMIfaceModem3gpp *self,
 
     ctx = g_task_get_task_data (task);
 
-    if (!mm_iface_modem_3gpp_sync_finish (self, res, &error))
+    if (!mm_iface_modem_3gpp_sync_finish (self, res, &ctx->registration_changed, &error)) {
         mm_obj_warn (self, "3GPP interface synchronization failed: %s", error->message);
+        ctx->registration_changed = TRUE;
+    }
 
     /* Go on to next step */
     ctx->step++;
     syncing_step (task);
 }
 
+static void
+fingerprint_equipment_identifier_ready (MMIfaceModem *self,
+                                        GAsyncResult *res,
+                                        GTask        *task)
+{
+    SyncingContext    *ctx;
+    const gchar       *previous;
+    g_autofree gchar  *current = NULL;
+    g_autoptr(GError)  error = NULL;
+
+    ctx = g_task_get_task_data (task);
+
+    current = MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier_finish (self, res, &error);
+    if (!current) {
+        /* Not conclusive, the SIM swap check will still catch a replaced SIM */
+        mm_obj_dbg (self, "couldn't reload equipment identifier: %s", error->message);
+        ctx->step++;
+        syncing_step (task);
+        return;
+    }
+
+    previous = mm_gdbus_modem_get_equipment_identifier (MM_GDBUS_MODEM (MM_BROADBAND_MODEM (self)->priv->modem_dbus_skeleton));
+    if (previous && !g_str_equal (previous, current)) {
+        /* A different module behind the same ports, reprobe it from scratch */
+        mm_obj_warn (self, "equipment identifier changed during suspend... synchronization aborted");
+        mm_base_modem_process_identity_change (MM_BASE_MODEM (self));
+        g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_ABORTED,
+                                 "Equipment identifier changed during suspend");
+        g_object_unref (task);
+        return;
+    }
+
+    mm_obj_dbg (self, "equipment identifier unchanged, continue synchronization");
+    ctx->step++;
+    syncing_step (task);
+}
+
 static void
 iface_modem_sync_ready (MMIfaceModem *self,
                         GAsyncResult *res,
@@ -12103,6 +12403,31 @@ syncing_step (GTask *task)
 
     switch (ctx->step) {
     case SYNCING_STEP_FIRST:
+        if (!self->priv->modem_dbus_skeleton) {
+            g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_ABORTED,
+                                     "Synchronization aborted: no modem exposed in DBus");
+            g_object_unref (task);
+            return;
+        }
+        ctx->step++;
+        /* fall through */
+
+    case SYNCING_STEP_FINGERPRINT:
+        /*
+         * Cheap check that this is still the same modem: the ports were
+         * already validated, so just reload the equipment identifier. The
+         * SIM identifier is checked by the modem interface sync.
+         */
+        if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier_finish) {
+            mm_obj_info (self, "resume synchronization state (%d/%d): fingerprint",
+                         ctx->step, SYNCING_STEP_LAST);
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier (
+                MM_IFACE_MODEM (self),
+                (GAsyncReadyCallback)fingerprint_equipment_identifier_ready,
+                task);
+            return;
+        }
         ctx->step++;
         /* fall through */
 
@@ -12112,12 +12437,6 @@ syncing_step (GTask *task)
          * We want to make sure that the SIM is unlocked and not swapped before
          * synchronizing other interfaces.
          */
-        if (!self->priv->modem_dbus_skeleton) {
-            g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_ABORTED,
-                                     "Synchronization aborted: no modem exposed in DBus");
-            g_object_unref (task);
-            return;
-        }
         mm_obj_info (self, "resume synchronization state (%d/%d): modem interface sync",
                      ctx->step, SYNCING_STEP_LAST);
         mm_iface_modem_sync (MM_IFACE_MODEM (self),
@@ -12143,9 +12462,14 @@ syncing_step (GTask *task)
 
     case SYNCING_STEP_IFACE_TIME:
         /*
-         * Synchronize asynchronously the Time interface.
+         * Synchronize asynchronously the Time interface. The network
+         * timezone is only reloaded if the modem didn't stay registered in
+         * the same network during the suspend.
          */
-        if (self->priv->modem_time_dbus_skeleton) {
+        if (self->priv->modem_time_dbus_skeleton && !ctx->registration_changed) {
+            mm_obj_info (self, "resume synchronization state (%d/%d): time interface sync skipped, registration unchanged",
+                         ctx->step, SYNCING_STEP_LAST);
+        } else if (self->priv->modem_time_dbus_skeleton) {
             mm_obj_info (self, "resume synchronization state (%d/%d): time interface sync",
                          ctx->step, SYNCING_STEP_LAST);
             mm_iface_modem_time_sync (MM_IFACE_MODEM_TIME (self), (GAsyncReadyCallback)iface_modem_time_sync_ready, task);
@@ -12194,6 +12518,7 @@ synchronize (MMBaseModem         *self,
     /* Create SyncingContext */
     ctx = g_new0 (SyncingContext, 1);
     ctx->step = SYNCING_STEP_FIRST;
+    ctx->registration_changed = TRUE;
     g_task_set_task_data (task, ctx, (GDestroyNotify)g_free);
 
     syncing_step (task);
@@ -13209,6 +13534,7 @@ mm_broadband_modem_init (MMBroadbandModem *self)
     self->priv->modem_cmer_disable_mode = MM_3GPP_CMER_MODE_NONE;
     self->priv->modem_cmer_ind = MM_3GPP_CMER_IND_NONE;
     self->priv->flow_control = MM_FLOW_CONTROL_NONE;
+    self->priv->sms_fetch_pending = g_array_new (FALSE, FALSE, sizeof (SmsPendingPart));
 }
 
 static void
@@ -13230,6 +13556,8 @@ finalize (GObject *object)
 
     g_free (self->priv->carrier_config_mapping);
 
+    g_array_unref (self->priv->sms_fetch_pending);
+
     G_OBJECT_CLASS (mm_broadband_modem_parent_class)->finalize (object);
 }
 
@@ -13306,6 +13634,11 @@ dispose (GObject *object)
     g_clear_object (&self->priv->modem_voice_call_list);
     g_clear_object (&self->priv->modem_simple_status);
 
+    if (self->priv->sms_fetch_timeout_id) {
+        g_source_remove (self->priv->sms_fetch_timeout_id);
+        self->priv->sms_fetch_timeout_id = 0;
+    }
+
     G_OBJECT_CLASS (mm_broadband_modem_parent_class)->dispose (object);
 }
 
@@ -588,7 +588,35 @@ mm_charset_can_convert_to (const gchar    *utf8,
 }
 
 /******************************************************************************/
-/* GSM-7 pack/unpack operations */
+/* GSM-7 pack/unpack operations
+ *
+ * Septets are packed as a little-endian bit stream, so whenever the bit
+ * position is byte-aligned, 8 septets map exactly to 7 octets and can be
+ * processed at once through a 64-bit word. The unaligned head (at most 7
+ * septets, depending on the start offset) and the tail are processed one
+ * septet at a time. */
+
+static inline guint8
+gsm_unpack_septet (const guint8 *gsm,
+                   guint32       start_bit)
+{
+    guint8 bits_here, bits_in_next, octet, offset, c;
+
+    offset = start_bit % 8;  /* Offset to start of char in this byte */
+    bits_here = offset ? (8 - offset) : 7;
+    bits_in_next = 7 - bits_here;
+
+    /* Grab bits in the current byte */
+    octet = gsm[start_bit / 8];
+    c = (octet >> offset) & (0xFF >> (8 - bits_here));
+
+    /* Grab any bits that spilled over to next byte */
+    if (bits_in_next) {
+        octet = gsm[(start_bit / 8) + 1];
+        c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
+    }
+    return c;
+}
 
 guint8 *
 mm_charset_gsm_unpack (const guint8 *gsm,
@@ -596,34 +624,59 @@ mm_charset_gsm_unpack (const guint8 *gsm,
                        guint8        start_offset,  /* in _bits_ */
                        guint32      *out_unpacked_len)
 {
-    GByteArray *unpacked;
-    guint i;
+    guint8  *unpacked;
+    guint32  start_bit;
+    guint32  i = 0;
+
+    unpacked = g_malloc0 (num_septets + 1);
+
+    /* Unaligned head */
+    for (start_bit = start_offset; i < num_septets && (start_bit % 8); i++, start_bit += 7)
+        unpacked[i] = gsm_unpack_septet (gsm, start_bit);
+
+    /* Blocks of 8 septets in 7 octets */
+    for (; i + 8 <= num_septets; i += 8, start_bit += 56) {
+        const guint8 *in;
+        guint64       block;
+        guint         j;
+
+        in = &gsm[start_bit / 8];
+        block = ((guint64) in[0])       |
+                ((guint64) in[1] << 8)  |
+                ((guint64) in[2] << 16) |
+                ((guint64) in[3] << 24) |
+                ((guint64) in[4] << 32) |
+                ((guint64) in[5] << 40) |
+                ((guint64) in[6] << 48);
+        for (j = 0; j < 8; j++)
+            unpacked[i + j] = (guint8) ((block >> (7 * j)) & 0x7F);
+    }
 
-    unpacked = g_byte_array_sized_new (num_septets + 1);
+    /* Tail */
+    for (; i < num_septets; i++, start_bit += 7)
+        unpacked[i] = gsm_unpack_septet (gsm, start_bit);
 
-    for (i = 0; i < num_septets; i++) {
-        guint8 bits_here, bits_in_next, octet, offset, c;
-        guint32 start_bit;
+    *out_unpacked_len = num_septets;
+    return unpacked;
+}
 
-        start_bit = start_offset + (i * 7); /* Overall bit offset of char in buffer */
-        offset = start_bit % 8;  /* Offset to start of char in this byte */
-        bits_here = offset ? (8 - offset) : 7;
-        bits_in_next = 7 - bits_here;
+static inline void
+gsm_pack_septet (guint8  *packed,
+                 guint    plen,
+                 guint32  start_bit,
+                 guint8   septet)
+{
+    guint octet, lshift;
 
-        /* Grab bits in the current byte */
-        octet = gsm[start_bit / 8];
-        c = (octet >> offset) & (0xFF >> (8 - bits_here));
+    octet = start_bit / 8;
+    lshift = start_bit % 8;
 
-        /* Grab any bits that spilled over to next byte */
-        if (bits_in_next) {
-            octet = gsm[(start_bit / 8) + 1];
-            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
-        }
-        g_byte_array_append (unpacked, &c, 1);
+    packed[octet] |= (septet & 0x7F) << lshift;
+    if (lshift > 1) {
+        /* Grab the lost bits and add to next octet */
+        g_assert (octet + 1 < plen);
+        packed[octet + 1] |= (septet & 0x7F) >> (8 - lshift);
     }
-
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
 }
 
 guint8 *
@@ -632,9 +685,10 @@ mm_charset_gsm_pack (const guint8 *src,
                      guint8        start_offset,
                      guint32      *out_packed_len)
 {
-    guint8 *packed;
-    guint octet = 0, lshift, plen;
-    guint i = 0;
+    guint8  *packed;
+    guint    plen;
+    guint32  start_bit;
+    guint32  i = 0;
 
     g_return_val_if_fail (start_offset < 8, NULL);
 
@@ -645,23 +699,247 @@ mm_charset_gsm_pack (const guint8 *src,
 
     packed = g_malloc0 (plen);
 
-    for (i = 0, lshift = start_offset; i < src_len; i++) {
-        packed[octet] |= (src[i] & 0x7F) << lshift;
-        if (lshift > 1) {
-            /* Grab the lost bits and add to next octet */
-            g_assert (octet + 1 < plen);
-            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
-        }
-        if (lshift)
-            octet++;
-        lshift = lshift ? lshift - 1 : 7;
+    /* Unaligned head */
+    for (start_bit = start_offset; i < src_len && (start_bit % 8); i++, start_bit += 7)
+        gsm_pack_septet (packed, plen, start_bit, src[i]);
+
+    /* Blocks of 8 septets in 7 octets */
+    for (; i + 8 <= src_len; i += 8, start_bit += 56) {
+        guint8  *out;
+        guint64  block = 0;
+        guint    j;
+
+        for (j = 0; j < 8; j++)
+            block |= ((guint64) (src[i + j] & 0x7F)) << (7 * j);
+
+        out = &packed[start_bit / 8];
+        for (j = 0; j < 7; j++)
+            out[j] = (guint8) (block >> (8 * j));
     }
 
+    /* Tail */
+    for (; i < src_len; i++, start_bit += 7)
+        gsm_pack_septet (packed, plen, start_bit, src[i]);
+
     if (out_packed_len)
         *out_packed_len = plen;
     return packed;
 }
 
+/*****************************************************************************/
+/* Cached iconv converters
+ *
+ * g_convert() opens and closes an iconv descriptor on every call, which is
+ * far more expensive than the conversion itself for the short strings we
+ * usually deal with (operator names, USSD responses, SMS texts...). Keep
+ * the converters open instead, one per charset and direction, in a per-thread
+ * cache so that no locking is required. */
+
+typedef struct {
+    GIConv from_utf8[G_N_ELEMENTS (charset_settings)];
+    GIConv to_utf8[G_N_ELEMENTS (charset_settings)];
+} IconvCache;
+
+static void
+iconv_cache_free (gpointer data)
+{
+    IconvCache *cache = data;
+    guint       i;
+
+    for (i = 0; i < G_N_ELEMENTS (charset_settings); i++) {
+        if (cache->from_utf8[i] != (GIConv) -1)
+            g_iconv_close (cache->from_utf8[i]);
+        if (cache->to_utf8[i] != (GIConv) -1)
+            g_iconv_close (cache->to_utf8[i]);
+    }
+    g_slice_free (IconvCache, cache);
+}
+
+static GPrivate iconv_cache_private = G_PRIVATE_INIT (iconv_cache_free);
+
+static GIConv
+iconv_cache_lookup (const CharsetSettings *settings,
+                    gboolean               from_utf8)
+{
+    IconvCache *cache;
+    GIConv     *cd;
+    guint       i;
+
+    cache = g_private_get (&iconv_cache_private);
+    if (!cache) {
+        cache = g_slice_new (IconvCache);
+        for (i = 0; i < G_N_ELEMENTS (charset_settings); i++) {
+            cache->from_utf8[i] = (GIConv) -1;
+            cache->to_utf8[i] = (GIConv) -1;
+        }
+        g_private_set (&iconv_cache_private, cache);
+    }
+
+    i = settings - charset_settings;
+    cd = from_utf8 ? &cache->from_utf8[i] : &cache->to_utf8[i];
+
+    /* Failures are not cached; the caller falls back to g_convert() so that
+     * the proper error is reported */
+    if (*cd == (GIConv) -1)
+        *cd = from_utf8 ?
+            g_iconv_open (settings->iconv_name, "UTF-8") :
+            g_iconv_open ("UTF-8", settings->iconv_name);
+    else
+        /* Reset any shift state left by a previous failed conversion */
+        g_iconv (*cd, NULL, NULL, NULL, NULL);
+
+    return *cd;
+}
+
+static gchar *
+charset_iconv_convert (const gchar            *str,
+                       gssize                  len,
+                       const CharsetSettings  *settings,
+                       gboolean                from_utf8,
+                       gsize                  *bytes_written,
+                       GError                **error)
+{
+    GIConv cd;
+
+    cd = iconv_cache_lookup (settings, from_utf8);
+    if (cd == (GIConv) -1)
+        return from_utf8 ?
+            g_convert (str, len, settings->iconv_name, "UTF-8", NULL, bytes_written, error) :
+            g_convert (str, len, "UTF-8", settings->iconv_name, NULL, bytes_written, error);
+
+    return g_convert_with_iconv (str, len, cd, NULL, bytes_written, error);
+}
+
+/*****************************************************************************/
+/* Fast paths for the most common charsets
+ *
+ * UCS2, IRA and 8859-1 are trivial mappings of the Unicode code points, so
+ * they don't need iconv at all. These paths only handle input that is known
+ * to be convertible; anything else (invalid input, characters not available
+ * in the target charset...) is left to iconv, so that errors and
+ * transliteration behave exactly as before. Outputs are NUL-terminated like
+ * the ones returned by g_convert(), as some callers rely on that. */
+
+/* Same NUL terminator length as used by g_convert() */
+#define FAST_PATH_NUL_TERMINATOR_LENGTH 4
+
+static gboolean
+charset_fast_from_utf8 (const gchar    *utf8,
+                        MMModemCharset  charset,
+                        guint8        **out,
+                        guint          *out_size)
+{
+    const gchar *p;
+    gsize        utf8_len;
+    guint8      *encoded = NULL;
+    guint        n = 0;
+
+    utf8_len = strlen (utf8);
+
+    if (charset == MM_MODEM_CHARSET_IRA) {
+        for (p = utf8; *p; p++) {
+            if ((guint8) *p >= 0x80)
+                return FALSE;
+        }
+        encoded = g_malloc (utf8_len + FAST_PATH_NUL_TERMINATOR_LENGTH);
+        memcpy (encoded, utf8, utf8_len);
+        n = utf8_len;
+    } else if (charset == MM_MODEM_CHARSET_8859_1 || charset == MM_MODEM_CHARSET_UCS2) {
+        if (!g_utf8_validate (utf8, utf8_len, NULL))
+            return FALSE;
+
+        /* Each input byte generates at most 2 output bytes */
+        encoded = g_malloc (utf8_len * 2 + FAST_PATH_NUL_TERMINATOR_LENGTH);
+        for (p = utf8; *p; p = g_utf8_next_char (p)) {
+            gunichar c;
+
+            c = g_utf8_get_char (p);
+            if (charset == MM_MODEM_CHARSET_8859_1) {
+                if (c > 0xFF)
+                    goto out_unsupported;
+                encoded[n++] = (guint8) c;
+            } else {
+                if (c > 0xFFFF)
+                    goto out_unsupported;
+                encoded[n++] = (guint8) (c >> 8);
+                encoded[n++] = (guint8) (c & 0xFF);
+            }
+        }
+    } else
+        return FALSE;
+
+    memset (&encoded[n], 0, FAST_PATH_NUL_TERMINATOR_LENGTH);
+    *out = encoded;
+    *out_size = n;
+    return TRUE;
+
+out_unsupported:
+    g_free (encoded);
+    return FALSE;
+}
+
+static gboolean
+charset_fast_to_utf8 (const guint8    *data,
+                      guint32          len,
+                      MMModemCharset   charset,
+                      gchar          **out)
+{
+    gchar   *utf8;
+    guint32  i;
+    guint    n = 0;
+
+    if (charset == MM_MODEM_CHARSET_IRA) {
+        for (i = 0; i < len; i++) {
+            if (data[i] >= 0x80)
+                return FALSE;
+        }
+        utf8 = g_malloc (len + FAST_PATH_NUL_TERMINATOR_LENGTH);
+        memcpy (utf8, data, len);
+        n = len;
+    } else if (charset == MM_MODEM_CHARSET_8859_1) {
+        utf8 = g_malloc (len * 2 + FAST_PATH_NUL_TERMINATOR_LENGTH);
+        for (i = 0; i < len; i++) {
+            if (data[i] < 0x80)
+                utf8[n++] = (gchar) data[i];
+            else {
+                utf8[n++] = (gchar) (0xC0 | (data[i] >> 6));
+                utf8[n++] = (gchar) (0x80 | (data[i] & 0x3F));
+            }
+        }
+    } else if (charset == MM_MODEM_CHARSET_UCS2) {
+        /* Partial characters and surrogates are errors in UCS-2 */
+        if (len % 2)
+            return FALSE;
+        for (i = 0; i < len; i += 2) {
+            if (data[i] >= 0xD8 && data[i] <= 0xDF)
+                return FALSE;
+        }
+
+        /* Each 2-byte input character generates at most 3 output bytes */
+        utf8 = g_malloc ((len / 2) * 3 + FAST_PATH_NUL_TERMINATOR_LENGTH);
+        for (i = 0; i < len; i += 2) {
+            guint16 c;
+
+            c = (data[i] << 8) | data[i + 1];
+            if (c < 0x80)
+                utf8[n++] = (gchar) c;
+            else if (c < 0x800) {
+                utf8[n++] = (gchar) (0xC0 | (c >> 6));
+                utf8[n++] = (gchar) (0x80 | (c & 0x3F));
+            } else {
+                utf8[n++] = (gchar) (0xE0 | (c >> 12));
+                utf8[n++] = (gchar) (0x80 | ((c >> 6) & 0x3F));
+                utf8[n++] = (gchar) (0x80 | (c & 0x3F));
+            }
+        }
+    } else
+        return FALSE;
+
+    memset (&utf8[n], 0, FAST_PATH_NUL_TERMINATOR_LENGTH);
+    *out = utf8;
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Main conversion functions */
 
@@ -675,10 +953,15 @@ charset_iconv_from_utf8 (const gchar            *utf8,
     g_autoptr(GError)      inner_error = NULL;
     gsize                  bytes_written = 0;
     g_autofree guint8     *encoded = NULL;
+    guint                  encoded_size = 0;
 
-    encoded = (guint8 *) g_convert (utf8, -1,
-                                    settings->iconv_name, "UTF-8",
-                                    NULL, &bytes_written, &inner_error);
+    if (charset_fast_from_utf8 (utf8, settings->charset, &encoded, &encoded_size)) {
+        if (out_size)
+            *out_size = encoded_size;
+        return g_steal_pointer (&encoded);
+    }
+
+    encoded = (guint8 *) charset_iconv_convert (utf8, -1, settings, TRUE, &bytes_written, &inner_error);
     if (encoded) {
         if (out_size)
             *out_size = (guint) bytes_written;
@@ -800,10 +1083,10 @@ charset_iconv_to_utf8 (const guint8           *data,
     g_autoptr(GError)  inner_error = NULL;
     g_autofree gchar  *utf8 = NULL;
 
-    utf8 = g_convert ((const gchar *) data, len,
-                      "UTF-8",
-                      settings->iconv_name,
-                      NULL, NULL, &inner_error);
+    if (charset_fast_to_utf8 (data, len, settings->charset, &utf8))
+        return g_steal_pointer (&utf8);
+
+    utf8 = charset_iconv_convert ((const gchar *) data, len, settings, FALSE, NULL, &inner_error);
     if (utf8)
         return g_steal_pointer (&utf8);
 
@@ -937,29 +1220,23 @@ mm_modem_charsets_init (void)
 
     mm_obj_dbg (NULL, "[charsets] detecting platform iconv() support...");
     for (i = 0; i < G_N_ELEMENTS (charset_settings); i++) {
-        g_autofree guint8 *enc = NULL;
-        guint              enc_size;
-        g_autofree gchar  *dec = NULL;
+        g_autofree gchar *enc = NULL;
+        gsize             enc_size = 0;
+        g_autofree gchar *dec = NULL;
 
         if (!charset_settings[i].iconv_name)
             continue;
 
-        enc = charset_iconv_from_utf8 (default_test_str,
-                                       &charset_settings[i],
-                                       FALSE,
-                                       &enc_size,
-                                       NULL);
+        /* Go through iconv explicitly, bypassing the fast paths; this also
+         * opens the cached converters for the main thread */
+        enc = charset_iconv_convert (default_test_str, -1, &charset_settings[i], TRUE, &enc_size, NULL);
         if (!enc) {
             mm_obj_dbg (NULL, "[charsets]   %s: iconv conversion to charset not supported", charset_settings[i].iconv_name);
             continue;
         }
 
-        dec = charset_iconv_to_utf8 (enc,
-                                     enc_size,
-                                     &charset_settings[i],
-                                     FALSE,
-                                     NULL);
-        if (!enc) {
+        dec = charset_iconv_convert (enc, enc_size, &charset_settings[i], FALSE, NULL, NULL);
+        if (!dec) {
             mm_obj_dbg (NULL, "[charsets]   %s: iconv conversion from charset not supported", charset_settings[i].iconv_name);
             continue;
         }
@@ -41,6 +41,10 @@ static gboolean      debug;
 static MMFilterRule  filter_policy = MM_FILTER_POLICY_STRICT;
 static gboolean      no_auto_scan = NO_AUTO_SCAN_DEFAULT;
 static const gchar  *initial_kernel_events;
+static gboolean      no_identity_cache;
+#if defined WITH_SYSTEMD_SUSPEND_RESUME
+static gboolean      quick_suspend_resume;
+#endif
 
 static gboolean
 filter_policy_option_arg (const gchar  *option_name,
@@ -80,6 +84,18 @@ static const GOptionEntry entries[] = {
         "Path to initial kernel events file",
         "[PATH]"
     },
+    {
+        "no-identity-cache", 0, 0, G_OPTION_ARG_NONE, &no_identity_cache,
+        "Don't cache static modem and SIM information across restarts",
+        NULL
+    },
+#if defined WITH_SYSTEMD_SUSPEND_RESUME
+    {
+        "quick-suspend-resume", 0, 0, G_OPTION_ARG_NONE, &quick_suspend_resume,
+        "Keep modems across host suspension and only synchronize their state on resume",
+        NULL
+    },
+#endif
     {
         "debug", 0, 0, G_OPTION_ARG_NONE, &debug,
         "Run with extended debugging capabilities",
@@ -116,6 +132,20 @@ mm_context_get_no_auto_scan (void)
     return no_auto_scan;
 }
 
+gboolean
+mm_context_get_no_identity_cache (void)
+{
+    return no_identity_cache;
+}
+
+#if defined WITH_SYSTEMD_SUSPEND_RESUME
+gboolean
+mm_context_get_quick_suspend_resume (void)
+{
+    return quick_suspend_resume;
+}
+#endif
+
 MMFilterRule
 mm_context_get_filter_policy (void)
 {
@@ -223,6 +253,7 @@ static gboolean  test_quick_suspend_resume;
 static gboolean  test_no_qrtr;
 #endif
 static gboolean  test_multiplex_requested;
+static gboolean  test_legacy_at_parser;
 
 static const GOptionEntry test_entries[] = {
     {
@@ -271,6 +302,11 @@ static const GOptionEntry test_entries[] = {
         "Default to request multiplex support if no explicitly given",
         NULL
     },
+    {
+        "test-legacy-at-parser", 0, 0, G_OPTION_ARG_NONE, &test_legacy_at_parser,
+        "Use the legacy regex based parser for AT command responses",
+        NULL
+    },
     { NULL }
 };
 
@@ -341,6 +377,12 @@ mm_context_get_test_multiplex_requested (void)
     return test_multiplex_requested;
 }
 
+gboolean
+mm_context_get_test_legacy_at_parser (void)
+{
+    return test_legacy_at_parser;
+}
+
 /*****************************************************************************/
 
 static void
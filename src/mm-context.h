@@ -31,6 +31,10 @@ void mm_context_init (gint    argc,
 gboolean     mm_context_get_debug                 (void);
 const gchar *mm_context_get_initial_kernel_events (void);
 gboolean     mm_context_get_no_auto_scan          (void);
+gboolean     mm_context_get_no_identity_cache     (void);
+#if defined WITH_SYSTEMD_SUSPEND_RESUME
+gboolean     mm_context_get_quick_suspend_resume  (void);
+#endif
 
 /* Filter support */
 MMFilterRule mm_context_get_filter_policy (void);
@@ -57,5 +61,6 @@ gboolean     mm_context_get_test_quick_suspend_resume (void);
 gboolean     mm_context_get_test_no_qrtr (void);
 #endif
 gboolean     mm_context_get_test_multiplex_requested (void);
+gboolean     mm_context_get_test_legacy_at_parser    (void);
 
 #endif /* MM_CONTEXT_H */
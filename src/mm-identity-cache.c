@@ -0,0 +1,269 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#define MM_LOG_NO_OBJECT
+#include "mm-log.h"
+#include "mm-identity-cache.h"
+
+/* Increase whenever the meaning of any of the stored keys changes, so that
+ * caches written by older versions are discarded */
+#define IDENTITY_CACHE_VERSION     1
+#define IDENTITY_CACHE_GROUP       "cache"
+#define IDENTITY_CACHE_KEY_VERSION "Version"
+
+static GKeyFile *cache_keyfile;
+static gchar    *cache_path;
+static gboolean  cache_dirty;
+
+static void
+cache_reset (void)
+{
+    if (cache_keyfile)
+        g_key_file_unref (cache_keyfile);
+    cache_keyfile = g_key_file_new ();
+    g_key_file_set_integer (cache_keyfile, IDENTITY_CACHE_GROUP, IDENTITY_CACHE_KEY_VERSION, IDENTITY_CACHE_VERSION);
+}
+
+void
+mm_identity_cache_setup (const gchar *path)
+{
+    g_autoptr(GError) error = NULL;
+
+    mm_identity_cache_shutdown ();
+
+    if (!path) {
+        mm_dbg ("identity cache disabled");
+        return;
+    }
+
+    cache_path = g_strdup (path);
+    cache_reset ();
+
+    if (!g_key_file_load_from_file (cache_keyfile, cache_path, G_KEY_FILE_NONE, &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            mm_warn ("couldn't load identity cache from %s: %s", cache_path, error->message);
+        cache_reset ();
+        return;
+    }
+
+    if (g_key_file_get_integer (cache_keyfile, IDENTITY_CACHE_GROUP, IDENTITY_CACHE_KEY_VERSION, NULL) != IDENTITY_CACHE_VERSION) {
+        mm_dbg ("discarding identity cache from %s: unsupported version", cache_path);
+        cache_reset ();
+        cache_dirty = TRUE;
+        return;
+    }
+
+    mm_dbg ("identity cache loaded from %s", cache_path);
+}
+
+void
+mm_identity_cache_shutdown (void)
+{
+    mm_identity_cache_flush ();
+
+    g_clear_pointer (&cache_keyfile, g_key_file_unref);
+    g_clear_pointer (&cache_path, g_free);
+    cache_dirty = FALSE;
+}
+
+gboolean
+mm_identity_cache_is_enabled (void)
+{
+    return !!cache_keyfile;
+}
+
+/*****************************************************************************/
+
+static gboolean
+device_group_valid (const gchar *device)
+{
+    /* The device UID may be given by the user, so ensure it can be used as
+     * group name, and that it doesn't clash with our own group */
+    return (device &&
+            device[0] &&
+            !strpbrk (device, "[]\r\n") &&
+            g_strcmp0 (device, IDENTITY_CACHE_GROUP) != 0);
+}
+
+gboolean
+mm_identity_cache_has_device (const gchar *device)
+{
+    return (cache_keyfile &&
+            device_group_valid (device) &&
+            g_key_file_has_group (cache_keyfile, device));
+}
+
+void
+mm_identity_cache_remove_device (const gchar *device)
+{
+    if (!mm_identity_cache_has_device (device))
+        return;
+
+    g_key_file_remove_group (cache_keyfile, device, NULL);
+    cache_dirty = TRUE;
+}
+
+gboolean
+mm_identity_cache_has_key (const gchar *device,
+                           const gchar *key)
+{
+    return (mm_identity_cache_has_device (device) &&
+            g_key_file_has_key (cache_keyfile, device, key, NULL));
+}
+
+gchar *
+mm_identity_cache_get_string (const gchar *device,
+                              const gchar *key)
+{
+    if (!mm_identity_cache_has_device (device))
+        return NULL;
+
+    return g_key_file_get_string (cache_keyfile, device, key, NULL);
+}
+
+gboolean
+mm_identity_cache_get_uint (const gchar *device,
+                            const gchar *key,
+                            guint       *value)
+{
+    g_autoptr(GError) error = NULL;
+    guint64           aux;
+
+    if (!mm_identity_cache_has_device (device))
+        return FALSE;
+
+    aux = g_key_file_get_uint64 (cache_keyfile, device, key, &error);
+    if (error || aux > G_MAXUINT)
+        return FALSE;
+
+    *value = (guint) aux;
+    return TRUE;
+}
+
+void
+mm_identity_cache_set_string (const gchar *device,
+                              const gchar *key,
+                              const gchar *value)
+{
+    g_autofree gchar *current = NULL;
+
+    if (!cache_keyfile || !device_group_valid (device))
+        return;
+
+    if (!value) {
+        mm_identity_cache_remove_key (device, key);
+        return;
+    }
+
+    /* Values with line breaks are not supported by the key file format */
+    if (strpbrk (value, "\r\n")) {
+        mm_identity_cache_remove_key (device, key);
+        return;
+    }
+
+    current = g_key_file_get_string (cache_keyfile, device, key, NULL);
+    if (g_strcmp0 (current, value) == 0)
+        return;
+
+    g_key_file_set_string (cache_keyfile, device, key, value);
+    cache_dirty = TRUE;
+}
+
+void
+mm_identity_cache_set_uint (const gchar *device,
+                            const gchar *key,
+                            guint        value)
+{
+    guint current;
+
+    if (!cache_keyfile || !device_group_valid (device))
+        return;
+
+    if (mm_identity_cache_get_uint (device, key, &current) && current == value)
+        return;
+
+    g_key_file_set_uint64 (cache_keyfile, device, key, value);
+    cache_dirty = TRUE;
+}
+
+void
+mm_identity_cache_remove_key (const gchar *device,
+                              const gchar *key)
+{
+    if (!mm_identity_cache_has_device (device))
+        return;
+
+    if (g_key_file_remove_key (cache_keyfile, device, key, NULL))
+        cache_dirty = TRUE;
+}
+
+void
+mm_identity_cache_remove_keys_with_prefix (const gchar *prefix)
+{
+    g_auto(GStrv) groups = NULL;
+    guint         i;
+
+    if (!cache_keyfile)
+        return;
+
+    groups = g_key_file_get_groups (cache_keyfile, NULL);
+    for (i = 0; groups[i]; i++) {
+        g_auto(GStrv) keys = NULL;
+        guint         j;
+
+        if (g_str_equal (groups[i], IDENTITY_CACHE_GROUP))
+            continue;
+
+        keys = g_key_file_get_keys (cache_keyfile, groups[i], NULL, NULL);
+        for (j = 0; keys && keys[j]; j++) {
+            if (g_str_has_prefix (keys[j], prefix) &&
+                g_key_file_remove_key (cache_keyfile, groups[i], keys[j], NULL))
+                cache_dirty = TRUE;
+        }
+    }
+}
+
+/*****************************************************************************/
+
+void
+mm_identity_cache_flush (void)
+{
+    g_autoptr(GError)  error = NULL;
+    g_autofree gchar  *dirname = NULL;
+
+    if (!cache_keyfile || !cache_dirty)
+        return;
+
+    cache_dirty = FALSE;
+
+    dirname = g_path_get_dirname (cache_path);
+    if (g_mkdir_with_parents (dirname, 0700) < 0) {
+        mm_warn ("couldn't create identity cache directory %s: %s", dirname, g_strerror (errno));
+        return;
+    }
+
+    if (!g_key_file_save_to_file (cache_keyfile, cache_path, &error)) {
+        mm_warn ("couldn't write identity cache to %s: %s", cache_path, error->message);
+        return;
+    }
+
+    mm_dbg ("identity cache written to %s", cache_path);
+}
@@ -0,0 +1,74 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_IDENTITY_CACHE_H
+#define MM_IDENTITY_CACHE_H
+
+#include <glib.h>
+
+/* Persistent cache of static modem and SIM information, so that it doesn't
+ * need to be queried again on every daemon restart. Entries are keyed by the
+ * physical device UID, and each entry stores the info required to validate
+ * it (e.g. firmware revision) along with the cached values. */
+
+#define MM_IDENTITY_CACHE_FILENAME "identity-cache"
+
+/* Validation keys */
+#define MM_IDENTITY_CACHE_KEY_VENDOR_ID          "VendorId"
+#define MM_IDENTITY_CACHE_KEY_PRODUCT_ID         "ProductId"
+#define MM_IDENTITY_CACHE_KEY_PLUGIN             "Plugin"
+#define MM_IDENTITY_CACHE_KEY_REVISION           "Revision"
+#define MM_IDENTITY_CACHE_KEY_SIM_IDENTIFIER     "SimIdentifier"
+#define MM_IDENTITY_CACHE_KEY_PHYSDEV_REVISION   "PhysdevRevision"
+
+/* Cached values */
+#define MM_IDENTITY_CACHE_KEY_MANUFACTURER       "Manufacturer"
+#define MM_IDENTITY_CACHE_KEY_MODEL              "Model"
+#define MM_IDENTITY_CACHE_KEY_HARDWARE_REVISION  "HardwareRevision"
+#define MM_IDENTITY_CACHE_KEY_SUPPORTED_CHARSETS "SupportedCharsets"
+#define MM_IDENTITY_CACHE_KEY_IMSI               "Imsi"
+
+/* Setup the cache stored in the given path; or disable it if no path given */
+void      mm_identity_cache_setup         (const gchar *path);
+void      mm_identity_cache_shutdown      (void);
+gboolean  mm_identity_cache_is_enabled    (void);
+
+gboolean  mm_identity_cache_has_device    (const gchar *device);
+void      mm_identity_cache_remove_device (const gchar *device);
+
+gboolean  mm_identity_cache_has_key       (const gchar  *device,
+                                           const gchar  *key);
+
+gchar    *mm_identity_cache_get_string    (const gchar  *device,
+                                           const gchar  *key);
+gboolean  mm_identity_cache_get_uint      (const gchar  *device,
+                                           const gchar  *key,
+                                           guint        *value);
+void      mm_identity_cache_set_string    (const gchar  *device,
+                                           const gchar  *key,
+                                           const gchar  *value);
+void      mm_identity_cache_set_uint      (const gchar  *device,
+                                           const gchar  *key,
+                                           guint         value);
+void      mm_identity_cache_remove_key    (const gchar  *device,
+                                           const gchar  *key);
+
+/* Remove the keys starting with the given prefix in all devices */
+void      mm_identity_cache_remove_keys_with_prefix (const gchar *prefix);
+
+/* Write the cache to disk, if there are changes */
+void      mm_identity_cache_flush         (void);
+
+#endif /* MM_IDENTITY_CACHE_H */
@@ -33,6 +33,52 @@
 static GQuark support_checked_quark;
 static GQuark supported_quark;
 
+/*****************************************************************************/
+/* Private data context */
+
+#define PRIVATE_TAG "iface-modem-3gpp-profile-manager-private-tag"
+static GQuark private_quark;
+
+typedef struct _ListOperation ListOperation;
+
+typedef struct {
+    /* Cached profile list, and a counter increased every time it's
+     * invalidated, so that results of list operations started before the
+     * invalidation are not cached */
+    GList         *profiles;
+    gboolean       profiles_valid;
+    guint          profiles_generation;
+    /* Ongoing list operation, which other requests may wait for */
+    ListOperation *list_operation;
+    /* Statistics */
+    guint          n_hits;
+    guint          n_misses;
+} Private;
+
+static void
+private_free (Private *priv)
+{
+    mm_3gpp_profile_list_free (priv->profiles);
+    g_slice_free (Private, priv);
+}
+
+static Private *
+get_private (MMIfaceModem3gppProfileManager *self)
+{
+    Private *priv;
+
+    if (G_UNLIKELY (!private_quark))
+        private_quark = g_quark_from_static_string (PRIVATE_TAG);
+
+    priv = g_object_get_qdata (G_OBJECT (self), private_quark);
+    if (!priv) {
+        priv = g_slice_new0 (Private);
+        g_object_set_qdata_full (G_OBJECT (self), private_quark, priv, (GDestroyNotify)private_free);
+    }
+
+    return priv;
+}
+
 /*****************************************************************************/
 
 void
@@ -49,6 +95,8 @@ mm_iface_modem_3gpp_profile_manager_updated (MMIfaceModem3gppProfileManager *sel
 {
     g_autoptr(MmGdbusModem3gppProfileManagerSkeleton) skeleton = NULL;
 
+    mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (self);
+
     g_object_get (self,
                   MM_IFACE_MODEM_3GPP_PROFILE_MANAGER_DBUS_SKELETON, &skeleton,
                   NULL);
@@ -195,6 +243,9 @@ profile_manager_store_profile_ready (MMIfaceModem3gppProfileManager *self,
     g_assert (ctx->profile_id == profile_id);
     mm_obj_dbg (self, "stored profile with id '%d'", ctx->profile_id);
 
+    /* The settings actually stored are read back right away */
+    mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (self);
+
     ctx->step++;
     set_profile_step (task);
 }
@@ -742,6 +793,67 @@ list_profiles_context_free (ListProfilesContext *ctx)
     g_slice_free (ListProfilesContext, ctx);
 }
 
+/* A single list operation run in the modem, with all the requests waiting
+ * for it */
+struct _ListOperation {
+    guint  generation;
+    GList *tasks;
+};
+
+static GList *
+profile_list_dup (GList *profiles)
+{
+    GList *copy = NULL;
+    GList *l;
+
+    /* Deep copy, as callers are free to modify the profiles they get */
+    for (l = profiles; l; l = g_list_next (l)) {
+        g_autoptr(GVariant) dictionary = NULL;
+        MM3gppProfile      *profile;
+
+        dictionary = mm_3gpp_profile_get_dictionary (MM_3GPP_PROFILE (l->data));
+        profile = mm_3gpp_profile_new_from_dictionary (dictionary, NULL);
+        if (profile)
+            copy = g_list_prepend (copy, profile);
+    }
+    return g_list_reverse (copy);
+}
+
+static void
+list_profiles_task_complete (GTask  *task,
+                             GList  *profiles,
+                             GError *error)
+{
+    ListProfilesContext *ctx;
+
+    if (error) {
+        g_task_return_error (task, g_error_copy (error));
+        g_object_unref (task);
+        return;
+    }
+
+    ctx = g_slice_new0 (ListProfilesContext);
+    ctx->profiles = profile_list_dup (profiles);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) list_profiles_context_free);
+    g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+void
+mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (MMIfaceModem3gppProfileManager *self)
+{
+    Private *priv;
+
+    priv = get_private (self);
+    priv->profiles_generation++;
+    if (!priv->profiles_valid)
+        return;
+
+    mm_obj_dbg (self, "profile list cache invalidated");
+    g_clear_pointer (&priv->profiles, mm_3gpp_profile_list_free);
+    priv->profiles_valid = FALSE;
+}
+
 gboolean
 mm_iface_modem_3gpp_profile_manager_list_profiles_finish (MMIfaceModem3gppProfileManager  *self,
                                                           GAsyncResult                    *res,
@@ -762,19 +874,31 @@ mm_iface_modem_3gpp_profile_manager_list_profiles_finish (MMIfaceModem3gppProfil
 static void
 internal_list_profiles_ready (MMIfaceModem3gppProfileManager *self,
                               GAsyncResult                   *res,
-                              GTask                          *task)
+                              ListOperation                  *operation)
 {
-    ListProfilesContext *ctx;
-    GError              *error = NULL;
+    Private *priv;
+    GList   *profiles = NULL;
+    GError  *error = NULL;
+    GList   *l;
+
+    priv = get_private (self);
+    if (priv->list_operation == operation)
+        priv->list_operation = NULL;
+
+    if (MM_IFACE_MODEM_3GPP_PROFILE_MANAGER_GET_INTERFACE (self)->list_profiles_finish (self, res, &profiles, &error) &&
+        operation->generation == priv->profiles_generation) {
+        g_clear_pointer (&priv->profiles, mm_3gpp_profile_list_free);
+        priv->profiles = profile_list_dup (profiles);
+        priv->profiles_valid = TRUE;
+    }
 
-    ctx = g_slice_new0 (ListProfilesContext);
-    g_task_set_task_data (task, ctx, (GDestroyNotify) list_profiles_context_free);
+    for (l = operation->tasks; l; l = g_list_next (l))
+        list_profiles_task_complete (G_TASK (l->data), profiles, error);
 
-    if (!MM_IFACE_MODEM_3GPP_PROFILE_MANAGER_GET_INTERFACE (self)->list_profiles_finish (self, res, &ctx->profiles, &error))
-        g_task_return_error (task, error);
-    else
-        g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    g_list_free (operation->tasks);
+    g_slice_free (ListOperation, operation);
+    mm_3gpp_profile_list_free (profiles);
+    g_clear_error (&error);
 }
 
 void
@@ -782,7 +906,9 @@ mm_iface_modem_3gpp_profile_manager_list_profiles (MMIfaceModem3gppProfileManage
                                                    GAsyncReadyCallback             callback,
                                                    gpointer                        user_data)
 {
-    GTask *task;
+    GTask         *task;
+    Private       *priv;
+    ListOperation *operation;
 
     task = g_task_new (self, NULL, callback, user_data);
 
@@ -797,10 +923,34 @@ mm_iface_modem_3gpp_profile_manager_list_profiles (MMIfaceModem3gppProfileManage
         return;
     }
 
+    priv = get_private (self);
+
+    if (priv->profiles_valid) {
+        priv->n_hits++;
+        mm_obj_dbg (self, "profile list cache hit (%u hits, %u misses)", priv->n_hits, priv->n_misses);
+        list_profiles_task_complete (task, priv->profiles, NULL);
+        return;
+    }
+
+    priv->n_misses++;
+    mm_obj_dbg (self, "profile list cache miss (%u hits, %u misses)", priv->n_hits, priv->n_misses);
+
+    /* If there is an ongoing list operation started after the last
+     * invalidation, just wait for its result */
+    if (priv->list_operation && priv->list_operation->generation == priv->profiles_generation) {
+        priv->list_operation->tasks = g_list_append (priv->list_operation->tasks, task);
+        return;
+    }
+
+    operation = g_slice_new0 (ListOperation);
+    operation->generation = priv->profiles_generation;
+    operation->tasks = g_list_append (NULL, task);
+    priv->list_operation = operation;
+
     MM_IFACE_MODEM_3GPP_PROFILE_MANAGER_GET_INTERFACE (self)->list_profiles (
         MM_IFACE_MODEM_3GPP_PROFILE_MANAGER (self),
         (GAsyncReadyCallback)internal_list_profiles_ready,
-        task);
+        operation);
 }
 
 /*****************************************************************************/
@@ -872,6 +1022,10 @@ handle_list_auth_ready (MMBaseModem       *self,
         return;
     }
 
+    /* Explicit requests always refresh the cached list, in case the
+     * profiles were changed without us being notified */
+    mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (MM_IFACE_MODEM_3GPP_PROFILE_MANAGER (self));
+
     /* Don't call the class callback directly, use the common helper method
      * that is also used by other internal operations. */
     mm_iface_modem_3gpp_profile_manager_list_profiles (
@@ -1032,6 +1186,9 @@ delete_profile_ready (MMIfaceModem3gppProfileManager *self,
 {
     GError *error = NULL;
 
+    /* Even on error, the profile may have been partially removed */
+    mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (self);
+
     if (!MM_IFACE_MODEM_3GPP_PROFILE_MANAGER_GET_INTERFACE (self)->delete_profile_finish (self, res, &error))
         g_dbus_method_invocation_take_error (ctx->invocation, error);
     else
@@ -1237,6 +1394,8 @@ interface_disabling_step (GTask *task)
         /* fall through */
 
     case DISABLING_STEP_LAST:
+        /* Profiles may be changed by others while we're disabled */
+        mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (self);
         /* We are done without errors! */
         g_task_return_boolean (task, TRUE);
         g_object_unref (task);
@@ -217,9 +217,16 @@ void mm_iface_modem_3gpp_profile_manager_shutdown (MMIfaceModem3gppProfileManage
 void mm_iface_modem_3gpp_profile_manager_bind_simple_status (MMIfaceModem3gppProfileManager *self,
                                                              MMSimpleStatus                 *status);
 
-/* Helper to emit the Updated signal by implementations */
+/* Helper to emit the Updated signal by implementations; also invalidates
+ * the cached profile list */
 void mm_iface_modem_3gpp_profile_manager_updated (MMIfaceModem3gppProfileManager *self);
 
+/* The profile list is cached, and reused by all internal operations until
+ * the profiles are known to have changed. Implementations should call this
+ * method (or updated()) whenever they modify profiles outside of the
+ * profile manager methods, or get notified about profile changes. */
+void mm_iface_modem_3gpp_profile_manager_reset_profiles_cache (MMIfaceModem3gppProfileManager *self);
+
 /* Internal list profile management */
 void           mm_iface_modem_3gpp_profile_manager_get_profile          (MMIfaceModem3gppProfileManager  *self,
                                                                          gint                             profile_id,
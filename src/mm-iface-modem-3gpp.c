@@ -27,6 +27,7 @@
 #include "mm-modem-helpers.h"
 #include "mm-error-helpers.h"
 #include "mm-log.h"
+#include "mm-timer-wheel.h"
 
 #define SUBSYSTEM_3GPP "3gpp"
 
@@ -63,7 +64,7 @@ typedef struct {
     GCancellable                 *pending_registration_cancellable;
     gboolean                      reloading_registration_info;
     /* Registration checks */
-    guint    check_timeout_source;
+    guint    check_timeout_id;
     gboolean check_running;
 } Private;
 
@@ -75,8 +76,8 @@ private_free (Private *priv)
         g_cancellable_cancel (priv->pending_registration_cancellable);
         g_object_unref (priv->pending_registration_cancellable);
     }
-    if (priv->check_timeout_source)
-        g_source_remove (priv->check_timeout_source);
+    if (priv->check_timeout_id)
+        mm_timer_wheel_remove (mm_timer_wheel_get (), priv->check_timeout_id);
     g_slice_free (Private, priv);
 }
 
@@ -1850,11 +1851,11 @@ periodic_registration_check_disable (MMIfaceModem3gpp *self)
     priv = get_private (self);
 
     /* Do nothing if already disabled */
-    if (!priv->check_timeout_source)
+    if (!priv->check_timeout_id)
         return;
 
-    g_source_remove (priv->check_timeout_source);
-    priv->check_timeout_source = 0;
+    mm_timer_wheel_remove (mm_timer_wheel_get (), priv->check_timeout_id);
+    priv->check_timeout_id = 0;
 
     mm_obj_dbg (self, "periodic 3GPP registration checks disabled");
 }
@@ -1867,14 +1868,17 @@ periodic_registration_check_enable (MMIfaceModem3gpp *self)
     priv = get_private (self);
 
     /* Do nothing if already enabled */
-    if (priv->check_timeout_source)
+    if (priv->check_timeout_id)
         return;
 
     /* Create context and keep it as object data */
     mm_obj_dbg (self, "periodic 3GPP registration checks enabled");
-    priv->check_timeout_source = g_timeout_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
-                                                        (GSourceFunc)periodic_registration_check,
-                                                        self);
+    priv->check_timeout_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                         self,
+                                                         "registration-check",
+                                                         REGISTRATION_CHECK_TIMEOUT_SEC,
+                                                         (GSourceFunc)periodic_registration_check,
+                                                         self);
 }
 
 /*****************************************************************************/
@@ -2514,15 +2518,52 @@ typedef enum {
 } SyncingStep;
 
 struct _SyncingContext {
-    SyncingStep step;
+    SyncingStep                   step;
+    /* Registration before the resume, to decide what needs reloading */
+    MMModem3gppRegistrationState  previous_state;
+    gchar                        *previous_operator_code;
+    gboolean                      registration_changed;
 };
 
+static void
+syncing_context_free (SyncingContext *ctx)
+{
+    g_free (ctx->previous_operator_code);
+    g_free (ctx);
+}
+
+static gboolean
+syncing_registration_changed (MMIfaceModem3gpp *self,
+                              SyncingContext   *ctx)
+{
+    g_autoptr(MmGdbusModem3gppSkeleton) skeleton = NULL;
+
+    if (!REG_STATE_IS_REGISTERED (ctx->previous_state) ||
+        get_consolidated_reg_state (self) != ctx->previous_state)
+        return TRUE;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_3GPP_DBUS_SKELETON, &skeleton,
+                  NULL);
+    return (!skeleton ||
+            g_strcmp0 (mm_gdbus_modem3gpp_get_operator_code (MM_GDBUS_MODEM3GPP (skeleton)), ctx->previous_operator_code) != 0);
+}
+
 gboolean
 mm_iface_modem_3gpp_sync_finish (MMIfaceModem3gpp  *self,
                                  GAsyncResult      *res,
+                                 gboolean          *registration_changed,
                                  GError           **error)
 {
-    return g_task_propagate_boolean (G_TASK (res), error);
+    SyncingContext *ctx;
+
+    if (!g_task_propagate_boolean (G_TASK (res), error))
+        return FALSE;
+
+    ctx = g_task_get_task_data (G_TASK (res));
+    if (registration_changed)
+        *registration_changed = ctx->registration_changed;
+    return TRUE;
 }
 
 static void
@@ -2624,7 +2665,16 @@ interface_syncing_step (GTask *task)
          * Refresh EPS bearer and wait until complete.
          * We want to make sure that the modem is fully enabled again
          * when we refresh the mobile data connection bearers.
+         * If the modem stayed registered in the same network during the
+         * suspend, the initial EPS bearer cannot have changed.
          */
+        ctx->registration_changed = syncing_registration_changed (self, ctx);
+        if (!ctx->registration_changed) {
+            mm_obj_dbg (self, "registration unchanged after resume, initial EPS bearer kept");
+            ctx->step++;
+            interface_syncing_step (task);
+            return;
+        }
         sync_eps_bearer (
             self,
             (GAsyncReadyCallback)sync_eps_bearer_ready,
@@ -2649,16 +2699,24 @@ mm_iface_modem_3gpp_sync (MMIfaceModem3gpp    *self,
                           GAsyncReadyCallback  callback,
                           gpointer             user_data)
 {
-    SyncingContext *ctx;
-    GTask          *task;
+    SyncingContext                      *ctx;
+    GTask                               *task;
+    g_autoptr(MmGdbusModem3gppSkeleton)  skeleton = NULL;
 
     /* Create SyncingContext */
     ctx = g_new0 (SyncingContext, 1);
     ctx->step = SYNCING_STEP_FIRST;
+    ctx->previous_state = get_consolidated_reg_state (self);
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_3GPP_DBUS_SKELETON, &skeleton,
+                  NULL);
+    if (skeleton)
+        ctx->previous_operator_code = g_strdup (mm_gdbus_modem3gpp_get_operator_code (MM_GDBUS_MODEM3GPP (skeleton)));
 
     /* Create sync steps task and execute it */
     task = g_task_new (self, NULL, callback, user_data);
-    g_task_set_task_data (task, ctx, (GDestroyNotify)g_free);
+    g_task_set_task_data (task, ctx, (GDestroyNotify)syncing_context_free);
     interface_syncing_step (task);
 }
 
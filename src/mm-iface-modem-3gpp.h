@@ -284,6 +284,7 @@ void     mm_iface_modem_3gpp_sync           (MMIfaceModem3gpp *self,
                                              gpointer user_data);
 gboolean mm_iface_modem_3gpp_sync_finish    (MMIfaceModem3gpp *self,
                                              GAsyncResult *res,
+                                             gboolean *registration_changed,
                                              GError **error);
 
 #endif
@@ -20,6 +20,7 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-signal.h"
 #include "mm-log-object.h"
+#include "mm-timer-wheel.h"
 
 #define SUPPORT_CHECKED_TAG "signal-support-checked-tag"
 #define SUPPORTED_TAG       "signal-supported-tag"
@@ -41,14 +42,14 @@ mm_iface_modem_signal_bind_simple_status (MMIfaceModemSignal *self,
 
 typedef struct {
     guint rate;
-    guint timeout_source;
+    guint timeout_id;
 } RefreshContext;
 
 static void
 refresh_context_free (RefreshContext *ctx)
 {
-    if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+    if (ctx->timeout_id)
+        mm_timer_wheel_remove (mm_timer_wheel_get (), ctx->timeout_id);
     g_slice_free (RefreshContext, ctx);
 }
 
@@ -227,9 +228,14 @@ setup_refresh_context (MMIfaceModemSignal *self,
     /* Update refresh context */
     mm_obj_dbg (self, "extended signal information reporting enabled (rate: %u seconds)", new_rate);
     ctx->rate = new_rate;
-    if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
-    ctx->timeout_source = g_timeout_add_seconds (ctx->rate, (GSourceFunc) refresh_context_cb, self);
+    if (ctx->timeout_id)
+        mm_timer_wheel_remove (mm_timer_wheel_get (), ctx->timeout_id);
+    ctx->timeout_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                  self,
+                                                  "extended-signal-refresh",
+                                                  ctx->rate,
+                                                  (GSourceFunc) refresh_context_cb,
+                                                  self);
 
     /* Also launch right away */
     refresh_context_cb (self);
@@ -22,6 +22,7 @@
 #include "mm-iface-modem-voice.h"
 #include "mm-call-list.h"
 #include "mm-log-object.h"
+#include "mm-timer-wheel.h"
 
 #define CALL_LIST_POLLING_CONTEXT_TAG "voice-call-list-polling-context-tag"
 #define IN_CALL_EVENT_CONTEXT_TAG     "voice-in-call-event-context-tag"
@@ -2371,7 +2372,7 @@ static void
 call_list_polling_context_free (CallListPollingContext *ctx)
 {
     if (ctx->polling_id)
-        g_source_remove (ctx->polling_id);
+        mm_timer_wheel_remove (mm_timer_wheel_get (), ctx->polling_id);
     g_slice_free (CallListPollingContext, ctx);
 }
 
@@ -2426,9 +2427,12 @@ load_call_list_ready (MMIfaceModemVoice *self,
      * we reported calls (e.g. a new incoming call may have been detected that
      * also triggers the poll setup) */
     if (!ctx->polling_id)
-        ctx->polling_id = g_timeout_add_seconds (CALL_LIST_POLLING_TIMEOUT_SECS,
-                                                 (GSourceFunc) call_list_poll,
-                                                 self);
+        ctx->polling_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                      self,
+                                                      "call-list-polling",
+                                                      CALL_LIST_POLLING_TIMEOUT_SECS,
+                                                      (GSourceFunc) call_list_poll,
+                                                      self);
 }
 
 static void
@@ -2500,9 +2504,12 @@ setup_call_list_polling (MMCallList        *call_list,
     ctx = get_call_list_polling_context (self);
 
     if (!ctx->polling_id && !ctx->polling_ongoing)
-        ctx->polling_id = g_timeout_add_seconds (CALL_LIST_POLLING_TIMEOUT_SECS,
-                                                 (GSourceFunc) call_list_poll,
-                                                 self);
+        ctx->polling_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                      self,
+                                                      "call-list-polling",
+                                                      CALL_LIST_POLLING_TIMEOUT_SECS,
+                                                      (GSourceFunc) call_list_poll,
+                                                      self);
 }
 
 /*****************************************************************************/
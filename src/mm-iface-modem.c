@@ -28,7 +28,9 @@
 #include "mm-private-boxed-types.h"
 #include "mm-log-object.h"
 #include "mm-context.h"
+#include "mm-identity-cache.h"
 #include "mm-fcc-unlock-dispatcher.h"
+#include "mm-timer-wheel.h"
 #if defined WITH_QMI
 # include "mm-broadband-modem-qmi.h"
 #endif
@@ -41,6 +43,7 @@
 #define SIGNAL_CHECK_INITIAL_RETRIES      5
 #define SIGNAL_CHECK_INITIAL_TIMEOUT_SEC  3
 #define SIGNAL_CHECK_TIMEOUT_SEC          30
+#define SIGNAL_CHECK_JITTER_SEC           5
 
 #define STATE_UPDATE_CONTEXT_TAG          "state-update-context-tag"
 #define SIGNAL_QUALITY_UPDATE_CONTEXT_TAG "signal-quality-update-context-tag"
@@ -1234,10 +1237,13 @@ handle_set_primary_sim_slot (MmGdbusModem          *skeleton,
 
 /*****************************************************************************/
 
-void
-mm_iface_modem_update_access_technologies (MMIfaceModem *self,
-                                           MMModemAccessTechnology new_access_tech,
-                                           guint32 mask)
+static void signal_check_signal_quality_indication      (MMIfaceModem *self);
+static void signal_check_access_technologies_indication (MMIfaceModem *self);
+
+static void
+update_access_technologies (MMIfaceModem *self,
+                            MMModemAccessTechnology new_access_tech,
+                            guint32 mask)
 {
     MmGdbusModem *skeleton = NULL;
     MMModemAccessTechnology old_access_tech;
@@ -1277,6 +1283,15 @@ mm_iface_modem_update_access_technologies (MMIfaceModem *self,
     g_object_unref (skeleton);
 }
 
+void
+mm_iface_modem_update_access_technologies (MMIfaceModem *self,
+                                           MMModemAccessTechnology new_access_tech,
+                                           guint32 mask)
+{
+    signal_check_access_technologies_indication (self);
+    update_access_technologies (self, new_access_tech, mask);
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -1394,6 +1409,7 @@ void
 mm_iface_modem_update_signal_quality (MMIfaceModem *self,
                                       guint signal_quality)
 {
+    signal_check_signal_quality_indication (self);
     update_signal_quality (self, signal_quality, TRUE);
 }
 
@@ -1410,7 +1426,7 @@ typedef enum {
 
 typedef struct {
     gboolean enabled;
-    guint    timeout_source;
+    guint    timeout_id;
 
     /* We first attempt an initial loading, and once it's done we
      * setup polling */
@@ -1429,6 +1445,11 @@ typedef struct {
     gboolean access_technology_polling_supported;
     gboolean access_technology_polling_disabled;
 
+    /* Monotonic time (in seconds) of the last unsolicited updates; polling
+     * an item is skipped while the modem keeps reporting it on its own */
+    gint64 last_signal_quality_indication;
+    gint64 last_access_technologies_indication;
+
     /* Steps triggered when polling active */
     SignalCheckStep running_step;
 } SignalCheckContext;
@@ -1436,11 +1457,50 @@ typedef struct {
 static void
 signal_check_context_free (SignalCheckContext *ctx)
 {
-    if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+    if (ctx->timeout_id)
+        mm_timer_wheel_remove (mm_timer_wheel_get (), ctx->timeout_id);
     g_slice_free (SignalCheckContext, ctx);
 }
 
+static SignalCheckContext *
+peek_signal_check_context (MMIfaceModem *self)
+{
+    if (G_UNLIKELY (!signal_check_context_quark))
+        return NULL;
+    return g_object_get_qdata (G_OBJECT (self), signal_check_context_quark);
+}
+
+static void
+signal_check_signal_quality_indication (MMIfaceModem *self)
+{
+    SignalCheckContext *ctx;
+
+    ctx = peek_signal_check_context (self);
+    if (ctx && ctx->enabled)
+        ctx->last_signal_quality_indication = g_get_monotonic_time () / G_USEC_PER_SEC;
+}
+
+static void
+signal_check_access_technologies_indication (MMIfaceModem *self)
+{
+    SignalCheckContext *ctx;
+
+    ctx = peek_signal_check_context (self);
+    if (ctx && ctx->enabled)
+        ctx->last_access_technologies_indication = g_get_monotonic_time () / G_USEC_PER_SEC;
+}
+
+/* Seconds until the last indication becomes too old to replace polling,
+ * 0 if already too old */
+static guint
+signal_check_indication_remaining (gint64 last_indication,
+                                   gint64 now)
+{
+    if (!last_indication || (now - last_indication) >= SIGNAL_CHECK_TIMEOUT_SEC)
+        return 0;
+    return (guint) (SIGNAL_CHECK_TIMEOUT_SEC - (now - last_indication));
+}
+
 static SignalCheckContext *
 get_signal_check_context (MMIfaceModem *self)
 {
@@ -1514,7 +1574,7 @@ access_technologies_check_ready (MMIfaceModem *self,
     }
     /* We may have been disabled while this command was running. */
     else if (ctx->enabled)
-        mm_iface_modem_update_access_technologies (self, ctx->access_technologies, ctx->access_technologies_mask);
+        update_access_technologies (self, ctx->access_technologies, ctx->access_technologies_mask);
 
     /* Go on */
     ctx->running_step++;
@@ -1551,12 +1611,44 @@ signal_quality_check_ready (MMIfaceModem *self,
     periodic_signal_check_step (self);
 }
 
+static guint
+periodic_signal_check_get_timeout (SignalCheckContext *ctx,
+                                   gint64              now)
+{
+    guint timeout = SIGNAL_CHECK_TIMEOUT_SEC;
+
+    if (!ctx->initial_check_done)
+        return SIGNAL_CHECK_INITIAL_TIMEOUT_SEC;
+
+    /* Items kept up to date by indications are checked again once their
+     * last indication gets too old, the remaining ones are polled at the
+     * default rate */
+    if (ctx->signal_quality_polling_supported && !ctx->signal_quality_polling_disabled) {
+        guint remaining;
+
+        remaining = signal_check_indication_remaining (ctx->last_signal_quality_indication, now);
+        timeout = MIN (timeout, remaining ? remaining : SIGNAL_CHECK_TIMEOUT_SEC);
+    }
+    if (ctx->access_technology_polling_supported && !ctx->access_technology_polling_disabled) {
+        guint remaining;
+
+        remaining = signal_check_indication_remaining (ctx->last_access_technologies_indication, now);
+        timeout = MIN (timeout, remaining ? remaining : SIGNAL_CHECK_TIMEOUT_SEC);
+    }
+
+    /* Random jitter so that multiple modems don't all poll at the same time */
+    return timeout + g_random_int_range (0, SIGNAL_CHECK_JITTER_SEC + 1);
+}
+
 static void
 periodic_signal_check_step (MMIfaceModem *self)
 {
     SignalCheckContext *ctx;
+    gint64              now;
+    guint               timeout;
 
     ctx = get_signal_check_context (self);
+    now = g_get_monotonic_time () / G_USEC_PER_SEC;
 
     switch (ctx->running_step) {
     case SIGNAL_CHECK_STEP_NONE:
@@ -1568,7 +1660,9 @@ periodic_signal_check_step (MMIfaceModem *self)
 
     case SIGNAL_CHECK_STEP_SIGNAL_QUALITY:
         if (ctx->enabled && ctx->signal_quality_polling_supported &&
-            (!ctx->initial_check_done || !ctx->signal_quality_polling_disabled)) {
+            (!ctx->initial_check_done ||
+             (!ctx->signal_quality_polling_disabled &&
+              !signal_check_indication_remaining (ctx->last_signal_quality_indication, now)))) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_signal_quality (
                 self, (GAsyncReadyCallback)signal_quality_check_ready, NULL);
             return;
@@ -1578,7 +1672,9 @@ periodic_signal_check_step (MMIfaceModem *self)
 
     case SIGNAL_CHECK_STEP_ACCESS_TECHNOLOGIES:
         if (ctx->enabled && ctx->access_technology_polling_supported &&
-            (!ctx->initial_check_done || !ctx->access_technology_polling_disabled)) {
+            (!ctx->initial_check_done ||
+             (!ctx->access_technology_polling_disabled &&
+              !signal_check_indication_remaining (ctx->last_access_technologies_indication, now)))) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_access_technologies (
                 self, (GAsyncReadyCallback)access_technologies_check_ready, NULL);
             return;
@@ -1629,11 +1725,15 @@ periodic_signal_check_step (MMIfaceModem *self)
             return;
         }
 
-        mm_obj_dbg (self, "periodic signal quality and access technology checks scheduled");
-        g_assert (!ctx->timeout_source);
-        ctx->timeout_source = g_timeout_add_seconds (ctx->initial_check_done ? SIGNAL_CHECK_TIMEOUT_SEC : SIGNAL_CHECK_INITIAL_TIMEOUT_SEC,
-                                                     (GSourceFunc) periodic_signal_check_cb,
-                                                     self);
+        timeout = periodic_signal_check_get_timeout (ctx, now);
+        mm_obj_dbg (self, "periodic signal quality and access technology checks scheduled in %us", timeout);
+        g_assert (!ctx->timeout_id);
+        ctx->timeout_id = mm_timer_wheel_add_seconds (mm_timer_wheel_get (),
+                                                      self,
+                                                      "signal-check",
+                                                      timeout,
+                                                      (GSourceFunc) periodic_signal_check_cb,
+                                                      self);
         return;
 
     default:
@@ -1649,16 +1749,16 @@ periodic_signal_check_cb (MMIfaceModem *self)
     ctx = get_signal_check_context (self);
     g_assert (ctx->enabled);
 
+    /* Clear the timer id before running the sequence, as the next check may
+     * get scheduled right away if all steps are skipped */
+    ctx->timeout_id = 0;
+
     /* Start the sequence */
     ctx->running_step             = SIGNAL_CHECK_STEP_FIRST;
     ctx->signal_quality           = 0;
     ctx->access_technologies      = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
     ctx->access_technologies_mask = MM_MODEM_ACCESS_TECHNOLOGY_ANY;
     periodic_signal_check_step (self);
-
-    /* Remove the timeout and clear the source id */
-    if (ctx->timeout_source)
-        ctx->timeout_source = 0;
     return G_SOURCE_REMOVE;
 }
 
@@ -1685,9 +1785,9 @@ mm_iface_modem_refresh_signal (MMIfaceModem *self)
 
     /* Remove the scheduled timeout as we're going to refresh
      * right away */
-    if (ctx->timeout_source) {
-        g_source_remove (ctx->timeout_source);
-        ctx->timeout_source = 0;
+    if (ctx->timeout_id) {
+        mm_timer_wheel_remove (mm_timer_wheel_get (), ctx->timeout_id);
+        ctx->timeout_id = 0;
     }
 
     /* Reset refresh rate and initial retries when we're asked to refresh signal
@@ -1712,15 +1812,15 @@ periodic_signal_check_disable (MMIfaceModem *self,
     /* Clear access technology and signal quality */
     if (clear) {
         update_signal_quality (self, 0, FALSE);
-        mm_iface_modem_update_access_technologies (self,
-                                                   MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN,
-                                                   MM_MODEM_ACCESS_TECHNOLOGY_ANY);
+        update_access_technologies (self,
+                                    MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN,
+                                    MM_MODEM_ACCESS_TECHNOLOGY_ANY);
     }
 
     /* Remove scheduled timeout */
-    if (ctx->timeout_source) {
-        g_source_remove (ctx->timeout_source);
-        ctx->timeout_source = 0;
+    if (ctx->timeout_id) {
+        mm_timer_wheel_remove (mm_timer_wheel_get (), ctx->timeout_id);
+        ctx->timeout_id = 0;
     }
 
     ctx->enabled = FALSE;
@@ -4531,6 +4631,7 @@ static void interface_initialization_step (GTask *task);
 typedef enum {
     INITIALIZATION_STEP_FIRST,
     INITIALIZATION_STEP_CURRENT_CAPABILITIES,
+    INITIALIZATION_STEP_IDENTITY_CACHE,
     INITIALIZATION_STEP_SUPPORTED_CAPABILITIES,
     INITIALIZATION_STEP_SUPPORTED_CHARSETS,
     INITIALIZATION_STEP_CHARSET,
@@ -4557,12 +4658,80 @@ typedef enum {
     INITIALIZATION_STEP_LAST
 } InitializationStep;
 
+static const gchar *initialization_step_names[] = {
+    [INITIALIZATION_STEP_FIRST]                  = "first",
+    [INITIALIZATION_STEP_CURRENT_CAPABILITIES]   = "current capabilities",
+    [INITIALIZATION_STEP_IDENTITY_CACHE]         = "identity cache",
+    [INITIALIZATION_STEP_SUPPORTED_CAPABILITIES] = "supported capabilities",
+    [INITIALIZATION_STEP_SUPPORTED_CHARSETS]     = "supported charsets",
+    [INITIALIZATION_STEP_CHARSET]                = "charset",
+    [INITIALIZATION_STEP_BEARERS]                = "bearers",
+    [INITIALIZATION_STEP_MANUFACTURER]           = "manufacturer",
+    [INITIALIZATION_STEP_MODEL]                  = "model",
+    [INITIALIZATION_STEP_REVISION]               = "revision",
+    [INITIALIZATION_STEP_CARRIER_CONFIG]         = "carrier config",
+    [INITIALIZATION_STEP_HARDWARE_REVISION]      = "hardware revision",
+    [INITIALIZATION_STEP_EQUIPMENT_ID]           = "equipment id",
+    [INITIALIZATION_STEP_DEVICE_ID]              = "device id",
+    [INITIALIZATION_STEP_SUPPORTED_MODES]        = "supported modes",
+    [INITIALIZATION_STEP_SUPPORTED_BANDS]        = "supported bands",
+    [INITIALIZATION_STEP_SUPPORTED_IP_FAMILIES]  = "supported ip families",
+    [INITIALIZATION_STEP_POWER_STATE]            = "power state",
+    [INITIALIZATION_STEP_SIM_HOT_SWAP]           = "sim hot swap",
+    [INITIALIZATION_STEP_SIM_SLOTS]              = "sim slots",
+    [INITIALIZATION_STEP_UNLOCK_REQUIRED]        = "unlock required",
+    [INITIALIZATION_STEP_SIM]                    = "sim",
+    [INITIALIZATION_STEP_SETUP_CARRIER_CONFIG]   = "setup carrier config",
+    [INITIALIZATION_STEP_OWN_NUMBERS]            = "own numbers",
+    [INITIALIZATION_STEP_CURRENT_MODES]          = "current modes",
+    [INITIALIZATION_STEP_CURRENT_BANDS]          = "current bands",
+    [INITIALIZATION_STEP_LAST]                   = "last",
+};
+G_STATIC_ASSERT (G_N_ELEMENTS (initialization_step_names) == INITIALIZATION_STEP_LAST + 1);
+
+/* Steps that don't depend on each other may run at the same time, up to a
+ * maximum number of steps per modem. Each step in the parallel group must
+ * only depend on steps listed before it. */
+#define INITIALIZATION_PARALLEL_STEPS_MAX 3
+#define INITIALIZATION_STEP_BIT(step) (1u << (step))
+
+typedef struct {
+    InitializationStep step;
+    guint32            depends_on;
+} InitializationParallelStep;
+
+static const InitializationParallelStep initialization_parallel_steps[] = {
+    { INITIALIZATION_STEP_MANUFACTURER,      0 },
+    { INITIALIZATION_STEP_MODEL,             0 },
+    { INITIALIZATION_STEP_REVISION,          0 },
+    { INITIALIZATION_STEP_CARRIER_CONFIG,    0 },
+    { INITIALIZATION_STEP_HARDWARE_REVISION, 0 },
+    { INITIALIZATION_STEP_EQUIPMENT_ID,      0 },
+    /* The generic device identifier is built with all the previous info */
+    { INITIALIZATION_STEP_DEVICE_ID,         (INITIALIZATION_STEP_BIT (INITIALIZATION_STEP_MANUFACTURER) |
+                                              INITIALIZATION_STEP_BIT (INITIALIZATION_STEP_MODEL)        |
+                                              INITIALIZATION_STEP_BIT (INITIALIZATION_STEP_REVISION)     |
+                                              INITIALIZATION_STEP_BIT (INITIALIZATION_STEP_EQUIPMENT_ID)) },
+};
+G_STATIC_ASSERT (INITIALIZATION_STEP_LAST < 32);
+
 struct _InitializationContext {
     InitializationStep step;
     MmGdbusModem *skeleton;
     MMModemCharset supported_charsets;
     const MMModemCharset *current_charset;
     GError *fatal_error;
+    gboolean identity_cache_valid;
+    /* Step timing */
+    InitializationStep running_step;
+    gint64 running_step_start_time;
+    /* Parallel group */
+    guint32 parallel_launched;
+    guint32 parallel_done;
+    guint n_parallel_running;
+    gboolean parallel_scheduling;
+    gboolean parallel_reschedule;
+    gint64 parallel_start_time[INITIALIZATION_STEP_LAST];
 };
 
 static void
@@ -4573,8 +4742,208 @@ initialization_context_free (InitializationContext *ctx)
     g_free (ctx);
 }
 
+static gboolean
+initialization_step_is_parallel (InitializationStep step)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (initialization_parallel_steps); i++) {
+        if (initialization_parallel_steps[i].step == step)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean initialization_parallel_step_launch (GTask              *task,
+                                                     InitializationStep  step);
+
+static void
+interface_initialization_parallel_steps (GTask *task)
+{
+    MMIfaceModem          *self;
+    InitializationContext *ctx;
+    guint32                all = 0;
+    guint                  i;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* Steps completed while launching others are processed by the outer loop */
+    if (ctx->parallel_scheduling) {
+        ctx->parallel_reschedule = TRUE;
+        return;
+    }
+
+    ctx->parallel_scheduling = TRUE;
+    do {
+        ctx->parallel_reschedule = FALSE;
+        for (i = 0; i < G_N_ELEMENTS (initialization_parallel_steps); i++) {
+            InitializationStep step;
+            guint32            depends_on;
+
+            step = initialization_parallel_steps[i].step;
+            depends_on = initialization_parallel_steps[i].depends_on;
+            all |= INITIALIZATION_STEP_BIT (step);
+
+            if ((ctx->parallel_launched & INITIALIZATION_STEP_BIT (step)) ||
+                ((ctx->parallel_done & depends_on) != depends_on) ||
+                (ctx->n_parallel_running >= INITIALIZATION_PARALLEL_STEPS_MAX) ||
+                g_cancellable_is_cancelled (g_task_get_cancellable (task)))
+                continue;
+
+            ctx->parallel_launched |= INITIALIZATION_STEP_BIT (step);
+            ctx->parallel_start_time[step] = g_get_monotonic_time ();
+            ctx->n_parallel_running++;
+            if (!initialization_parallel_step_launch (task, step)) {
+                /* Nothing to do in this step */
+                ctx->n_parallel_running--;
+                ctx->parallel_done |= INITIALIZATION_STEP_BIT (step);
+            }
+        }
+    } while (ctx->parallel_reschedule);
+    ctx->parallel_scheduling = FALSE;
+
+    /* Wait for all running steps before going on, even if cancelled */
+    if (ctx->n_parallel_running > 0)
+        return;
+
+    g_assert (ctx->parallel_done == all || g_cancellable_is_cancelled (g_task_get_cancellable (task)));
+    mm_obj_dbg (self, "initialization step '%s' to '%s' finished in %" G_GINT64_FORMAT "ms",
+                initialization_step_names[INITIALIZATION_STEP_MANUFACTURER],
+                initialization_step_names[INITIALIZATION_STEP_DEVICE_ID],
+                (g_get_monotonic_time () - ctx->parallel_start_time[INITIALIZATION_STEP_MANUFACTURER]) / 1000);
+
+    ctx->step = INITIALIZATION_STEP_DEVICE_ID + 1;
+    interface_initialization_step (task);
+}
+
+static void
+initialization_parallel_step_done (GTask              *task,
+                                   InitializationStep  step)
+{
+    MMIfaceModem          *self;
+    InitializationContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    g_assert (ctx->n_parallel_running > 0);
+    ctx->n_parallel_running--;
+    ctx->parallel_done |= INITIALIZATION_STEP_BIT (step);
+
+    mm_obj_dbg (self, "initialization step '%s' finished in %" G_GINT64_FORMAT "ms",
+                initialization_step_names[step],
+                (g_get_monotonic_time () - ctx->parallel_start_time[step]) / 1000);
+
+    interface_initialization_parallel_steps (task);
+}
+
+static void
+identity_cache_validate (MMIfaceModem          *self,
+                         InitializationContext *ctx)
+{
+    const gchar      *device;
+    g_autofree gchar *plugin = NULL;
+    g_autofree gchar *revision = NULL;
+    guint             vendor_id = 0;
+    guint             product_id = 0;
+
+    device = mm_base_modem_get_device (MM_BASE_MODEM (self));
+    plugin = mm_identity_cache_get_string (device, MM_IDENTITY_CACHE_KEY_PLUGIN);
+    revision = mm_identity_cache_get_string (device, MM_IDENTITY_CACHE_KEY_REVISION);
+
+    /* The cached info must have been stored for the same kind of device,
+     * running the same firmware revision */
+    if (mm_identity_cache_get_uint (device, MM_IDENTITY_CACHE_KEY_VENDOR_ID, &vendor_id) &&
+        mm_identity_cache_get_uint (device, MM_IDENTITY_CACHE_KEY_PRODUCT_ID, &product_id) &&
+        vendor_id == mm_base_modem_get_vendor_id (MM_BASE_MODEM (self)) &&
+        product_id == mm_base_modem_get_product_id (MM_BASE_MODEM (self)) &&
+        g_strcmp0 (plugin, mm_base_modem_get_plugin (MM_BASE_MODEM (self))) == 0 &&
+        revision &&
+        g_strcmp0 (revision, mm_gdbus_modem_get_revision (ctx->skeleton)) == 0) {
+        mm_obj_dbg (self, "cached identity info is valid");
+        ctx->identity_cache_valid = TRUE;
+        return;
+    }
+
+    mm_obj_dbg (self, "cached identity info is outdated");
+    mm_identity_cache_remove_device (device);
+    mm_identity_cache_flush ();
+}
+
+static gchar *
+identity_cache_get_string (MMIfaceModem          *self,
+                           InitializationContext *ctx,
+                           const gchar           *key)
+{
+    if (!ctx->identity_cache_valid)
+        return NULL;
+    return mm_identity_cache_get_string (mm_base_modem_get_device (MM_BASE_MODEM (self)), key);
+}
+
+static void
+identity_cache_store (MMIfaceModem          *self,
+                      InitializationContext *ctx)
+{
+    const gchar *device;
+    const gchar *revision;
+
+    if (!mm_identity_cache_is_enabled ())
+        return;
+
+    device = mm_base_modem_get_device (MM_BASE_MODEM (self));
+    revision = mm_gdbus_modem_get_revision (ctx->skeleton);
+
+    /* Without revision the cached info could never be validated */
+    if (!revision) {
+        mm_identity_cache_remove_device (device);
+        mm_identity_cache_flush ();
+        return;
+    }
+
+    mm_identity_cache_set_uint   (device, MM_IDENTITY_CACHE_KEY_VENDOR_ID,         mm_base_modem_get_vendor_id (MM_BASE_MODEM (self)));
+    mm_identity_cache_set_uint   (device, MM_IDENTITY_CACHE_KEY_PRODUCT_ID,        mm_base_modem_get_product_id (MM_BASE_MODEM (self)));
+    mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_PLUGIN,            mm_base_modem_get_plugin (MM_BASE_MODEM (self)));
+    mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_REVISION,          revision);
+    mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_MANUFACTURER,      mm_gdbus_modem_get_manufacturer (ctx->skeleton));
+    mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_MODEL,             mm_gdbus_modem_get_model (ctx->skeleton));
+    mm_identity_cache_set_string (device, MM_IDENTITY_CACHE_KEY_HARDWARE_REVISION, mm_gdbus_modem_get_hardware_revision (ctx->skeleton));
+    if (ctx->supported_charsets != MM_MODEM_CHARSET_UNKNOWN)
+        mm_identity_cache_set_uint (device, MM_IDENTITY_CACHE_KEY_SUPPORTED_CHARSETS, ctx->supported_charsets);
+    else
+        mm_identity_cache_remove_key (device, MM_IDENTITY_CACHE_KEY_SUPPORTED_CHARSETS);
+    mm_identity_cache_flush ();
+}
+
+static void
+identity_cache_load_revision_ready (MMIfaceModem *self,
+                                    GAsyncResult *res,
+                                    GTask        *task)
+{
+    InitializationContext *ctx;
+    GError                *error = NULL;
+    gchar                 *val;
+
+    ctx = g_task_get_task_data (task);
+
+    /* If this fails, the revision will be loaded again in its own step */
+    val = MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision_finish (self, res, &error);
+    if (error) {
+        mm_obj_dbg (self, "couldn't load revision to validate cached identity info: %s", error->message);
+        g_error_free (error);
+    } else
+        mm_gdbus_modem_set_revision (ctx->skeleton, val);
+    g_free (val);
+
+    identity_cache_validate (self, ctx);
+
+    /* Go on to next step */
+    ctx->step++;
+    interface_initialization_step (task);
+}
+
 #undef STR_REPLY_READY_FN
-#define STR_REPLY_READY_FN(NAME,DISPLAY)                                \
+#define STR_REPLY_READY_FN(NAME,DISPLAY,STEP)                           \
     static void                                                         \
     load_##NAME##_ready (MMIfaceModem *self,                            \
                          GAsyncResult *res,                             \
@@ -4595,9 +4964,8 @@ initialization_context_free (InitializationContext *ctx)
             g_error_free (error);                                       \
         }                                                               \
                                                                         \
-        /* Go on to next step */                                        \
-        ctx->step++;                                                    \
-        interface_initialization_step (task);                           \
+        /* Go on with the parallel group */                             \
+        initialization_parallel_step_done (task, STEP);                 \
     }
 
 #undef UINT_REPLY_READY_FN
@@ -4769,12 +5137,12 @@ load_supported_capabilities_ready (MMIfaceModem *self,
     interface_initialization_step (task);
 }
 
-STR_REPLY_READY_FN (manufacturer, "manufacturer")
-STR_REPLY_READY_FN (model, "model")
-STR_REPLY_READY_FN (revision, "revision")
-STR_REPLY_READY_FN (hardware_revision, "hardware revision")
-STR_REPLY_READY_FN (equipment_identifier, "equipment identifier")
-STR_REPLY_READY_FN (device_identifier, "device identifier")
+STR_REPLY_READY_FN (manufacturer, "manufacturer", INITIALIZATION_STEP_MANUFACTURER)
+STR_REPLY_READY_FN (model, "model", INITIALIZATION_STEP_MODEL)
+STR_REPLY_READY_FN (revision, "revision", INITIALIZATION_STEP_REVISION)
+STR_REPLY_READY_FN (hardware_revision, "hardware revision", INITIALIZATION_STEP_HARDWARE_REVISION)
+STR_REPLY_READY_FN (equipment_identifier, "equipment identifier", INITIALIZATION_STEP_EQUIPMENT_ID)
+STR_REPLY_READY_FN (device_identifier, "device identifier", INITIALIZATION_STEP_DEVICE_ID)
 
 static void
 load_supported_charsets_ready (MMIfaceModem *self,
@@ -5126,9 +5494,8 @@ load_carrier_config_ready (MMIfaceModem *self,
         g_free (revision);
     }
 
-    /* Go on to next step */
-    ctx->step++;
-    interface_initialization_step (task);
+    /* Go on with the parallel group */
+    initialization_parallel_step_done (task, INITIALIZATION_STEP_CARRIER_CONFIG);
 }
 
 void
@@ -5242,8 +5609,178 @@ load_current_bands_ready (MMIfaceModem *self,
     interface_initialization_step (task);
 }
 
+static gboolean
+initialization_parallel_step_launch (GTask              *task,
+                                     InitializationStep  step)
+{
+    MMIfaceModem          *self;
+    InitializationContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    switch (step) {
+    case INITIALIZATION_STEP_MANUFACTURER:
+        /* Manufacturer is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_manufacturer (ctx->skeleton) == NULL) {
+            g_autofree gchar *cached = NULL;
+
+            cached = identity_cache_get_string (self, ctx, MM_IDENTITY_CACHE_KEY_MANUFACTURER);
+            if (cached) {
+                mm_gdbus_modem_set_manufacturer (ctx->skeleton, cached);
+                return FALSE;
+            }
+        }
+        if (mm_gdbus_modem_get_manufacturer (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer (
+                self,
+                (GAsyncReadyCallback)load_manufacturer_ready,
+                task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_MODEL:
+        /* Model is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_model (ctx->skeleton) == NULL) {
+            g_autofree gchar *cached = NULL;
+
+            cached = identity_cache_get_string (self, ctx, MM_IDENTITY_CACHE_KEY_MODEL);
+            if (cached) {
+                mm_gdbus_modem_set_model (ctx->skeleton, cached);
+                return FALSE;
+            }
+        }
+        if (mm_gdbus_modem_get_model (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_model &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_model_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_model (
+                self,
+                (GAsyncReadyCallback)load_model_ready,
+                task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_REVISION:
+        /* Revision is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_revision (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision (
+                self,
+                (GAsyncReadyCallback)load_revision_ready,
+                task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_CARRIER_CONFIG:
+        /* Current carrier config is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_carrier_configuration (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_carrier_config &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_carrier_config_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_carrier_config (self,
+                                                                      (GAsyncReadyCallback)load_carrier_config_ready,
+                                                                      task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_HARDWARE_REVISION:
+        /* HardwareRevision is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_hardware_revision (ctx->skeleton) == NULL) {
+            g_autofree gchar *cached = NULL;
+
+            cached = identity_cache_get_string (self, ctx, MM_IDENTITY_CACHE_KEY_HARDWARE_REVISION);
+            if (cached) {
+                mm_gdbus_modem_set_hardware_revision (ctx->skeleton, cached);
+                return FALSE;
+            }
+        }
+        if (mm_gdbus_modem_get_hardware_revision (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision (
+                self,
+                (GAsyncReadyCallback)load_hardware_revision_ready,
+                task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_EQUIPMENT_ID:
+        /* Equipment ID is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_equipment_identifier (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier (
+                self,
+                (GAsyncReadyCallback)load_equipment_identifier_ready,
+                task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_DEVICE_ID:
+        /* Device ID is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_device_identifier (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier (
+                self,
+                (GAsyncReadyCallback)load_device_identifier_ready,
+                task);
+            return TRUE;
+        }
+        return FALSE;
+
+    case INITIALIZATION_STEP_FIRST:
+    case INITIALIZATION_STEP_CURRENT_CAPABILITIES:
+    case INITIALIZATION_STEP_IDENTITY_CACHE:
+    case INITIALIZATION_STEP_SUPPORTED_CAPABILITIES:
+    case INITIALIZATION_STEP_SUPPORTED_CHARSETS:
+    case INITIALIZATION_STEP_CHARSET:
+    case INITIALIZATION_STEP_BEARERS:
+    case INITIALIZATION_STEP_SUPPORTED_MODES:
+    case INITIALIZATION_STEP_SUPPORTED_BANDS:
+    case INITIALIZATION_STEP_SUPPORTED_IP_FAMILIES:
+    case INITIALIZATION_STEP_POWER_STATE:
+    case INITIALIZATION_STEP_SIM_HOT_SWAP:
+    case INITIALIZATION_STEP_SIM_SLOTS:
+    case INITIALIZATION_STEP_UNLOCK_REQUIRED:
+    case INITIALIZATION_STEP_SIM:
+    case INITIALIZATION_STEP_SETUP_CARRIER_CONFIG:
+    case INITIALIZATION_STEP_OWN_NUMBERS:
+    case INITIALIZATION_STEP_CURRENT_MODES:
+    case INITIALIZATION_STEP_CURRENT_BANDS:
+    case INITIALIZATION_STEP_LAST:
+    default:
+        break;
+    }
+
+    g_assert_not_reached ();
+    return FALSE;
+}
+
 static void
-interface_initialization_step (GTask *task)
+interface_initialization_step_run (GTask *task)
 {
     MMIfaceModem *self;
     InitializationContext *ctx;
@@ -5341,6 +5878,26 @@ interface_initialization_step (GTask *task)
         ctx->step++;
         /* fall-through */
 
+    case INITIALIZATION_STEP_IDENTITY_CACHE:
+        /* If there is cached identity info for this device, validate it against
+         * the current firmware revision, which is loaded earlier than usual in
+         * this case. The device entry may also exist with just port probing
+         * results, which are validated on their own. */
+        if (mm_identity_cache_has_key (mm_base_modem_get_device (MM_BASE_MODEM (self)), MM_IDENTITY_CACHE_KEY_REVISION)) {
+            if (mm_gdbus_modem_get_revision (ctx->skeleton) == NULL &&
+                MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision &&
+                MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision_finish) {
+                MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision (
+                    self,
+                    (GAsyncReadyCallback)identity_cache_load_revision_ready,
+                    task);
+                return;
+            }
+            identity_cache_validate (self, ctx);
+        }
+        ctx->step++;
+        /* fall-through */
+
     case INITIALIZATION_STEP_SUPPORTED_CAPABILITIES: {
         GArray *supported_capabilities;
 
@@ -5378,9 +5935,16 @@ interface_initialization_step (GTask *task)
         ctx->step++;
     } /* fall-through */
 
-    case INITIALIZATION_STEP_SUPPORTED_CHARSETS:
-        if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets_finish) {
+    case INITIALIZATION_STEP_SUPPORTED_CHARSETS: {
+        guint cached_charsets = 0;
+
+        if (ctx->identity_cache_valid &&
+            mm_identity_cache_get_uint (mm_base_modem_get_device (MM_BASE_MODEM (self)),
+                                        MM_IDENTITY_CACHE_KEY_SUPPORTED_CHARSETS,
+                                        &cached_charsets))
+            ctx->supported_charsets = (MMModemCharset) cached_charsets;
+        else if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets &&
+                 MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets_finish) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets (
                 self,
                 (GAsyncReadyCallback)load_supported_charsets_ready,
@@ -5388,7 +5952,7 @@ interface_initialization_step (GTask *task)
             return;
         }
         ctx->step++;
-        /* fall-through */
+    } /* fall-through */
 
     case INITIALIZATION_STEP_CHARSET:
         /* Only try to set charsets if we were able to load supported ones */
@@ -5463,115 +6027,17 @@ interface_initialization_step (GTask *task)
     } /* fall-through */
 
     case INITIALIZATION_STEP_MANUFACTURER:
-        /* Manufacturer is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_manufacturer (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer (
-                self,
-                (GAsyncReadyCallback)load_manufacturer_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_MODEL:
-        /* Model is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_model (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_model &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_model_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_model (
-                self,
-                (GAsyncReadyCallback)load_model_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_REVISION:
-        /* Revision is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_revision (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision (
-                self,
-                (GAsyncReadyCallback)load_revision_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_CARRIER_CONFIG:
-        /* Current carrier config is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_carrier_configuration (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_carrier_config &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_carrier_config_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_carrier_config (self,
-                                                                      (GAsyncReadyCallback)load_carrier_config_ready,
-                                                                      task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_HARDWARE_REVISION:
-        /* HardwareRevision is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_hardware_revision (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision (
-                self,
-                (GAsyncReadyCallback)load_hardware_revision_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_EQUIPMENT_ID:
-        /* Equipment ID is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_equipment_identifier (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier (
-                self,
-                (GAsyncReadyCallback)load_equipment_identifier_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_DEVICE_ID:
-        /* Device ID is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_device_identifier (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier (
-                self,
-                (GAsyncReadyCallback)load_device_identifier_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
+        /* Identity info loading steps are run as a parallel group, which
+         * goes on with the next step once all of them are done */
+        g_assert (ctx->step == INITIALIZATION_STEP_MANUFACTURER);
+        interface_initialization_parallel_steps (task);
+        return;
 
     case INITIALIZATION_STEP_SUPPORTED_MODES:
         if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_modes != NULL &&
@@ -5901,8 +6367,10 @@ interface_initialization_step (GTask *task)
         if (ctx->fatal_error) {
             g_task_return_error (task, ctx->fatal_error);
             ctx->fatal_error = NULL;
-        } else
+        } else {
+            identity_cache_store (self, ctx);
             g_task_return_boolean (task, TRUE);
+        }
 
         g_object_unref (task);
         return;
@@ -5914,6 +6382,35 @@ interface_initialization_step (GTask *task)
     g_assert_not_reached ();
 }
 
+static void
+interface_initialization_step (GTask *task)
+{
+    MMIfaceModem          *self;
+    InitializationContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    if (ctx->running_step_start_time) {
+        mm_obj_dbg (self, "initialization step '%s' finished in %" G_GINT64_FORMAT "ms",
+                    initialization_step_names[ctx->running_step],
+                    (g_get_monotonic_time () - ctx->running_step_start_time) / 1000);
+        ctx->running_step_start_time = 0;
+    }
+
+    /* The task may be completed while running the step */
+    g_object_ref (task);
+    interface_initialization_step_run (task);
+    if (!g_task_get_completed (task) &&
+        !initialization_step_is_parallel (ctx->step) &&
+        !ctx->running_step_start_time) {
+        /* Waiting for an asynchronous step to finish */
+        ctx->running_step = ctx->step;
+        ctx->running_step_start_time = g_get_monotonic_time ();
+    }
+    g_object_unref (task);
+}
+
 gboolean
 mm_iface_modem_initialize_finish (MMIfaceModem *self,
                                   GAsyncResult *res,
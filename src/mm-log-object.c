@@ -53,13 +53,14 @@ get_private (MMLogObject *self)
     return priv;
 }
 
+/* The id is built once and cached, as it's needed in every log message */
 const gchar *
 mm_log_object_get_id (MMLogObject *self)
 {
     Private *priv;
 
     priv = get_private (self);
-    if (!priv->id) {
+    if (G_UNLIKELY (!priv->id)) {
         gchar *self_id;
 
         self_id = MM_LOG_OBJECT_GET_IFACE (self)->build_id (self);
@@ -79,8 +80,17 @@ mm_log_object_set_owner_id (MMLogObject *self,
     Private *priv;
 
     priv = get_private (self);
+    if (!g_strcmp0 (priv->owner_id, owner_id))
+        return;
     g_free (priv->owner_id);
     priv->owner_id = g_strdup (owner_id);
+    g_clear_pointer (&priv->id, g_free);
+}
+
+void
+mm_log_object_reset_id (MMLogObject *self)
+{
+    g_clear_pointer (&get_private (self)->id, g_free);
 }
 
 static void
@@ -43,4 +43,6 @@ _mm_log (gpointer     obj,
     g_free (msg);
 }
 
+guint32 _mm_log_level = MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_DEBUG;
+
 #endif /* MM_LOG_TEST_H */
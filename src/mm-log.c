@@ -51,7 +51,7 @@ enum {
 };
 
 static gboolean ts_flags = TS_FLAG_NONE;
-static guint32 log_level = MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_ERR;
+guint32 _mm_log_level = MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_ERR;
 static GTimeVal rel_start = { 0, 0 };
 static int logfd = -1;
 static gboolean append_log_level_text = TRUE;
@@ -75,8 +75,46 @@ static const LogDesc level_descs[] = {
     { 0, NULL }
 };
 
-static GString *msgbuf = NULL;
-static gsize msgbuf_once = 0;
+/*****************************************************************************/
+/* Log records are formatted by the caller and written by a separate thread,
+ * so that a slow log file or journal never blocks the main loop. They are
+ * passed through a bounded queue of pre-allocated records (Vyukov's MPMC
+ * ring, used here with a single consumer); when the queue is full, records
+ * are dropped and counted instead of waiting. */
+
+#define LOG_QUEUE_SIZE          256 /* power of 2 */
+#define LOG_MESSAGE_INLINE_SIZE 512
+
+typedef struct {
+    /* Position in the queue this record is ready for */
+    gint         sequence;
+    const gchar *loc;
+    const gchar *func;
+    int          syslog_level;
+    gsize        length;
+    /* Message, either inline or, if too long, allocated */
+    gchar       *allocated;
+    gchar        message[LOG_MESSAGE_INLINE_SIZE];
+} LogRecord;
+
+static LogRecord *log_queue;
+static gint       log_queue_enqueue_pos;
+static guint      log_queue_dequeue_pos; /* writer thread only */
+static gint       log_queue_dropped;
+
+static GThread   *log_writer_thread;
+static GMutex     log_writer_mutex;
+static GCond      log_writer_cond;
+static gint       log_writer_waiting;
+static gint       log_writer_stop;
+
+/* Buffer in the caller stack where a message is built; only moved to the
+ * heap if it doesn't fit */
+typedef struct {
+    gchar    stack[LOG_MESSAGE_INLINE_SIZE];
+    gsize    length;
+    GString *heap;
+} LogBuffer;
 
 static int
 mm_to_syslog_priority (MMLogLevel level)
@@ -156,7 +194,10 @@ log_backend_file (const char *loc,
     ign = write (logfd, message, length);
     if (ign) {} /* whatever; really shut up about unused result */
 
-    fsync (logfd);  /* Make sure output is dumped to disk immediately  */
+    /* Without writer thread, make sure output is dumped to disk
+     * immediately; otherwise done once the queue is drained */
+    if (!log_writer_thread)
+        fsync (logfd);
 }
 
 static void
@@ -206,6 +247,207 @@ log_backend_systemd_journal (const char *loc,
 }
 #endif
 
+/*****************************************************************************/
+
+static void
+log_buffer_append_vprintf (LogBuffer   *buffer,
+                           const gchar *fmt,
+                           va_list      args)
+{
+    if (!buffer->heap) {
+        va_list args_copy;
+        gint    n;
+
+        G_VA_COPY (args_copy, args);
+        n = g_vsnprintf (buffer->stack + buffer->length,
+                         sizeof (buffer->stack) - buffer->length,
+                         fmt,
+                         args_copy);
+        va_end (args_copy);
+
+        if (n >= 0 && buffer->length + n < sizeof (buffer->stack)) {
+            buffer->length += n;
+            return;
+        }
+
+        /* Didn't fit, the truncated output is discarded */
+        buffer->heap = g_string_sized_new (2 * sizeof (buffer->stack));
+        g_string_append_len (buffer->heap, buffer->stack, buffer->length);
+    }
+
+    g_string_append_vprintf (buffer->heap, fmt, args);
+}
+
+static void
+log_buffer_append_printf (LogBuffer   *buffer,
+                          const gchar *fmt,
+                          ...)
+{
+    va_list args;
+
+    va_start (args, fmt);
+    log_buffer_append_vprintf (buffer, fmt, args);
+    va_end (args);
+}
+
+static gboolean
+log_queue_push (const gchar *loc,
+                const gchar *func,
+                int          syslog_level,
+                const gchar *message,
+                gsize        length)
+{
+    LogRecord *record;
+    guint      pos;
+
+    pos = (guint) g_atomic_int_get (&log_queue_enqueue_pos);
+    for (;;) {
+        gint diff;
+
+        record = &log_queue[pos & (LOG_QUEUE_SIZE - 1)];
+        diff = (gint) ((guint) g_atomic_int_get (&record->sequence) - pos);
+        if (diff == 0) {
+            /* Record free, try to claim it */
+            if (g_atomic_int_compare_and_exchange (&log_queue_enqueue_pos, (gint) pos, (gint) (pos + 1)))
+                break;
+            pos = (guint) g_atomic_int_get (&log_queue_enqueue_pos);
+        } else if (diff < 0) {
+            /* Full; the writer thread hasn't released this record yet */
+            g_atomic_int_inc (&log_queue_dropped);
+            return FALSE;
+        } else
+            pos = (guint) g_atomic_int_get (&log_queue_enqueue_pos);
+    }
+
+    record->loc = loc;
+    record->func = func;
+    record->syslog_level = syslog_level;
+    record->length = length;
+    if (length < sizeof (record->message)) {
+        memcpy (record->message, message, length + 1);
+        record->allocated = NULL;
+    } else
+        record->allocated = g_strndup (message, length);
+
+    /* Publish */
+    g_atomic_int_set (&record->sequence, (gint) (pos + 1));
+
+    /* Only need to take the lock if the writer is waiting */
+    if (g_atomic_int_get (&log_writer_waiting)) {
+        g_mutex_lock (&log_writer_mutex);
+        g_cond_signal (&log_writer_cond);
+        g_mutex_unlock (&log_writer_mutex);
+    }
+    return TRUE;
+}
+
+static gboolean
+log_queue_pop_and_write (void)
+{
+    LogRecord *record;
+    guint      pos;
+
+    pos = log_queue_dequeue_pos;
+    record = &log_queue[pos & (LOG_QUEUE_SIZE - 1)];
+    if ((gint) ((guint) g_atomic_int_get (&record->sequence) - (pos + 1)) < 0)
+        return FALSE;
+
+    log_backend (record->loc,
+                 record->func,
+                 record->syslog_level,
+                 record->allocated ? record->allocated : record->message,
+                 record->length);
+    g_clear_pointer (&record->allocated, g_free);
+
+    /* Release the record for the next round */
+    g_atomic_int_set (&record->sequence, (gint) (pos + LOG_QUEUE_SIZE));
+    log_queue_dequeue_pos = pos + 1;
+    return TRUE;
+}
+
+static void
+log_write_dropped (void)
+{
+    gint  dropped;
+    gchar message[128];
+    gint  length;
+
+    do {
+        dropped = g_atomic_int_get (&log_queue_dropped);
+    } while (dropped && !g_atomic_int_compare_and_exchange (&log_queue_dropped, dropped, 0));
+
+    if (!dropped)
+        return;
+
+    length = g_snprintf (message, sizeof (message), "%s%d log messages dropped\n",
+                         append_log_level_text ? "<warn>  " : "", dropped);
+    log_backend (NULL, NULL, LOG_WARNING, message, MIN ((gsize) length, sizeof (message) - 1));
+}
+
+static gpointer
+log_writer_thread_func (gpointer user_data)
+{
+    for (;;) {
+        gboolean written = FALSE;
+
+        while (log_queue_pop_and_write ())
+            written = TRUE;
+        log_write_dropped ();
+        if (written && logfd >= 0)
+            fsync (logfd);
+
+        g_mutex_lock (&log_writer_mutex);
+        g_atomic_int_set (&log_writer_waiting, TRUE);
+        /* Re-check with the lock held, so that a push done after the queue
+         * was found empty always signals us */
+        if (!log_queue_pop_and_write ()) {
+            if (g_atomic_int_get (&log_writer_stop)) {
+                g_atomic_int_set (&log_writer_waiting, FALSE);
+                g_mutex_unlock (&log_writer_mutex);
+                break;
+            }
+            g_cond_wait (&log_writer_cond, &log_writer_mutex);
+        }
+        g_atomic_int_set (&log_writer_waiting, FALSE);
+        g_mutex_unlock (&log_writer_mutex);
+    }
+
+    log_write_dropped ();
+    return NULL;
+}
+
+/* Stops the writer thread once it has written all pending records; any
+ * record pushed while it was stopping is written by the caller */
+static void
+log_writer_stop_and_join (void)
+{
+    g_mutex_lock (&log_writer_mutex);
+    g_atomic_int_set (&log_writer_stop, TRUE);
+    g_cond_signal (&log_writer_cond);
+    g_mutex_unlock (&log_writer_mutex);
+    g_thread_join (log_writer_thread);
+    log_writer_thread = NULL;
+
+    while (log_queue_pop_and_write ());
+    log_write_dropped ();
+}
+
+static void
+log_dispatch (const gchar *loc,
+              const gchar *func,
+              int          syslog_level,
+              const gchar *message,
+              gsize        length)
+{
+    if (!log_writer_thread) {
+        log_backend (loc, func, syslog_level, message, length);
+        return;
+    }
+    log_queue_push (loc, func, syslog_level, message, length);
+}
+
+/*****************************************************************************/
+
 void
 _mm_log (gpointer     obj,
          const gchar *module,
@@ -215,24 +457,22 @@ _mm_log (gpointer     obj,
          const gchar *fmt,
          ...)
 {
-    va_list args;
-    GTimeVal tv;
+    va_list   args;
+    GTimeVal  tv;
+    LogBuffer buffer;
 
-    if (!(log_level & level))
+    if (!(_mm_log_level & level))
         return;
 
-    if (g_once_init_enter (&msgbuf_once)) {
-        msgbuf = g_string_sized_new (512);
-        g_once_init_leave (&msgbuf_once, 1);
-    } else
-        g_string_truncate (msgbuf, 0);
+    buffer.length = 0;
+    buffer.heap = NULL;
 
     if (append_log_level_text)
-        g_string_append_printf (msgbuf, "%s ", log_level_description (level));
+        log_buffer_append_printf (&buffer, "%s ", log_level_description (level));
 
     if (ts_flags == TS_FLAG_WALL) {
         g_get_current_time (&tv);
-        g_string_append_printf (msgbuf, "[%09ld.%06ld] ", tv.tv_sec, tv.tv_usec);
+        log_buffer_append_printf (&buffer, "[%09ld.%06ld] ", tv.tv_sec, tv.tv_usec);
     } else if (ts_flags == TS_FLAG_REL) {
         glong secs;
         glong usecs;
@@ -245,25 +485,29 @@ _mm_log (gpointer     obj,
             usecs += 1000000;
         }
 
-        g_string_append_printf (msgbuf, "[%06ld.%06ld] ", secs, usecs);
+        log_buffer_append_printf (&buffer, "[%06ld.%06ld] ", secs, usecs);
     }
 
 #if defined MM_LOG_FUNC_LOC
-    g_string_append_printf (msgbuf, "[%s] %s(): ", loc, func);
+    log_buffer_append_printf (&buffer, "[%s] %s(): ", loc, func);
 #endif
 
     if (obj)
-        g_string_append_printf (msgbuf, "[%s] ", mm_log_object_get_id (MM_LOG_OBJECT (obj)));
+        log_buffer_append_printf (&buffer, "[%s] ", mm_log_object_get_id (MM_LOG_OBJECT (obj)));
     if (module)
-        g_string_append_printf (msgbuf, "(%s) ", module);
+        log_buffer_append_printf (&buffer, "(%s) ", module);
 
     va_start (args, fmt);
-    g_string_append_vprintf (msgbuf, fmt, args);
+    log_buffer_append_vprintf (&buffer, fmt, args);
     va_end (args);
 
-    g_string_append_c (msgbuf, '\n');
+    log_buffer_append_printf (&buffer, "\n");
 
-    log_backend (loc, func, mm_to_syslog_priority (level), msgbuf->str, msgbuf->len);
+    if (buffer.heap) {
+        log_dispatch (loc, func, mm_to_syslog_priority (level), buffer.heap->str, buffer.heap->len);
+        g_string_free (buffer.heap, TRUE);
+    } else
+        log_dispatch (loc, func, mm_to_syslog_priority (level), buffer.stack, buffer.length);
 }
 
 static void
@@ -272,7 +516,23 @@ log_handler (const gchar *log_domain,
              const gchar *message,
              gpointer ignored)
 {
-    log_backend (NULL, NULL, glib_to_syslog_priority (level), message, strlen (message));
+    /* Fatal messages are written right away, as the process is about to
+     * abort; but only after all the pending records, so that the context
+     * leading to the failure comes before it. Not possible if it's the
+     * writer thread itself failing. */
+    if (level & (G_LOG_FLAG_FATAL | G_LOG_LEVEL_ERROR)) {
+        if (log_writer_thread && g_thread_self () != log_writer_thread)
+            log_writer_stop_and_join ();
+        log_backend (NULL, NULL, glib_to_syslog_priority (level), message, strlen (message));
+        if (logfd >= 0)
+            fsync (logfd);
+        return;
+    }
+    if (!log_writer_thread) {
+        log_backend (NULL, NULL, glib_to_syslog_priority (level), message, strlen (message));
+        return;
+    }
+    log_queue_push (NULL, NULL, glib_to_syslog_priority (level), message, strlen (message));
 }
 
 gboolean
@@ -283,7 +543,7 @@ mm_log_set_level (const char *level, GError **error)
 
     for (diter = &level_descs[0]; diter->name; diter++) {
         if (!strcasecmp (diter->name, level)) {
-            log_level = diter->num;
+            _mm_log_level = diter->num;
             found = TRUE;
             break;
         }
@@ -294,11 +554,11 @@ mm_log_set_level (const char *level, GError **error)
                      "Unknown log level '%s'", level);
 
 #if defined WITH_QMI
-    qmi_utils_set_traces_enabled (log_level & MM_LOG_LEVEL_DEBUG ? TRUE : FALSE);
+    qmi_utils_set_traces_enabled (mm_log_check_level_enabled (MM_LOG_LEVEL_DEBUG) ? TRUE : FALSE);
 #endif
 
 #if defined WITH_MBIM
-    mbim_utils_set_traces_enabled (log_level & MM_LOG_LEVEL_DEBUG ? TRUE : FALSE);
+    mbim_utils_set_traces_enabled (mm_log_check_level_enabled (MM_LOG_LEVEL_DEBUG) ? TRUE : FALSE);
 #endif
 
     return found;
@@ -372,12 +632,29 @@ mm_log_setup (const char *level,
                        NULL);
 #endif
 
+    /* Start the writer thread, from now on all log messages go through
+     * the queue */
+    if (!log_writer_thread) {
+        guint i;
+
+        log_queue = g_new0 (LogRecord, LOG_QUEUE_SIZE);
+        for (i = 0; i < LOG_QUEUE_SIZE; i++)
+            log_queue[i].sequence = (gint) i;
+        log_writer_thread = g_thread_new ("mm-log-writer", log_writer_thread_func, NULL);
+    }
+
     return TRUE;
 }
 
 void
 mm_log_shutdown (void)
 {
+    /* Flush all pending records and stop the writer thread */
+    if (log_writer_thread) {
+        log_writer_stop_and_join ();
+        g_clear_pointer (&log_queue, g_free);
+    }
+
     if (logfd < 0)
         closelog ();
     else
@@ -31,10 +31,32 @@ typedef enum {
 # define MM_MODULE_NAME (const gchar *)NULL
 #endif
 
-#define mm_obj_err(obj, ...)  _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_ERR,   ## __VA_ARGS__ )
-#define mm_obj_warn(obj, ...) _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_WARN,  ## __VA_ARGS__ )
-#define mm_obj_info(obj, ...) _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_INFO,  ## __VA_ARGS__ )
-#define mm_obj_dbg(obj, ...)  _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_DEBUG, ## __VA_ARGS__ )
+/* Currently enabled log levels; only to be read through the macros below */
+extern guint32 _mm_log_level;
+
+/* Levels built in; debug messages are compiled out completely if
+ * requested (e.g. for size-constrained systems) */
+#if defined MM_LOG_NO_DEBUG
+# define MM_LOG_LEVELS_BUILT (MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO)
+#else
+# define MM_LOG_LEVELS_BUILT (MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_DEBUG)
+#endif
+
+/* Allows skipping expensive work done only to build a log message */
+#define mm_log_check_level_enabled(level) \
+    ((MM_LOG_LEVELS_BUILT & (level)) && G_UNLIKELY (_mm_log_level & (level)))
+
+/* The level is checked before evaluating any of the message arguments */
+#define _mm_obj_log(obj, level, ...)                                                   \
+    G_STMT_START {                                                                     \
+        if (mm_log_check_level_enabled (level))                                        \
+            _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, level, __VA_ARGS__);    \
+    } G_STMT_END
+
+#define mm_obj_err(obj, ...)  _mm_obj_log (obj, MM_LOG_LEVEL_ERR,   __VA_ARGS__)
+#define mm_obj_warn(obj, ...) _mm_obj_log (obj, MM_LOG_LEVEL_WARN,  __VA_ARGS__)
+#define mm_obj_info(obj, ...) _mm_obj_log (obj, MM_LOG_LEVEL_INFO,  __VA_ARGS__)
+#define mm_obj_dbg(obj, ...)  _mm_obj_log (obj, MM_LOG_LEVEL_DEBUG, __VA_ARGS__)
 
 /* only allow using non-object logging API if explicitly requested
  * (e.g. in the main daemon source) */
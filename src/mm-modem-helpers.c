@@ -5393,3 +5393,88 @@ mm_sim_parse_cpol_test_response (const gchar  *response,
 
     return TRUE;
 }
+
+/*****************************************************************************/
+
+/* The sentence starts with '$' and the given length doesn't include the
+ * trailing CRLF. The checksum is optional. */
+static gboolean
+nmea_sentence_checksum_valid (const guint8 *sentence,
+                              gsize         len)
+{
+    const guint8 *star;
+    guint8        checksum = 0;
+    gsize         i;
+
+    star = memchr (sentence, '*', len);
+    if (!star)
+        return TRUE;
+
+    /* Exactly two hex digits after the asterisk */
+    if ((gsize)(star - sentence) + 3 != len ||
+        !g_ascii_isxdigit (star[1]) ||
+        !g_ascii_isxdigit (star[2]))
+        return FALSE;
+
+    for (i = 1; &sentence[i] < star; i++)
+        checksum ^= sentence[i];
+
+    return (checksum == ((g_ascii_xdigit_value (star[1]) << 4) | g_ascii_xdigit_value (star[2])));
+}
+
+guint
+mm_nmea_parse_sentences (GByteArray       *buffer,
+                         GByteArray       *other,
+                         MMNmeaSentenceFn  callback,
+                         gpointer          user_data)
+{
+    guint n_sentences = 0;
+    gsize len;
+    gsize pos = 0;
+
+    /* Reserve one extra byte, so that a sentence at the very end of the buffer
+     * can also be NUL-terminated in place */
+    len = buffer->len;
+    g_byte_array_set_size (buffer, len + 1);
+
+    while (pos < len) {
+        guint8 *line;
+        guint8 *start;
+        guint8 *end;
+        gsize   line_len;
+
+        line = &buffer->data[pos];
+        end = memchr (line, '\n', len - pos);
+        if (!end)
+            break;
+        line_len = end - line + 1;
+
+        /* Every NMEA sentence starts with '$' and ends with CRLF */
+        start = memchr (line, '$', line_len);
+        if (start && end[-1] == '\r' && (end - 1) > start) {
+            if (other && start > line)
+                g_byte_array_append (other, line, start - line);
+
+            if (nmea_sentence_checksum_valid (start, end - 1 - start)) {
+                n_sentences++;
+                if (callback) {
+                    guint8 saved;
+
+                    saved = end[1];
+                    end[1] = '\0';
+                    callback ((const gchar *) start, user_data);
+                    end[1] = saved;
+                }
+            }
+        } else if (other)
+            g_byte_array_append (other, line, line_len);
+
+        pos += line_len;
+    }
+
+    g_byte_array_set_size (buffer, len);
+    if (pos > 0)
+        g_byte_array_remove_range (buffer, 0, pos);
+
+    return n_sentences;
+}
@@ -563,6 +563,25 @@ gboolean mm_sim_parse_cpol_test_response (const gchar  *response,
                                           guint        *out_max_index,
                                           GError      **error);
 
+/*****************************************************************************/
+/* NMEA specific helpers and utilities */
+/*****************************************************************************/
+
+/* Called for every complete NMEA sentence with a valid checksum. The sentence
+ * is given as a NUL-terminated slice of the input buffer (including the
+ * trailing CRLF), only valid during the callback. */
+typedef void (* MMNmeaSentenceFn) (const gchar *sentence,
+                                   gpointer     user_data);
+
+/* Split the complete lines in the buffer into NMEA sentences, which are removed
+ * from the buffer. Lines which aren't NMEA sentences are moved to @other, if
+ * given. Incomplete lines are left in the buffer. Returns the number of valid
+ * sentences found. */
+guint mm_nmea_parse_sentences (GByteArray       *buffer,
+                               GByteArray       *other,
+                               MMNmeaSentenceFn  callback,
+                               gpointer          user_data);
+
 /*****************************************************************************/
 
 /* Useful when clamp-ing an unsigned integer with implicit low limit set to 0,
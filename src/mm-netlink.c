@@ -162,6 +162,20 @@ netlink_message_new_setlink (guint    ifindex,
     return msg;
 }
 
+static NetlinkMessage *
+netlink_message_new_getlink (guint ifindex)
+{
+    NetlinkMessage *msg;
+    NetlinkHeader  *hdr;
+
+    msg = netlink_message_new (ifindex, RTM_GETLINK);
+    hdr = netlink_message_header (msg);
+
+    hdr->ifreq.ifi_change = 0;
+
+    return msg;
+}
+
 static void
 netlink_message_free (NetlinkMessage *msg)
 {
@@ -171,11 +185,20 @@ netlink_message_free (NetlinkMessage *msg)
 /*****************************************************************************/
 /* Netlink transactions */
 
+/* Link statistics collected from the RTM_NEWLINK reply, before the ACK
+ * completes the transaction */
+typedef struct {
+    gboolean received;
+    guint64  rx_bytes;
+    guint64  tx_bytes;
+} LinkStats;
+
 typedef struct {
     MMNetlink *self;
     guint32    sequence_id;
     GSource   *timeout_source;
     GTask     *completion_task;
+    LinkStats *link_stats;
 } Transaction;
 
 static gboolean
@@ -227,7 +250,12 @@ transaction_complete (Transaction *tr,
                          GUINT_TO_POINTER (tr->sequence_id));
 
     if (!saved_errno) {
-        g_task_return_boolean (task, TRUE);
+        if (tr->link_stats && !tr->link_stats->received)
+            g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                                     "Netlink message with transaction %u didn't report link statistics",
+                                     sequence_id);
+        else
+            g_task_return_boolean (task, TRUE);
     } else {
         g_task_return_new_error (task, G_IO_ERROR, g_io_error_from_errno (saved_errno),
                                  "Netlink message with transaction %u failed",
@@ -329,13 +357,106 @@ mm_netlink_setlink (MMNetlink           *self,
 
 /*****************************************************************************/
 
+gboolean
+mm_netlink_getlink_stats_finish (MMNetlink     *self,
+                                 GAsyncResult  *res,
+                                 guint64       *rx_bytes,
+                                 guint64       *tx_bytes,
+                                 GError       **error)
+{
+    LinkStats *link_stats;
+
+    if (!g_task_propagate_boolean (G_TASK (res), error))
+        return FALSE;
+
+    link_stats = g_task_get_task_data (G_TASK (res));
+    if (rx_bytes)
+        *rx_bytes = link_stats->rx_bytes;
+    if (tx_bytes)
+        *tx_bytes = link_stats->tx_bytes;
+    return TRUE;
+}
+
+void
+mm_netlink_getlink_stats (MMNetlink           *self,
+                          guint                ifindex,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+    GTask          *task;
+    NetlinkMessage *msg;
+    Transaction    *tr;
+    gssize          bytes_sent;
+    GError         *error = NULL;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    if (!self->socket) {
+        g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                                 "netlink support not available");
+        g_object_unref (task);
+        return;
+    }
+
+    g_task_set_task_data (task, g_new0 (LinkStats, 1), g_free);
+
+    msg = netlink_message_new_getlink (ifindex);
+
+    /* The task ownership is transferred to the transaction. */
+    tr = transaction_new (self, msg, 5, task);
+    tr->link_stats = g_task_get_task_data (task);
+
+    bytes_sent = g_socket_send (self->socket,
+                                (const gchar *) msg->data,
+                                msg->len,
+                                cancellable,
+                                &error);
+    netlink_message_free (msg);
+
+    if (bytes_sent < 0)
+        transaction_complete_with_error (tr, error);
+
+    g_object_unref (task);
+}
+
+/*****************************************************************************/
+
+static void
+process_newlink (Transaction     *tr,
+                 struct nlmsghdr *hdr)
+{
+    struct rtattr *attr;
+    gint           attr_len;
+
+    if (hdr->nlmsg_len < NLMSG_LENGTH (sizeof (struct ifinfomsg)))
+        return;
+
+    attr = IFLA_RTA (NLMSG_DATA (hdr));
+    attr_len = IFLA_PAYLOAD (hdr);
+    for (; RTA_OK (attr, attr_len); attr = RTA_NEXT (attr, attr_len)) {
+        struct rtnl_link_stats64 stats;
+
+        if (attr->rta_type != IFLA_STATS64 || RTA_PAYLOAD (attr) < (gint) sizeof (stats))
+            continue;
+
+        /* The attribute payload is only 4-byte aligned */
+        memcpy (&stats, RTA_DATA (attr), sizeof (stats));
+        tr->link_stats->rx_bytes = stats.rx_bytes;
+        tr->link_stats->tx_bytes = stats.tx_bytes;
+        tr->link_stats->received = TRUE;
+        break;
+    }
+}
+
 static gboolean
 netlink_message_cb (GSocket      *socket,
                     GIOCondition  condition,
                     MMNetlink    *self)
 {
     g_autoptr(GError) error = NULL;
-    gchar             buf[512];
+    /* Large enough for a full RTM_NEWLINK reply */
+    gchar             buf[8192];
     gssize            bytes_received;
     guint             buffer_len;
     struct nlmsghdr  *hdr;
@@ -353,11 +474,11 @@ netlink_message_cb (GSocket      *socket,
 
     buffer_len = (guint) bytes_received;
     for (hdr = (struct nlmsghdr *) buf; NLMSG_OK (hdr, buffer_len);
-         NLMSG_NEXT (hdr, buffer_len)) {
+         hdr = NLMSG_NEXT (hdr, buffer_len)) {
         Transaction     *tr;
         struct nlmsgerr *err;
 
-        if (hdr->nlmsg_type != NLMSG_ERROR)
+        if (hdr->nlmsg_type != NLMSG_ERROR && hdr->nlmsg_type != RTM_NEWLINK)
             continue;
 
         tr = g_hash_table_lookup (self->transactions,
@@ -365,7 +486,14 @@ netlink_message_cb (GSocket      *socket,
         if (!tr)
             continue;
 
-        err = NLMSG_DATA (buf);
+        /* Link info replies come before the ACK */
+        if (hdr->nlmsg_type == RTM_NEWLINK) {
+            if (tr->link_stats)
+                process_newlink (tr, hdr);
+            continue;
+        }
+
+        err = NLMSG_DATA (hdr);
         transaction_complete (tr, err->error);
     }
     return G_SOURCE_CONTINUE;
@@ -49,6 +49,17 @@ gboolean mm_netlink_setlink_finish (MMNetlink            *self,
                                     GAsyncResult         *res,
                                     GError              **error);
 
+void     mm_netlink_getlink_stats        (MMNetlink           *self,
+                                          guint                ifindex,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             user_data);
+gboolean mm_netlink_getlink_stats_finish (MMNetlink            *self,
+                                          GAsyncResult         *res,
+                                          guint64              *rx_bytes,
+                                          guint64              *tx_bytes,
+                                          GError              **error);
+
 G_END_DECLS
 
 #endif  /* MM_MODEM_HELPERS_NETLINK_H */
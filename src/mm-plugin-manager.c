@@ -32,6 +32,7 @@
 #include "mm-shared.h"
 #include "mm-utils.h"
 #include "mm-log-object.h"
+#include "mm-identity-cache.h"
 
 #define SHARED_PREFIX "libmm-shared"
 #define PLUGIN_PREFIX "libmm-plugin"
@@ -775,6 +776,15 @@ struct _DeviceContext {
      * is reset to 0. */
     guint extra_probing_time_id;
 
+    /* Masks of USB interfaces with ports already grabbed, used to detect when
+     * all the ports expected in the device are available, so that there is no
+     * need to wait for the probing timeouts. */
+    guint64  grabbed_interfaces;
+    guint64  grabbed_interfaces_net;
+    guint64  grabbed_interfaces_wdm;
+    guint64  grabbed_interfaces_dual;
+    gboolean all_ports_grabbed;
+
     /* Signal connection ids for the grabbed/released signals from the device.
      * These are the signals that will give us notifications of what ports are
      * available (or suddenly unavailable) in the device. */
@@ -862,6 +872,29 @@ device_context_run_finish (MMPluginManager  *self,
     return MM_PLUGIN (g_task_propagate_pointer (G_TASK (res), error));
 }
 
+static void
+device_context_update_probe_cache (MMPluginManager *self,
+                                   DeviceContext   *device_context)
+{
+    GList *l;
+
+    /* Keep the probing results only if the device was supported, so that
+     * a failed detection is always fully retried. */
+    for (l = mm_device_peek_port_probe_list (device_context->device); l; l = g_list_next (l)) {
+        MMPortProbe *probe = MM_PORT_PROBE (l->data);
+
+        if (mm_port_probe_is_from_cache (probe))
+            mm_obj_dbg (self, "task %s: port %s probing results reused from cache",
+                        device_context->name, mm_port_probe_get_port_name (probe));
+
+        if (device_context->best_plugin)
+            mm_port_probe_cache_store (probe);
+        else
+            mm_port_probe_cache_invalidate (probe);
+    }
+    mm_identity_cache_flush ();
+}
+
 static void
 device_context_complete (DeviceContext *device_context)
 {
@@ -909,6 +942,8 @@ device_context_complete (DeviceContext *device_context)
     /* On completion, the minimum wait time must have been already elapsed */
     g_assert (!device_context->min_wait_time_id);
 
+    device_context_update_probe_cache (self, device_context);
+
     /* Task completion */
     if (!device_context->best_plugin)
         g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED,
@@ -1266,6 +1301,87 @@ device_context_port_released (DeviceContext  *device_context,
                 device_context->name, mm_kernel_device_get_name (port));
 }
 
+/* Drivers exposing both a net port and a cdc-wdm port in the same interface */
+static const gchar *dual_port_drivers[] = { "qmi_wwan", "cdc_mbim", "huawei_cdc_ncm" };
+
+static void
+device_context_track_grabbed_port (DeviceContext  *device_context,
+                                   MMKernelDevice *port)
+{
+    const gchar *driver;
+    const gchar *subsystem;
+    gint         interface_number;
+    guint64      bit;
+    guint        i;
+
+    interface_number = mm_kernel_device_get_interface_number (port);
+    if (interface_number < 0 || interface_number >= 64)
+        return;
+
+    bit = ((guint64) 1 << interface_number);
+    device_context->grabbed_interfaces |= bit;
+
+    subsystem = mm_kernel_device_get_subsystem (port);
+    if (g_strcmp0 (subsystem, "net") == 0)
+        device_context->grabbed_interfaces_net |= bit;
+    else if (g_strcmp0 (subsystem, "usbmisc") == 0 || g_strcmp0 (subsystem, "usb") == 0)
+        device_context->grabbed_interfaces_wdm |= bit;
+
+    driver = mm_kernel_device_get_driver (port);
+    for (i = 0; driver && i < G_N_ELEMENTS (dual_port_drivers); i++) {
+        if (g_str_equal (driver, dual_port_drivers[i])) {
+            device_context->grabbed_interfaces_dual |= bit;
+            break;
+        }
+    }
+}
+
+static void
+device_context_check_all_ports_grabbed (DeviceContext  *device_context,
+                                        MMKernelDevice *port)
+{
+    MMPluginManager *self;
+    guint64          expected = 0;
+    guint64          grabbed;
+
+    if (device_context->all_ports_grabbed)
+        return;
+
+    /* If we cannot know which ports the device exposes, rely on the timeouts */
+    if (!mm_kernel_device_get_physdev_port_interfaces (port, &expected))
+        return;
+
+    grabbed = ((device_context->grabbed_interfaces & ~device_context->grabbed_interfaces_dual) |
+               (device_context->grabbed_interfaces_dual &
+                device_context->grabbed_interfaces_net &
+                device_context->grabbed_interfaces_wdm));
+    if ((grabbed & expected) != expected)
+        return;
+
+    self = MM_PLUGIN_MANAGER (device_context->self);
+    mm_obj_dbg (self, "task %s: all expected ports grabbed after '%lf' seconds",
+                device_context->name, g_timer_elapsed (device_context->timer, NULL));
+    device_context->all_ports_grabbed = TRUE;
+
+    /* No more ports are expected, so there is no need to wait for them */
+    if (device_context->min_probing_time_id) {
+        g_source_remove (device_context->min_probing_time_id);
+        device_context->min_probing_time_id = 0;
+    }
+    if (device_context->extra_probing_time_id) {
+        g_source_remove (device_context->extra_probing_time_id);
+        device_context->extra_probing_time_id = 0;
+    }
+    if (device_context->min_wait_time_id) {
+        g_source_remove (device_context->min_wait_time_id);
+        device_context_min_wait_time_elapsed (device_context);
+    }
+
+    /* If all ports were filtered, the device context may be completed already */
+    if (!device_context->port_contexts)
+        device_context_continue (device_context);
+}
+
 static void
 device_context_port_grabbed (DeviceContext  *device_context,
                              MMKernelDevice *port)
@@ -1295,12 +1411,16 @@ device_context_port_grabbed (DeviceContext  *device_context,
         return;
     }
 
-    /* Refresh the extra probing timeout. */
-    if (device_context->extra_probing_time_id)
-        g_source_remove (device_context->extra_probing_time_id);
-    device_context->extra_probing_time_id = g_timeout_add (EXTRA_PROBING_TIME_MSECS,
-                                                           (GSourceFunc) device_context_extra_probing_time_elapsed,
-                                                           device_context);
+    /* Refresh the extra probing timeout, unless all expected ports are
+     * already there. */
+    device_context_track_grabbed_port (device_context, port);
+    if (!device_context->all_ports_grabbed) {
+        if (device_context->extra_probing_time_id)
+            g_source_remove (device_context->extra_probing_time_id);
+        device_context->extra_probing_time_id = g_timeout_add (EXTRA_PROBING_TIME_MSECS,
+                                                               (GSourceFunc) device_context_extra_probing_time_elapsed,
+                                                               device_context);
+    }
 
     /* Setup a new port context for the newly grabbed port */
     port_context = port_context_new (self,
@@ -1317,15 +1437,16 @@ device_context_port_grabbed (DeviceContext  *device_context,
                     port_context->name);
         /* Store the port reference in the list within the device */
         device_context->wait_port_contexts = g_list_prepend (device_context->wait_port_contexts, port_context);
-        return;
-    }
+    } else {
+        /* Store the port reference in the list within the device */
+        device_context->port_contexts = g_list_prepend (device_context->port_contexts, port_context) ;
 
-    /* Store the port reference in the list within the device */
-    device_context->port_contexts = g_list_prepend (device_context->port_contexts, port_context) ;
+        /* If the port has been grabbed after the min wait timeout expired, launch
+         * probing directly */
+        device_context_run_port_context (device_context, port_context);
+    }
 
-    /* If the port has been grabbed after the min wait timeout expired, launch
-     * probing directly */
-    device_context_run_port_context (device_context, port_context);
+    device_context_check_all_ports_grabbed (device_context, port);
 }
 
 static gboolean
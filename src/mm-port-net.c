@@ -97,6 +97,73 @@ mm_port_net_link_setup (MMPortNet            *self,
 
 /*****************************************************************************/
 
+gboolean
+mm_port_net_reload_stats_finish (MMPortNet     *self,
+                                 GAsyncResult  *res,
+                                 guint64       *rx_bytes,
+                                 guint64       *tx_bytes,
+                                 GError       **error)
+{
+    guint64 *stats;
+
+    stats = g_task_propagate_pointer (G_TASK (res), error);
+    if (!stats)
+        return FALSE;
+
+    if (rx_bytes)
+        *rx_bytes = stats[0];
+    if (tx_bytes)
+        *tx_bytes = stats[1];
+    g_free (stats);
+    return TRUE;
+}
+
+static void
+netlink_getlink_stats_ready (MMNetlink    *netlink,
+                             GAsyncResult *res,
+                             GTask        *task)
+{
+    GError  *error = NULL;
+    guint64 *stats;
+
+    stats = g_new0 (guint64, 2);
+    if (!mm_netlink_getlink_stats_finish (netlink, res, &stats[0], &stats[1], &error)) {
+        g_prefix_error (&error, "netlink operation failed: ");
+        g_task_return_error (task, error);
+        g_free (stats);
+    } else
+        g_task_return_pointer (task, stats, g_free);
+    g_object_unref (task);
+}
+
+void
+mm_port_net_reload_stats (MMPortNet           *self,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+    GTask *task;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    ensure_ifindex (self);
+    if (!self->priv->ifindex) {
+        g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                                 "no valid interface index found for %s",
+                                 mm_port_get_device (MM_PORT (self)));
+        g_object_unref (task);
+        return;
+    }
+
+    mm_netlink_getlink_stats (mm_netlink_get (), /* singleton */
+                              self->priv->ifindex,
+                              cancellable,
+                              (GAsyncReadyCallback) netlink_getlink_stats_ready,
+                              task);
+}
+
+/*****************************************************************************/
+
 MMPortNet *
 mm_port_net_new (const gchar *name)
 {
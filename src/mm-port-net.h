@@ -60,4 +60,15 @@ gboolean mm_port_net_link_setup_finish (MMPortNet            *self,
                                         GAsyncResult         *res,
                                         GError              **error);
 
+/* Kernel rx/tx byte counters of the interface */
+void     mm_port_net_reload_stats        (MMPortNet            *self,
+                                          GCancellable         *cancellable,
+                                          GAsyncReadyCallback   callback,
+                                          gpointer              user_data);
+gboolean mm_port_net_reload_stats_finish (MMPortNet            *self,
+                                          GAsyncResult         *res,
+                                          guint64              *rx_bytes,
+                                          guint64              *tx_bytes,
+                                          GError              **error);
+
 #endif /* MM_PORT_NET_H */
@@ -37,6 +37,7 @@
 #include "libqcdm/src/errors.h"
 #include "mm-port-serial-qcdm.h"
 #include "mm-daemon-enums-types.h"
+#include "mm-identity-cache.h"
 
 #if defined WITH_QMI
 #include "mm-port-qmi.h"
@@ -108,6 +109,14 @@ struct _MMPortProbePrivate {
     gboolean maybe_qmi;
     gboolean maybe_mbim;
 
+    /* Probing results cache */
+    gboolean cache_checked;
+    gboolean from_cache;
+    gboolean custom_init_required;
+    /* Negative results only given because of timeouts or cancellations,
+     * never cached */
+    guint32  inconclusive;
+
     /* Current probing task. Only one can be available at a time */
     GTask *task;
 };
@@ -332,6 +341,239 @@ mm_port_probe_set_result_mbim (MMPortProbe *self,
         mm_obj_dbg (self, "port is not MBIM-capable");
 }
 
+/*****************************************************************************/
+/* Probing results cache.
+ *
+ * Results of a completed probing are stored in the identity cache, in the
+ * entry of the physical device, so that the same port doesn't need to be
+ * probed again e.g. after a USB reset. Ports are identified by subsystem,
+ * kernel driver and USB interface number (or by name, if not a USB port), so
+ * that a module switching its USB composition (e.g. from qmi_wwan to cdc_mbim
+ * in the same interface) doesn't reuse the results of the previous one. The
+ * entries are only reused if the vid, pid and USB revision of the device
+ * didn't change.
+ */
+
+#define PROBE_CACHE_KEY_PREFIX  "Probe"
+#define PROBE_CACHE_KEY_FLAGS   "Flags"
+#define PROBE_CACHE_KEY_RESULTS "Results"
+#define PROBE_CACHE_KEY_VENDOR  "Vendor"
+#define PROBE_CACHE_KEY_PRODUCT "Product"
+
+static gchar *
+port_probe_cache_build_key (MMPortProbe *self,
+                            const gchar *field)
+{
+    const gchar *driver;
+    gint         interface_number;
+
+    driver = mm_kernel_device_get_driver (self->priv->port);
+    interface_number = mm_kernel_device_get_interface_number (self->priv->port);
+    if (interface_number >= 0)
+        return g_strdup_printf (PROBE_CACHE_KEY_PREFIX ".%s.%s.if%02d.%s",
+                                mm_kernel_device_get_subsystem (self->priv->port),
+                                driver ? driver : "unknown",
+                                interface_number,
+                                field);
+    return g_strdup_printf (PROBE_CACHE_KEY_PREFIX ".%s.%s.%s.%s",
+                            mm_kernel_device_get_subsystem (self->priv->port),
+                            driver ? driver : "unknown",
+                            mm_kernel_device_get_name (self->priv->port),
+                            field);
+}
+
+static void
+port_probe_cache_remove (MMPortProbe *self)
+{
+    const gchar *device;
+    const gchar *fields[] = {
+        PROBE_CACHE_KEY_FLAGS,
+        PROBE_CACHE_KEY_RESULTS,
+        PROBE_CACHE_KEY_VENDOR,
+        PROBE_CACHE_KEY_PRODUCT,
+    };
+    guint        i;
+
+    device = mm_device_get_uid (self->priv->device);
+    for (i = 0; i < G_N_ELEMENTS (fields); i++) {
+        g_autofree gchar *key = NULL;
+
+        key = port_probe_cache_build_key (self, fields[i]);
+        mm_identity_cache_remove_key (device, key);
+    }
+}
+
+static gboolean
+port_probe_cache_device_outdated (MMPortProbe *self)
+{
+    const gchar *device;
+    guint        value;
+
+    device = mm_device_get_uid (self->priv->device);
+    return ((mm_identity_cache_get_uint (device, MM_IDENTITY_CACHE_KEY_VENDOR_ID, &value) &&
+             value != mm_device_get_vendor (self->priv->device)) ||
+            (mm_identity_cache_get_uint (device, MM_IDENTITY_CACHE_KEY_PRODUCT_ID, &value) &&
+             value != mm_device_get_product (self->priv->device)) ||
+            (mm_identity_cache_get_uint (device, MM_IDENTITY_CACHE_KEY_PHYSDEV_REVISION, &value) &&
+             value != mm_kernel_device_get_physdev_revision (self->priv->port)));
+}
+
+static void
+port_probe_cache_load (MMPortProbe *self)
+{
+    const gchar      *device;
+    g_autofree gchar *flags_key = NULL;
+    g_autofree gchar *results_key = NULL;
+    g_autofree gchar *flags_str = NULL;
+    guint             flags = 0;
+    guint             results = 0;
+
+    if (self->priv->cache_checked)
+        return;
+    self->priv->cache_checked = TRUE;
+
+    device = mm_device_get_uid (self->priv->device);
+    if (!mm_identity_cache_has_key (device, MM_IDENTITY_CACHE_KEY_PHYSDEV_REVISION))
+        return;
+
+    if (port_probe_cache_device_outdated (self)) {
+        mm_obj_dbg (self, "cached probing results are outdated");
+        port_probe_cache_remove (self);
+        return;
+    }
+
+    flags_key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_FLAGS);
+    results_key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_RESULTS);
+    if (!mm_identity_cache_get_uint (device, flags_key, &flags) ||
+        !mm_identity_cache_get_uint (device, results_key, &results))
+        return;
+
+    /* Never override results already available */
+    flags &= ~self->priv->flags;
+    if (!flags)
+        return;
+
+    if (flags & MM_PORT_PROBE_AT)
+        self->priv->is_at = !!(results & MM_PORT_PROBE_AT);
+    if (flags & MM_PORT_PROBE_AT_VENDOR) {
+        g_autofree gchar *key = NULL;
+
+        key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_VENDOR);
+        g_free (self->priv->vendor);
+        self->priv->vendor = mm_identity_cache_get_string (device, key);
+    }
+    if (flags & MM_PORT_PROBE_AT_PRODUCT) {
+        g_autofree gchar *key = NULL;
+
+        key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_PRODUCT);
+        g_free (self->priv->product);
+        self->priv->product = mm_identity_cache_get_string (device, key);
+    }
+    if (flags & MM_PORT_PROBE_AT_ICERA)
+        self->priv->is_icera = !!(results & MM_PORT_PROBE_AT_ICERA);
+    if (flags & MM_PORT_PROBE_AT_XMM)
+        self->priv->is_xmm = !!(results & MM_PORT_PROBE_AT_XMM);
+    if (flags & MM_PORT_PROBE_QCDM)
+        self->priv->is_qcdm = !!(results & MM_PORT_PROBE_QCDM);
+    if (flags & MM_PORT_PROBE_QMI)
+        self->priv->is_qmi = !!(results & MM_PORT_PROBE_QMI);
+    if (flags & MM_PORT_PROBE_MBIM)
+        self->priv->is_mbim = !!(results & MM_PORT_PROBE_MBIM);
+
+    self->priv->flags |= flags;
+    self->priv->from_cache = TRUE;
+
+    flags_str = mm_port_probe_flag_build_string_from_mask (flags);
+    mm_obj_dbg (self, "probing results loaded from cache: '%s'", flags_str);
+}
+
+void
+mm_port_probe_cache_store (MMPortProbe *self)
+{
+    const gchar      *device;
+    g_autofree gchar *flags_key = NULL;
+    g_autofree gchar *results_key = NULL;
+    g_autofree gchar *vendor_key = NULL;
+    g_autofree gchar *product_key = NULL;
+    guint32           flags;
+    guint             results = 0;
+
+    g_return_if_fail (MM_IS_PORT_PROBE (self));
+
+    if (!mm_identity_cache_is_enabled ())
+        return;
+
+    /* Results obtained with a plugin-specific custom initialization are
+     * never cached, as the initialization may have side effects that would
+     * be lost if skipped. Results not obtained from a real reply of the
+     * port (e.g. probing timed out) are not cached either, so that they're
+     * retried next time. */
+    flags = self->priv->flags & ~self->priv->inconclusive;
+    if (self->priv->is_ignored ||
+        self->priv->custom_init_required ||
+        !flags ||
+        !mm_device_get_vendor (self->priv->device) ||
+        !mm_device_get_product (self->priv->device)) {
+        mm_port_probe_cache_invalidate (self);
+        return;
+    }
+
+    device = mm_device_get_uid (self->priv->device);
+    if (port_probe_cache_device_outdated (self)) {
+        mm_obj_dbg (self, "removing outdated cached info of the device");
+        mm_identity_cache_remove_device (device);
+    }
+
+    mm_identity_cache_set_uint (device, MM_IDENTITY_CACHE_KEY_VENDOR_ID, mm_device_get_vendor (self->priv->device));
+    mm_identity_cache_set_uint (device, MM_IDENTITY_CACHE_KEY_PRODUCT_ID, mm_device_get_product (self->priv->device));
+    mm_identity_cache_set_uint (device, MM_IDENTITY_CACHE_KEY_PHYSDEV_REVISION, mm_kernel_device_get_physdev_revision (self->priv->port));
+
+    if (self->priv->is_at)
+        results |= MM_PORT_PROBE_AT;
+    if (self->priv->is_icera)
+        results |= MM_PORT_PROBE_AT_ICERA;
+    if (self->priv->is_xmm)
+        results |= MM_PORT_PROBE_AT_XMM;
+    if (self->priv->is_qcdm)
+        results |= MM_PORT_PROBE_QCDM;
+    if (self->priv->is_qmi)
+        results |= MM_PORT_PROBE_QMI;
+    if (self->priv->is_mbim)
+        results |= MM_PORT_PROBE_MBIM;
+
+    flags_key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_FLAGS);
+    results_key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_RESULTS);
+    vendor_key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_VENDOR);
+    product_key = port_probe_cache_build_key (self, PROBE_CACHE_KEY_PRODUCT);
+    mm_identity_cache_set_uint   (device, flags_key,   flags);
+    mm_identity_cache_set_uint   (device, results_key, results);
+    mm_identity_cache_set_string (device, vendor_key,  self->priv->vendor);
+    mm_identity_cache_set_string (device, product_key, self->priv->product);
+}
+
+void
+mm_port_probe_cache_invalidate (MMPortProbe *self)
+{
+    g_return_if_fail (MM_IS_PORT_PROBE (self));
+
+    port_probe_cache_remove (self);
+}
+
+void
+mm_port_probe_cache_clear (void)
+{
+    mm_identity_cache_remove_keys_with_prefix (PROBE_CACHE_KEY_PREFIX ".");
+    mm_identity_cache_flush ();
+}
+
+gboolean
+mm_port_probe_is_from_cache (MMPortProbe *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), FALSE);
+
+    return self->priv->from_cache;
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -365,6 +607,8 @@ typedef struct {
     const MMPortProbeAtCommand *at_custom_probe;
     /* Current group of AT commands to be sent */
     const MMPortProbeAtCommand *at_commands;
+    /* Whether any command in the current group timed out */
+    gboolean at_commands_timed_out;
     /* Seconds between each AT command sent in the group */
     guint at_commands_wait_secs;
     /* Current AT Result processor */
@@ -664,6 +908,11 @@ common_serial_port_setup (MMPortProbe  *self,
                           NULL);
         }
     }
+
+    if (mm_kernel_device_has_property (self->priv->port, ID_MM_TTY_SEND_CHUNK_SIZE))
+        g_object_set (serial,
+                      MM_PORT_SERIAL_SEND_CHUNK_SIZE, (guint) mm_kernel_device_get_property_as_int (self->priv->port, ID_MM_TTY_SEND_CHUNK_SIZE),
+                      NULL);
 }
 
 /***************************************************************/
@@ -678,6 +927,7 @@ serial_probe_qcdm_parse_response (MMPortSerialQcdm *port,
     gint                 err = QCDM_SUCCESS;
     gboolean             is_qcdm = FALSE;
     gboolean             retry = FALSE;
+    gboolean             timed_out = FALSE;
     GError              *error = NULL;
     GByteArray          *response;
     PortProbeRunContext *ctx;
@@ -708,6 +958,8 @@ serial_probe_qcdm_parse_response (MMPortSerialQcdm *port,
     } else {
         if (!g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT))
             mm_obj_dbg (self, "QCDM probe error: (%d) %s", error->code, error->message);
+        else
+            timed_out = TRUE;
         g_error_free (error);
         retry = TRUE;
     }
@@ -730,8 +982,10 @@ serial_probe_qcdm_parse_response (MMPortSerialQcdm *port,
         /* no more retries left */
     }
 
-    /* Set probing result */
+    /* Set probing result; not conclusive if the last try timed out */
     mm_port_probe_set_result_qcdm (self, is_qcdm);
+    if (timed_out)
+        self->priv->inconclusive |= MM_PORT_PROBE_QCDM;
     /* Reschedule probing */
     serial_probe_schedule (self);
 }
@@ -968,6 +1222,24 @@ serial_probe_at_result_processor (MMPortProbe *self,
     mm_port_probe_set_result_at (self, FALSE);
 }
 
+/* Ends the current AT probing group without result; unless it was a
+ * definitive one (e.g. the port already flagged as non-AT because of the
+ * data received), it won't be cached */
+static void
+serial_probe_at_no_result (MMPortProbe *self,
+                           gboolean     inconclusive)
+{
+    PortProbeRunContext *ctx;
+    guint32              flags_before;
+
+    ctx = g_task_get_task_data (self->priv->task);
+
+    flags_before = self->priv->flags;
+    ctx->at_result_processor (self, NULL);
+    if (inconclusive)
+        self->priv->inconclusive |= (self->priv->flags & ~flags_before);
+}
+
 static void
 serial_probe_at_parse_response (MMPortSerialAt *port,
                                 GAsyncResult   *res,
@@ -989,12 +1261,14 @@ serial_probe_at_parse_response (MMPortSerialAt *port,
     /* If AT probing cancelled, end this partial probing */
     if (g_cancellable_is_cancelled (ctx->at_probing_cancellable)) {
         mm_obj_dbg (self, "no need to keep on probing the port for AT support");
-        ctx->at_result_processor (self, NULL);
+        serial_probe_at_no_result (self, TRUE);
         serial_probe_schedule (self);
         return;
     }
 
     response = mm_port_serial_at_command_finish (port, res, &error);
+    if (g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT))
+        ctx->at_commands_timed_out = TRUE;
 
     if (!ctx->at_commands->response_processor (ctx->at_commands->command,
                                                response,
@@ -1018,8 +1292,9 @@ serial_probe_at_parse_response (MMPortSerialAt *port,
         ctx->at_commands++;
         if (!ctx->at_commands->command) {
             /* Was it the last command in the group? If so,
-             * end this partial probing */
-            ctx->at_result_processor (self, NULL);
+             * end this partial probing. If there was no reply at all
+             * to some of the commands, the result is not conclusive. */
+            serial_probe_at_no_result (self, ctx->at_commands_timed_out);
             /* Reschedule */
             serial_probe_schedule (self);
             goto out;
@@ -1065,7 +1340,7 @@ serial_probe_at (MMPortProbe *self)
     /* If AT probing cancelled, end this partial probing */
     if (g_cancellable_is_cancelled (ctx->at_probing_cancellable)) {
         mm_obj_dbg (self, "no need to launch probing for AT support");
-        ctx->at_result_processor (self, NULL);
+        serial_probe_at_no_result (self, TRUE);
         serial_probe_schedule (self);
         return G_SOURCE_REMOVE;
     }
@@ -1170,6 +1445,7 @@ serial_probe_schedule (MMPortProbe *self)
     ctx->at_result_processor   = NULL;
     ctx->at_commands           = NULL;
     ctx->at_commands_wait_secs = 0;
+    ctx->at_commands_timed_out = FALSE;
 
     /* AT check requested and not already probed? */
     if ((ctx->flags & MM_PORT_PROBE_AT) &&
@@ -1462,6 +1738,13 @@ mm_port_probe_run (MMPortProbe                *self,
         return;
     }
 
+    /* Reuse the results of a previous probing of the same port, unless a
+     * custom initialization is required */
+    if (ctx->at_custom_init)
+        self->priv->custom_init_required = TRUE;
+    else
+        port_probe_cache_load (self);
+
     /* If this is a port flagged as a GPS port, don't do any other probing */
     if (self->priv->is_gps) {
         mm_obj_dbg (self, "GPS port detected");
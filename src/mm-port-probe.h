@@ -138,6 +138,12 @@ gboolean      mm_port_probe_is_icera         (MMPortProbe *self);
 gboolean      mm_port_probe_is_xmm           (MMPortProbe *self);
 gboolean      mm_port_probe_is_ignored       (MMPortProbe *self);
 
+/* Probing results cache */
+void     mm_port_probe_cache_store      (MMPortProbe *self);
+void     mm_port_probe_cache_invalidate (MMPortProbe *self);
+void     mm_port_probe_cache_clear      (void);
+gboolean mm_port_probe_is_from_cache    (MMPortProbe *self);
+
 /* Additional helpers */
 gboolean mm_port_probe_list_has_at_port   (GList *list);
 gboolean mm_port_probe_list_has_qmi_port  (GList *list);
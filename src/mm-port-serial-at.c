@@ -26,6 +26,8 @@
 
 G_DEFINE_TYPE (MMPortSerialAt, mm_port_serial_at, MM_TYPE_PORT_SERIAL)
 
+typedef struct _UrcTrieNode UrcTrieNode;
+
 enum {
     PROP_0,
     PROP_REMOVE_ECHO,
@@ -43,6 +45,13 @@ struct _MMPortSerialAtPrivate {
 
     GSList *unsolicited_msg_handlers;
 
+    /* Unsolicited message dispatcher */
+    UrcTrieNode *urc_trie;
+    gboolean     urc_trie_outdated;
+    guint8       urc_trie_first_bytes[256];
+    guint        urc_dispatch_serial;
+    GArray      *urc_spans;
+
     MMPortSerialAtFlag flags;
 
     /* Properties */
@@ -176,6 +185,14 @@ typedef struct {
     gboolean enable;
     gpointer user_data;
     GDestroyNotify notify;
+    /* Literal that must be found in the response for the regex to match,
+     * or NULL if the regex needs to be always run */
+    gchar *key;
+    guint  candidate_serial;
+    /* Debugging counters */
+    guint  n_evaluated;
+    guint  n_skipped;
+    guint  n_hits;
 } MMAtUnsolicitedMsgHandler;
 
 static gint
@@ -186,6 +203,217 @@ unsolicited_msg_handler_cmp (MMAtUnsolicitedMsgHandler *handler,
                       g_regex_get_pattern (regex));
 }
 
+static void
+unsolicited_msg_handler_free (MMAtUnsolicitedMsgHandler *handler)
+{
+    if (handler->notify)
+        handler->notify (handler->user_data);
+    g_regex_unref (handler->regex);
+    g_free (handler->key);
+    g_slice_free (MMAtUnsolicitedMsgHandler, handler);
+}
+
+/* Build the longest literal that any match of the regex must start with.
+ * This is a conservative parser of the pattern: as soon as something that
+ * isn't a plain literal is found, the literal is cut. */
+gchar *
+mm_port_serial_at_get_regex_literal_prefix (GRegex *regex)
+{
+    const gchar *pattern;
+    const gchar *p;
+    GString     *prefix;
+    guint        depth = 0;
+    gboolean     in_class = FALSE;
+
+    /* Case-insensitive and extended patterns don't match their literals */
+    if (g_regex_get_compile_flags (regex) & (G_REGEX_CASELESS | G_REGEX_EXTENDED))
+        return NULL;
+
+    pattern = g_regex_get_pattern (regex);
+
+    /* A top-level alternation would make the prefix optional */
+    for (p = pattern; *p; p++) {
+        if (*p == '\\') {
+            if (!p[1])
+                break;
+            p++;
+        } else if (in_class) {
+            if (*p == ']')
+                in_class = FALSE;
+        } else if (*p == '[') {
+            in_class = TRUE;
+            /* A closing bracket right at the start is a literal */
+            if (p[1] == '^')
+                p++;
+            if (p[1] == ']')
+                p++;
+        } else if (*p == '(')
+            depth++;
+        else if (*p == ')' && depth > 0)
+            depth--;
+        else if (*p == '|' && depth == 0)
+            return NULL;
+    }
+
+    prefix = g_string_new (NULL);
+    p = pattern;
+    if (*p == '^')
+        p++;
+
+    while (*p) {
+        gchar c;
+
+        if (*p == '\\') {
+            if (!p[1])
+                break;
+            if (p[1] == 'r')
+                c = '\r';
+            else if (p[1] == 'n')
+                c = '\n';
+            else if (p[1] == 't')
+                c = '\t';
+            else if (g_ascii_isalnum (p[1]))
+                break;
+            else
+                c = p[1];
+            p += 2;
+        } else if (strchr (".[]()*+?{}|^$", *p))
+            break;
+        else
+            c = *p++;
+
+        /* Quantifiers making the last literal optional */
+        if (*p == '?' || *p == '*' || *p == '{')
+            break;
+
+        g_string_append_c (prefix, c);
+    }
+
+    if (!prefix->len) {
+        g_string_free (prefix, TRUE);
+        return NULL;
+    }
+    return g_string_free (prefix, FALSE);
+}
+
+/*****************************************************************************/
+/* Unsolicited message dispatcher
+ *
+ * All literal prefixes of the handler regexes are stored in a trie, which is
+ * used to find in a single pass over the response which handlers may match
+ * it. Only the regexes of those handlers, plus the ones without a literal
+ * prefix, are then run. */
+
+struct _UrcTrieNode {
+    guint8       byte;
+    UrcTrieNode *child;
+    UrcTrieNode *sibling;
+    GSList      *handlers;
+};
+
+static void
+urc_trie_free (UrcTrieNode *node)
+{
+    while (node) {
+        UrcTrieNode *sibling;
+
+        sibling = node->sibling;
+        urc_trie_free (node->child);
+        g_slist_free (node->handlers);
+        g_slice_free (UrcTrieNode, node);
+        node = sibling;
+    }
+}
+
+static UrcTrieNode *
+urc_trie_find_child (UrcTrieNode *node,
+                     guint8       byte)
+{
+    for (node = node->child; node; node = node->sibling) {
+        if (node->byte == byte)
+            return node;
+    }
+    return NULL;
+}
+
+static void
+urc_trie_insert (UrcTrieNode               *root,
+                 MMAtUnsolicitedMsgHandler *handler)
+{
+    UrcTrieNode  *node = root;
+    const guint8 *key;
+
+    for (key = (const guint8 *) handler->key; *key; key++) {
+        UrcTrieNode *child;
+
+        child = urc_trie_find_child (node, *key);
+        if (!child) {
+            child = g_slice_new0 (UrcTrieNode);
+            child->byte = *key;
+            child->sibling = node->child;
+            node->child = child;
+        }
+        node = child;
+    }
+    node->handlers = g_slist_prepend (node->handlers, handler);
+}
+
+static void
+urc_trie_rebuild (MMPortSerialAt *self)
+{
+    GSList *l;
+
+    if (self->priv->urc_trie)
+        urc_trie_free (self->priv->urc_trie);
+    self->priv->urc_trie = g_slice_new0 (UrcTrieNode);
+    memset (self->priv->urc_trie_first_bytes, 0, sizeof (self->priv->urc_trie_first_bytes));
+
+    for (l = self->priv->unsolicited_msg_handlers; l; l = g_slist_next (l)) {
+        MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) l->data;
+
+        if (!handler->key)
+            continue;
+        urc_trie_insert (self->priv->urc_trie, handler);
+        self->priv->urc_trie_first_bytes[(guint8) handler->key[0]] = TRUE;
+    }
+
+    self->priv->urc_trie_outdated = FALSE;
+}
+
+/* Flag all handlers whose literal prefix is found in the response */
+static void
+urc_trie_mark_candidates (MMPortSerialAt   *self,
+                          const GByteArray *response)
+{
+    guint i;
+
+    if (self->priv->urc_trie_outdated)
+        urc_trie_rebuild (self);
+
+    self->priv->urc_dispatch_serial++;
+
+    for (i = 0; i < response->len; i++) {
+        UrcTrieNode *node;
+        guint        j;
+
+        if (!self->priv->urc_trie_first_bytes[response->data[i]])
+            continue;
+
+        node = urc_trie_find_child (self->priv->urc_trie, response->data[i]);
+        for (j = i; node; ) {
+            GSList *l;
+
+            for (l = node->handlers; l; l = g_slist_next (l))
+                ((MMAtUnsolicitedMsgHandler *) l->data)->candidate_serial = self->priv->urc_dispatch_serial;
+            if (++j == response->len)
+                break;
+            node = urc_trie_find_child (node, response->data[j]);
+        }
+    }
+}
+
+/*****************************************************************************/
+
 void
 mm_port_serial_at_add_unsolicited_msg_handler (MMPortSerialAt *self,
                                                GRegex *regex,
@@ -211,9 +439,11 @@ mm_port_serial_at_add_unsolicited_msg_handler (MMPortSerialAt *self,
         /* The new handler is always PREPENDED, so that e.g. plugins can provide
          * more specific matches for URCs that are also handled by the generic
          * plugin. */
-        handler = g_slice_new (MMAtUnsolicitedMsgHandler);
+        handler = g_slice_new0 (MMAtUnsolicitedMsgHandler);
         handler->regex = g_regex_ref (regex);
+        handler->key = mm_port_serial_at_get_regex_literal_prefix (regex);
         self->priv->unsolicited_msg_handlers = g_slist_prepend (self->priv->unsolicited_msg_handlers, handler);
+        self->priv->urc_trie_outdated = TRUE;
     }
 
     handler->callback = callback;
@@ -242,19 +472,77 @@ mm_port_serial_at_enable_unsolicited_msg_handler (MMPortSerialAt *self,
     }
 }
 
-static gboolean
-remove_eval_cb (const GMatchInfo *match_info,
-                GString *result,
-                gpointer user_data)
+gboolean
+mm_port_serial_at_get_unsolicited_msg_handler_stats (MMPortSerialAt *self,
+                                                     GRegex         *regex,
+                                                     guint          *n_evaluated,
+                                                     guint          *n_skipped,
+                                                     guint          *n_hits)
+{
+    GSList *existing;
+    MMAtUnsolicitedMsgHandler *handler;
+
+    g_return_val_if_fail (MM_IS_PORT_SERIAL_AT (self), FALSE);
+    g_return_val_if_fail (regex != NULL, FALSE);
+
+    existing = g_slist_find_custom (self->priv->unsolicited_msg_handlers,
+                                    regex,
+                                    (GCompareFunc)unsolicited_msg_handler_cmp);
+    if (!existing)
+        return FALSE;
+
+    handler = existing->data;
+    if (n_evaluated)
+        *n_evaluated = handler->n_evaluated;
+    if (n_skipped)
+        *n_skipped = handler->n_skipped;
+    if (n_hits)
+        *n_hits = handler->n_hits;
+    return TRUE;
+}
+
+static void
+log_unsolicited_msg_handler_stats (MMPortSerialAt *self)
 {
-    int *result_len = (int *) user_data;
-    int start;
-    int end;
+    GSList *l;
 
-    if (g_match_info_fetch_pos  (match_info, 0, &start, &end))
-        *result_len -= (end - start);
+    for (l = self->priv->unsolicited_msg_handlers; l; l = g_slist_next (l)) {
+        MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) l->data;
 
-    return FALSE;
+        if (!handler->n_evaluated && !handler->n_skipped)
+            continue;
+        mm_obj_dbg (self, "unsolicited message handler '%s': %u hits, %u evaluated, %u skipped",
+                    g_regex_get_pattern (handler->regex),
+                    handler->n_hits, handler->n_evaluated, handler->n_skipped);
+    }
+}
+
+typedef struct {
+    gint start;
+    gint end;
+} ResponseSpan;
+
+/* Remove all the given spans from the response, without reallocating it */
+static void
+response_remove_spans (GByteArray *response,
+                       GArray     *spans)
+{
+    guint i;
+    guint dest;
+
+    dest = (guint) g_array_index (spans, ResponseSpan, 0).start;
+    for (i = 0; i < spans->len; i++) {
+        ResponseSpan *span;
+        guint         next_start;
+
+        span = &g_array_index (spans, ResponseSpan, i);
+        next_start = ((i + 1 < spans->len) ?
+                      (guint) g_array_index (spans, ResponseSpan, i + 1).start :
+                      response->len);
+        memmove (response->data + dest, response->data + span->end, next_start - span->end);
+        dest += next_start - span->end;
+    }
+    g_byte_array_set_size (response, dest);
 }
 
 static void
@@ -262,6 +550,7 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
     GSList *iter;
+    gboolean candidates_outdated = TRUE;
 
     /* Remove echo */
     if (self->priv->remove_echo)
@@ -275,33 +564,45 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
         if (!handler->enable)
             continue;
 
+        /* Skip the regex if the literal it requires isn't in the response */
+        if (handler->key) {
+            if (candidates_outdated) {
+                urc_trie_mark_candidates (self, response);
+                candidates_outdated = FALSE;
+            }
+            if (handler->candidate_serial != self->priv->urc_dispatch_serial) {
+                handler->n_skipped++;
+                continue;
+            }
+        }
+
+        handler->n_evaluated++;
         matches = g_regex_match_full (handler->regex,
                                       (const char *) response->data,
                                       response->len,
                                       0, 0, &match_info, NULL);
-        if (handler->callback) {
-            while (g_match_info_matches (match_info)) {
-                handler->callback (self, match_info, handler->user_data);
-                g_match_info_next (match_info, NULL);
-            }
+        if (!matches) {
+            g_match_info_free (match_info);
+            continue;
         }
 
-        g_match_info_free (match_info);
-
-        if (matches) {
-            /* Remove matches */
-            char *str;
-            int result_len = response->len;
+        g_array_set_size (self->priv->urc_spans, 0);
+        while (g_match_info_matches (match_info)) {
+            ResponseSpan span;
 
-            str = g_regex_replace_eval (handler->regex,
-                                        (const char *) response->data,
-                                        response->len,
-                                        0, 0,
-                                        remove_eval_cb, &result_len, NULL);
+            handler->n_hits++;
+            if (handler->callback)
+                handler->callback (self, match_info, handler->user_data);
+            if (g_match_info_fetch_pos (match_info, 0, &span.start, &span.end) && span.end > span.start)
+                g_array_append_val (self->priv->urc_spans, span);
+            g_match_info_next (match_info, NULL);
+        }
+        g_match_info_free (match_info);
 
-            g_byte_array_remove_range (response, 0, response->len);
-            g_byte_array_append (response, (const guint8 *) str, result_len);
-            g_free (str);
+        /* Remove matches */
+        if (self->priv->urc_spans->len > 0) {
+            response_remove_spans (response, self->priv->urc_spans);
+            candidates_outdated = TRUE;
         }
     }
 }
@@ -551,6 +852,8 @@ mm_port_serial_at_init (MMPortSerialAt *self)
 
     /* By default, don't send line feed */
     self->priv->send_lf = FALSE;
+
+    self->priv->urc_spans = g_array_new (FALSE, FALSE, sizeof (ResponseSpan));
 }
 
 static void
@@ -613,17 +916,13 @@ finalize (GObject *object)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (object);
 
-    while (self->priv->unsolicited_msg_handlers) {
-        MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) self->priv->unsolicited_msg_handlers->data;
+    log_unsolicited_msg_handler_stats (self);
 
-        if (handler->notify)
-            handler->notify (handler->user_data);
+    if (self->priv->urc_trie)
+        urc_trie_free (self->priv->urc_trie);
+    g_array_unref (self->priv->urc_spans);
 
-        g_regex_unref (handler->regex);
-        g_slice_free (MMAtUnsolicitedMsgHandler, handler);
-        self->priv->unsolicited_msg_handlers = g_slist_delete_link (self->priv->unsolicited_msg_handlers,
-                                                                    self->priv->unsolicited_msg_handlers);
-    }
+    g_slist_free_full (self->priv->unsolicited_msg_handlers, (GDestroyNotify) unsolicited_msg_handler_free);
 
     if (self->priv->response_parser_notify)
         self->priv->response_parser_notify (self->priv->response_parser_user_data);
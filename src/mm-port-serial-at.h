@@ -95,6 +95,12 @@ void     mm_port_serial_at_enable_unsolicited_msg_handler (MMPortSerialAt *self,
                                                            GRegex *regex,
                                                            gboolean enable);
 
+gboolean mm_port_serial_at_get_unsolicited_msg_handler_stats (MMPortSerialAt *self,
+                                                              GRegex         *regex,
+                                                              guint          *n_evaluated,
+                                                              guint          *n_skipped,
+                                                              guint          *n_hits);
+
 void     mm_port_serial_at_set_response_parser (MMPortSerialAt *self,
                                                 MMPortSerialAtResponseParserFn fn,
                                                 gpointer user_data,
@@ -120,6 +126,7 @@ gchar   *mm_port_serial_at_quote_string (const char *string);
 
 /* Just for unit tests */
 void     mm_port_serial_at_remove_echo (GByteArray *response);
+gchar   *mm_port_serial_at_get_regex_literal_prefix (GRegex *regex);
 
 void     mm_port_serial_at_set_flags (MMPortSerialAt *self,
                                       MMPortSerialAtFlag flags);
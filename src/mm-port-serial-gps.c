@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "mm-port-serial-gps.h"
+#include "mm-modem-helpers.h"
 #include "mm-log-object.h"
 
 G_DEFINE_TYPE (MMPortSerialGps, mm_port_serial_gps, MM_TYPE_PORT_SERIAL)
@@ -28,9 +29,6 @@ struct _MMPortSerialGpsPrivate {
     MMPortSerialGpsTraceFn callback;
     gpointer user_data;
     GDestroyNotify notify;
-
-    /* Regex for all known traces */
-    GRegex *known_traces_regex;
 };
 
 /*****************************************************************************/
@@ -53,19 +51,11 @@ mm_port_serial_gps_add_trace_handler (MMPortSerialGps *self,
 
 /*****************************************************************************/
 
-static gboolean
-remove_eval_cb (const GMatchInfo *match_info,
-                GString *result,
-                gpointer user_data)
+static void
+nmea_sentence_cb (const gchar     *sentence,
+                  MMPortSerialGps *self)
 {
-    int *result_len = (int *) user_data;
-    int start;
-    int end;
-
-    if (g_match_info_fetch_pos  (match_info, 0, &start, &end))
-        *result_len -= (end - start);
-
-    return FALSE;
+    self->priv->callback (self, sentence, self->priv->user_data);
 }
 
 static MMPortSerialResponseType
@@ -75,10 +65,8 @@ parse_response (MMPortSerial *port,
                 GError **error)
 {
     MMPortSerialGps *self = MM_PORT_SERIAL_GPS (port);
-    gboolean matches;
-    GMatchInfo *match_info;
-    gchar *str;
-    gint result_len;
+    GByteArray *other;
+    guint n_sentences;
     guint i;
 
     for (i = 0; i < response->len; i++) {
@@ -92,44 +80,21 @@ parse_response (MMPortSerial *port,
         }
     }
 
-    matches = g_regex_match_full (self->priv->known_traces_regex,
-                                  (const gchar *) response->data,
-                                  response->len,
-                                  0, 0, &match_info, NULL);
-
-    if (self->priv->callback) {
-        while (g_match_info_matches (match_info)) {
-            gchar *trace;
-
-            trace = g_match_info_fetch (match_info, 0);
-            if (trace) {
-                self->priv->callback (self, trace, self->priv->user_data);
-                g_free (trace);
-            }
-            g_match_info_next (match_info, NULL);
-        }
-    }
-
-    g_match_info_free (match_info);
-
-    if (!matches)
+    /* Sentences are given to the trace handler directly from the response
+     * buffer; incomplete ones are kept in the buffer until the rest arrives */
+    other = g_byte_array_new ();
+    n_sentences = mm_nmea_parse_sentences (response,
+                                           other,
+                                           self->priv->callback ? (MMNmeaSentenceFn) nmea_sentence_cb : NULL,
+                                           self);
+    if (!n_sentences && !other->len) {
+        g_byte_array_unref (other);
         return MM_PORT_SERIAL_RESPONSE_NONE;
-
-    /* Remove matches */
-    result_len = response->len;
-    str = g_regex_replace_eval (self->priv->known_traces_regex,
-                                (const char *) response->data,
-                                response->len,
-                                0, 0,
-                                remove_eval_cb, &result_len, NULL);
-
-    /* Cleanup response buffer */
-    g_byte_array_remove_range (response, 0, response->len);
+    }
 
     /* Build parsed response */
-    *parsed_response = g_byte_array_new_take ((guint8 *)str, result_len);
-
-    return TRUE;
+    *parsed_response = other;
+    return MM_PORT_SERIAL_RESPONSE_BUFFER;
 }
 
 /*****************************************************************************/
@@ -186,13 +151,6 @@ mm_port_serial_gps_init (MMPortSerialGps *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_PORT_SERIAL_GPS,
                                               MMPortSerialGpsPrivate);
-
-    /* We'll assume that all traces start with the dollar sign and end with \r\n */
-    self->priv->known_traces_regex =
-        g_regex_new ("\\$.*\\r\\n",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                     0,
-                     NULL);
 }
 
 static void
@@ -203,8 +161,6 @@ finalize (GObject *object)
     if (self->priv->notify)
         self->priv->notify (self->priv->user_data);
 
-    g_regex_unref (self->priv->known_traces_regex);
-
     G_OBJECT_CLASS (mm_port_serial_gps_parent_class)->finalize (object);
 }
 
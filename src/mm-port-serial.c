@@ -36,6 +36,7 @@
 #include "mm-port-serial.h"
 #include "mm-log-object.h"
 #include "mm-helper-enums-types.h"
+#include "mm-traffic-ring.h"
 
 static gboolean port_serial_queue_process          (gpointer data);
 static void     port_serial_schedule_queue_process (MMPortSerial *self,
@@ -56,6 +57,7 @@ enum {
     PROP_STOPBITS,
     PROP_FLOW_CONTROL,
     PROP_SEND_DELAY,
+    PROP_SEND_CHUNK_SIZE,
     PROP_FD,
     PROP_SPEW_CONTROL,
     PROP_FLASH_OK,
@@ -75,6 +77,9 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 #define SERIAL_BUF_SIZE 2048
 
+/* Size of the history of raw data sent and received, always kept */
+#define SERIAL_TRAFFIC_RING_SIZE 8192
+
 struct _MMPortSerialPrivate {
     guint32 open_count;
     gboolean forced_close;
@@ -98,6 +103,7 @@ struct _MMPortSerialPrivate {
     guint stopbits;
     MMFlowControl flow_control;
     guint64 send_delay;
+    guint send_chunk_size;
     gboolean spew_control;
     gboolean flash_ok;
 
@@ -109,8 +115,21 @@ struct _MMPortSerialPrivate {
 
     guint n_consecutive_timeouts;
 
+    /* Automatic write mode fallback to byte pacing */
+    gboolean send_byte_paced_fallback;
+    gboolean received_since_command;
+
+    /* Write statistics */
+    guint n_commands_sent;
+    guint n_writes;
+
     guint connected_id;
 
+    /* Traffic history, and sequence number of the first record not yet
+     * dumped */
+    MMTrafficRing *traffic;
+    guint64 traffic_dumped_sequence;
+
     GTask *flash_task;
     GTask *reopen_task;
 };
@@ -532,8 +551,59 @@ serial_debug (MMPortSerial *self,
 {
     g_return_if_fail (len > 0);
 
-    if (MM_PORT_SERIAL_GET_CLASS (self)->debug_log)
+    /* Storing the raw data is cheap; formatting is only done if really
+     * going to be logged */
+    mm_traffic_ring_append (self->priv->traffic,
+                            (prefix[0] == '<') ? MM_TRAFFIC_DIRECTION_IN : MM_TRAFFIC_DIRECTION_OUT,
+                            (const guint8 *) buf,
+                            len);
+
+    if (MM_PORT_SERIAL_GET_CLASS (self)->debug_log &&
+        mm_log_check_level_enabled (MM_LOG_LEVEL_DEBUG)) {
         MM_PORT_SERIAL_GET_CLASS (self)->debug_log (self, prefix, buf, len);
+        /* Already in the logs, no need to dump it again */
+        self->priv->traffic_dumped_sequence = mm_traffic_ring_get_sequence (self->priv->traffic);
+    }
+}
+
+/* Whether the command write mode is selected automatically, i.e. commands
+ * are written at once unless the device seems to be losing characters */
+static gboolean
+port_serial_send_mode_is_automatic (MMPortSerial *self)
+{
+    return (self->priv->send_delay > 0 &&
+            self->priv->send_chunk_size == 0 &&
+            mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY);
+}
+
+/* Number of bytes to write on each send delay period, or 0 to write the
+ * whole command at once */
+static gsize
+port_serial_get_send_chunk_size (MMPortSerial *self)
+{
+    if (self->priv->send_delay == 0 || mm_port_get_subsys (MM_PORT (self)) != MM_PORT_SUBSYS_TTY)
+        return 0;
+
+    /* Automatic mode */
+    if (self->priv->send_chunk_size == 0)
+        return (self->priv->send_byte_paced_fallback ? 1 : 0);
+
+    return self->priv->send_chunk_size;
+}
+
+static void
+port_serial_log_write_mode (MMPortSerial *self)
+{
+    gsize chunk_size;
+
+    chunk_size = port_serial_get_send_chunk_size (self);
+    if (!chunk_size)
+        mm_obj_dbg (self, "command write mode: whole command%s",
+                    (self->priv->send_delay && self->priv->send_chunk_size == 0) ? " (automatic)" : "");
+    else
+        mm_obj_dbg (self, "command write mode: %" G_GSIZE_FORMAT " byte(s) every %" G_GUINT64_FORMAT "us%s",
+                    chunk_size, self->priv->send_delay,
+                    self->priv->send_byte_paced_fallback ? " (automatic fallback)" : "");
 }
 
 static gboolean
@@ -544,6 +614,7 @@ port_serial_process_command (MMPortSerial *self,
     const gchar *p;
     gsize written;
     gssize send_len;
+    gsize chunk_size;
 
     if (self->priv->iochannel == NULL && self->priv->socket == NULL) {
         g_set_error_literal (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
@@ -563,15 +634,15 @@ port_serial_process_command (MMPortSerial *self,
         serial_debug (self, "-->", (const gchar *) ctx->command->data, ctx->command->len);
     }
 
-    if (self->priv->send_delay == 0 || mm_port_get_subsys (MM_PORT (self)) != MM_PORT_SUBSYS_TTY) {
-        /* Send the whole command in one write */
-        send_len = (gssize)ctx->command->len;
-        p = (gchar *)ctx->command->data;
-    } else {
-        /* Send just one byte of the command */
-        send_len = 1;
-        p = (gchar *)&ctx->command->data[ctx->idx];
-    }
+    /* Send whatever is pending of the command, either in one write or in
+     * chunks of the configured size */
+    p = (gchar *)&ctx->command->data[ctx->idx];
+    send_len = (gssize)(ctx->command->len - ctx->idx);
+    chunk_size = port_serial_get_send_chunk_size (self);
+    if (chunk_size > 0 && (gsize)send_len > chunk_size)
+        send_len = (gssize)chunk_size;
+
+    self->priv->n_writes++;
 
     /* GIOChannel based setup */
     if (self->priv->iochannel) {
@@ -655,8 +726,11 @@ port_serial_process_command (MMPortSerial *self,
     } else
         g_assert_not_reached ();
 
-    if (ctx->idx >= ctx->command->len)
+    if (ctx->idx >= ctx->command->len) {
         ctx->done = TRUE;
+        self->priv->n_commands_sent++;
+        self->priv->received_since_command = FALSE;
+    }
 
     return TRUE;
 }
@@ -772,6 +846,22 @@ port_serial_timed_out (gpointer data)
     /* Update number of consecutive timeouts found */
     self->priv->n_consecutive_timeouts++;
 
+    /* In automatic write mode, a command written at once that gets no reply,
+     * or just part of one, may have lost characters on its way to the device.
+     * The failed command is not written again, as it may have already run
+     * (e.g. a dial or a PIN attempt); instead, the next commands are written
+     * byte paced. */
+    if (port_serial_send_mode_is_automatic (self) &&
+        !self->priv->send_byte_paced_fallback) {
+        mm_obj_dbg (self, "%s to command written at once: next commands will be byte paced",
+                    self->priv->received_since_command ? "incomplete reply" : "no reply");
+        self->priv->send_byte_paced_fallback = TRUE;
+        port_serial_log_write_mode (self);
+    }
+
+    /* Leave the traffic leading to the timeout in the logs */
+    mm_port_serial_dump_traffic (self);
+
     /* FIXME: This is not completely correct - if the response finally arrives and there's
      * some other command waiting for response right now, the other command will
      * get the output of the timed out command. Not sure what to do here. */
@@ -1014,6 +1104,7 @@ common_input_available (MMPortSerial *self,
             break;
 
         g_assert (bytes_read > 0);
+        self->priv->received_since_command = TRUE;
         serial_debug (self, "<--", buf, bytes_read);
         g_byte_array_append (self->priv->response, (const guint8 *) buf, bytes_read);
 
@@ -1307,6 +1398,8 @@ mm_port_serial_open (MMPortSerial *self, GError **error)
 success:
     self->priv->open_count++;
     mm_obj_dbg (self, "device open count is %d (open)", self->priv->open_count);
+    if (self->priv->open_count == 1)
+        port_serial_log_write_mode (self);
 
     /* Run additional port config if just opened */
     if (self->priv->open_count == 1 && MM_PORT_SERIAL_GET_CLASS (self)->config)
@@ -1379,6 +1472,9 @@ _close_internal (MMPortSerial *self, gboolean force)
         struct serial_struct sinfo = { 0 };
 
         mm_obj_dbg (self, "closing serial port...");
+        if (self->priv->n_commands_sent)
+            mm_obj_dbg (self, "%u commands sent in %u writes",
+                        self->priv->n_commands_sent, self->priv->n_writes);
 
         mm_port_set_connected (MM_PORT (self), FALSE);
 
@@ -1888,6 +1984,61 @@ mm_port_serial_set_flow_control (MMPortSerial   *self,
     return TRUE;
 }
 
+/*****************************************************************************/
+
+static void
+dump_traffic_record (guint64             sequence,
+                     gint64              timestamp,
+                     MMTrafficDirection  direction,
+                     const guint8       *data,
+                     gsize               len,
+                     MMPortSerial       *self)
+{
+    g_autoptr(GDateTime)  time = NULL;
+    g_autofree gchar     *time_str = NULL;
+    g_autofree gchar     *data_str = NULL;
+
+    time = g_date_time_new_from_unix_local (timestamp / G_USEC_PER_SEC);
+    time_str = time ? g_date_time_format (time, "%H:%M:%S") : NULL;
+    data_str = mm_traffic_ring_escape (data, len);
+    mm_obj_info (self, "  [%s.%06u] %s '%s'",
+                 time_str ? time_str : "?",
+                 (guint) (timestamp % G_USEC_PER_SEC),
+                 (direction == MM_TRAFFIC_DIRECTION_IN) ? "<--" : "-->",
+                 data_str);
+}
+
+void
+mm_port_serial_dump_traffic (MMPortSerial *self)
+{
+    guint64 sequence;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+
+    sequence = mm_traffic_ring_get_sequence (self->priv->traffic);
+    if (sequence == self->priv->traffic_dumped_sequence)
+        return;
+
+    mm_obj_info (self, "traffic history:");
+    mm_traffic_ring_foreach (self->priv->traffic,
+                             self->priv->traffic_dumped_sequence,
+                             (MMTrafficRingForeachFunc) dump_traffic_record,
+                             self);
+    self->priv->traffic_dumped_sequence = sequence;
+}
+
+gboolean
+mm_port_serial_write_traffic_pcap (MMPortSerial  *self,
+                                   const gchar   *path,
+                                   GError       **error)
+{
+    g_return_val_if_fail (MM_IS_PORT_SERIAL (self), FALSE);
+
+    return mm_traffic_ring_write_pcap (self->priv->traffic, path, error);
+}
+
+/*****************************************************************************/
+
 MMFlowControl
 mm_port_serial_get_flow_control (MMPortSerial *self)
 {
@@ -1962,9 +2113,11 @@ mm_port_serial_init (MMPortSerial *self)
     self->priv->stopbits = 1;
     self->priv->flow_control = MM_FLOW_CONTROL_UNKNOWN;
     self->priv->send_delay = 1000;
+    self->priv->send_chunk_size = 0;
 
     self->priv->queue = g_queue_new ();
     self->priv->response = g_byte_array_sized_new (500);
+    self->priv->traffic = mm_traffic_ring_new (SERIAL_TRAFFIC_RING_SIZE);
 }
 
 static void
@@ -1997,6 +2150,9 @@ set_property (GObject *object,
     case PROP_SEND_DELAY:
         self->priv->send_delay = g_value_get_uint64 (value);
         break;
+    case PROP_SEND_CHUNK_SIZE:
+        self->priv->send_chunk_size = g_value_get_uint (value);
+        break;
     case PROP_SPEW_CONTROL:
         self->priv->spew_control = g_value_get_boolean (value);
         break;
@@ -2039,6 +2195,9 @@ get_property (GObject *object,
     case PROP_SEND_DELAY:
         g_value_set_uint64 (value, self->priv->send_delay);
         break;
+    case PROP_SEND_CHUNK_SIZE:
+        g_value_set_uint (value, self->priv->send_chunk_size);
+        break;
     case PROP_SPEW_CONTROL:
         g_value_set_boolean (value, self->priv->spew_control);
         break;
@@ -2074,6 +2233,7 @@ finalize (GObject *object)
     g_hash_table_destroy (self->priv->reply_cache);
     g_byte_array_unref (self->priv->response);
     g_queue_free (self->priv->queue);
+    mm_traffic_ring_free (self->priv->traffic);
 
     G_OBJECT_CLASS (mm_port_serial_parent_class)->finalize (object);
 }
@@ -2150,6 +2310,16 @@ mm_port_serial_class_init (MMPortSerialClass *klass)
                               0, G_MAXUINT64, 0,
                               G_PARAM_READWRITE));
 
+    g_object_class_install_property
+        (object_class, PROP_SEND_CHUNK_SIZE,
+         g_param_spec_uint (MM_PORT_SERIAL_SEND_CHUNK_SIZE,
+                            "SendChunkSize",
+                            "Number of bytes written on each send delay period, "
+                            "or 0 to write whole commands and fall back to one byte "
+                            "if the device doesn't reply",
+                            0, G_MAXUINT, 0,
+                            G_PARAM_READWRITE));
+
     g_object_class_install_property
         (object_class, PROP_SPEW_CONTROL,
          g_param_spec_boolean (MM_PORT_SERIAL_SPEW_CONTROL,
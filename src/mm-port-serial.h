@@ -37,6 +37,7 @@
 #define MM_PORT_SERIAL_STOPBITS     "stopbits"
 #define MM_PORT_SERIAL_FLOW_CONTROL "flowcontrol"
 #define MM_PORT_SERIAL_SEND_DELAY   "send-delay"
+#define MM_PORT_SERIAL_SEND_CHUNK_SIZE "send-chunk-size"
 #define MM_PORT_SERIAL_FD           "fd" /* Construct-only */
 #define MM_PORT_SERIAL_SPEW_CONTROL "spew-control"
 #define MM_PORT_SERIAL_FLASH_OK     "flash-ok"
@@ -158,4 +159,14 @@ gboolean mm_port_serial_set_flow_control (MMPortSerial   *self,
                                           GError        **error);
 
 MMFlowControl mm_port_serial_get_flow_control (MMPortSerial *self);
+
+/* Logs in info level the data sent and received since the last dump, as
+ * far back as the traffic history allows, with personal info hidden. Data
+ * already logged live at debug level is not logged again */
+void     mm_port_serial_dump_traffic       (MMPortSerial  *self);
+/* Writes the whole traffic history in a pcap file */
+gboolean mm_port_serial_write_traffic_pcap (MMPortSerial  *self,
+                                            const gchar   *path,
+                                            GError       **error);
+
 #endif /* MM_PORT_SERIAL_H */
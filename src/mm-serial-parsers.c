@@ -98,8 +98,19 @@ typedef struct {
     /* User-provided parser filter */
     mm_serial_parser_v1_filter_fn filter_callback;
     gpointer                      filter_user_data;
+    /* Single-pass scanner state */
+    gboolean legacy;
+    GString *scanned;
 } MMSerialParserV1;
 
+static gboolean legacy_default;
+
+void
+mm_serial_parser_v1_set_legacy (gboolean legacy)
+{
+    legacy_default = legacy;
+}
+
 gpointer
 mm_serial_parser_v1_new (void)
 {
@@ -126,6 +137,9 @@ mm_serial_parser_v1_new (void)
     parser->filter_callback = NULL;
     parser->filter_user_data = NULL;
 
+    parser->legacy = legacy_default;
+    parser->scanned = g_string_new (NULL);
+
     return parser;
 }
 
@@ -160,42 +174,18 @@ mm_serial_parser_v1_add_filter (gpointer data,
     parser->filter_user_data = user_data;
 }
 
-gboolean
-mm_serial_parser_v1_parse (gpointer   data,
-                           GString   *response,
-                           gpointer   log_object,
-                           GError   **error)
+static gboolean
+parse_legacy (MMSerialParserV1  *parser,
+              GString           *response,
+              gpointer           log_object,
+              GError           **error)
 {
-    MMSerialParserV1 *parser = (MMSerialParserV1 *) data;
     GMatchInfo *match_info;
     GError *local_error = NULL;
     gboolean found = FALSE;
     char *str = NULL;
 
-    g_return_val_if_fail (parser != NULL, FALSE);
-    g_return_val_if_fail (response != NULL, FALSE);
-
-    /* Skip NUL bytes if they are found leading the response */
-    while (response->len > 0 && response->str[0] == '\0')
-        g_string_erase (response, 0, 1);
-
-    if (G_UNLIKELY (!response->len))
-        return FALSE;
-
-    /* First, apply custom filter if any */
-    if (parser->filter_callback &&
-        !parser->filter_callback (parser,
-                                  parser->filter_user_data,
-                                  response,
-                                  &local_error)) {
-        g_assert (local_error != NULL);
-        mm_obj_dbg (log_object, "response filtered in serial port: %s", local_error->message);
-        g_propagate_error (error, local_error);
-        response_clean (response);
-        return TRUE;
-    }
-
-    /* Then, check for successful responses */
+    /* Check for successful responses */
 
     /* Custom successful replies first, if any */
     if (parser->regex_custom_successful) {
@@ -369,6 +359,454 @@ done:
     return found;
 }
 
+/*****************************************************************************/
+/* Single-pass final result code scanner
+ *
+ * Each entry in the token table mirrors one of the regular expressions used
+ * by the legacy parser: a literal prefix followed by an optional tail. The
+ * whole response is walked once, recording the first match of each result
+ * class, and the class precedence is then applied exactly as the legacy
+ * cascade of regex matches would have done.
+ *
+ * The prefix of the response already known not to contain any result code
+ * is kept around, so that the next read only needs to scan the new bytes.
+ * The prefix is compared before being reused, as echo and unsolicited
+ * message removal may have modified the response buffer in between.
+ */
+
+typedef enum {
+    RESULT_CLASS_NONE = 0,
+    /* Successful replies, in order of precedence */
+    RESULT_CLASS_OK,
+    RESULT_CLASS_CONNECT,
+    RESULT_CLASS_SMS_PROMPT,
+    /* Error replies, in order of precedence */
+    RESULT_CLASS_CME_ERROR,
+    RESULT_CLASS_CMS_ERROR,
+    RESULT_CLASS_CME_ERROR_STR,
+    RESULT_CLASS_CMS_ERROR_STR,
+    RESULT_CLASS_EZX_ERROR,
+    RESULT_CLASS_UNKNOWN_ERROR,
+    RESULT_CLASS_CONNECT_FAILED,
+    RESULT_CLASS_NA,
+    RESULT_CLASS_LAST
+} ResultClass;
+
+typedef enum {
+    TOKEN_TAIL_NONE,         /* (nothing) */
+    TOKEN_TAIL_LINE,         /* .*\r\n */
+    TOKEN_TAIL_SPACE_TO_END, /* \s*$ */
+    TOKEN_TAIL_ERROR_CODE,   /* \s*(\d+)\r\n */
+    TOKEN_TAIL_ERROR_STRING, /* \s*([^\n\r]+)\r\n */
+} TokenTail;
+
+typedef enum {
+    TOKEN_MATCH_NO,
+    TOKEN_MATCH_YES,
+    TOKEN_MATCH_INCOMPLETE,
+} TokenMatch;
+
+typedef struct {
+    const gchar *literal;
+    gsize        literal_len;
+    TokenTail    tail;
+    ResultClass  result;
+} ResultToken;
+
+#define TOKEN_LITERAL(str) str, (sizeof (str) - 1)
+
+static const ResultToken result_tokens[] = {
+    { TOKEN_LITERAL ("\r\nOK\r\n"),                TOKEN_TAIL_NONE,         RESULT_CLASS_OK             },
+    { TOKEN_LITERAL ("\r\nCONNECT"),               TOKEN_TAIL_LINE,         RESULT_CLASS_CONNECT        },
+    { TOKEN_LITERAL ("\r\n>"),                     TOKEN_TAIL_SPACE_TO_END, RESULT_CLASS_SMS_PROMPT     },
+    { TOKEN_LITERAL ("\r\n+CME ERROR:"),           TOKEN_TAIL_ERROR_CODE,   RESULT_CLASS_CME_ERROR      },
+    { TOKEN_LITERAL ("\r\n+CMS ERROR:"),           TOKEN_TAIL_ERROR_CODE,   RESULT_CLASS_CMS_ERROR      },
+    { TOKEN_LITERAL ("\r\n+CME ERROR:"),           TOKEN_TAIL_ERROR_STRING, RESULT_CLASS_CME_ERROR_STR  },
+    { TOKEN_LITERAL ("\r\n+CMS ERROR:"),           TOKEN_TAIL_ERROR_STRING, RESULT_CLASS_CMS_ERROR_STR  },
+    { TOKEN_LITERAL ("\r\nMODEM ERROR:"),          TOKEN_TAIL_ERROR_CODE,   RESULT_CLASS_EZX_ERROR      },
+    /* The legacy unknown error and connection failure regexes are written
+     * as alternations without grouping, so only some of the alternatives
+     * are anchored to a line start or end */
+    { TOKEN_LITERAL ("\r\nERROR"),                 TOKEN_TAIL_NONE,         RESULT_CLASS_UNKNOWN_ERROR  },
+    { TOKEN_LITERAL ("COMMAND NOT SUPPORT\r\n"),   TOKEN_TAIL_NONE,         RESULT_CLASS_UNKNOWN_ERROR  },
+    { TOKEN_LITERAL ("\r\nNO CARRIER"),            TOKEN_TAIL_NONE,         RESULT_CLASS_CONNECT_FAILED },
+    { TOKEN_LITERAL ("BUSY"),                      TOKEN_TAIL_NONE,         RESULT_CLASS_CONNECT_FAILED },
+    { TOKEN_LITERAL ("NO ANSWER"),                 TOKEN_TAIL_NONE,         RESULT_CLASS_CONNECT_FAILED },
+    { TOKEN_LITERAL ("NO DIALTONE\r\n"),           TOKEN_TAIL_NONE,         RESULT_CLASS_CONNECT_FAILED },
+    /* Samsung Z810 may reply "NA" to report a not-available error */
+    { TOKEN_LITERAL ("\r\nNA\r\n"),                TOKEN_TAIL_NONE,         RESULT_CLASS_NA             },
+};
+
+typedef struct {
+    gboolean found;
+    gsize    start;
+    gsize    value_start;
+    gsize    value_end;
+} ResultMatch;
+
+static const guint8 *
+result_token_first_bytes (void)
+{
+    static guint8 first_bytes[256];
+    static gsize  initialized = 0;
+
+    if (g_once_init_enter (&initialized)) {
+        guint i;
+
+        for (i = 0; i < G_N_ELEMENTS (result_tokens); i++)
+            first_bytes[(guint8) result_tokens[i].literal[0]] = TRUE;
+        g_once_init_leave (&initialized, 1);
+    }
+    return first_bytes;
+}
+
+static TokenMatch
+token_match_tail (TokenTail    tail,
+                  const gchar *str,
+                  gsize        len,
+                  gsize        pos,
+                  gsize       *value_start,
+                  gsize       *value_end)
+{
+    gboolean incomplete = FALSE;
+    gsize    ws_end;
+    gsize    i;
+
+    switch (tail) {
+    case TOKEN_TAIL_NONE:
+        return TOKEN_MATCH_YES;
+
+    case TOKEN_TAIL_LINE:
+        /* GRegex recognizes any newline sequence by default, and '.' never
+         * matches one of those, so the first newline character found decides */
+        for (i = pos; i < len; i++) {
+            switch ((guint8) str[i]) {
+            case '\r':
+                if (i + 1 == len)
+                    return TOKEN_MATCH_INCOMPLETE;
+                return (str[i + 1] == '\n' ? TOKEN_MATCH_YES : TOKEN_MATCH_NO);
+            case '\n':
+            case '\v':
+            case '\f':
+            case 0x85:
+                return TOKEN_MATCH_NO;
+            default:
+                break;
+            }
+        }
+        return TOKEN_MATCH_INCOMPLETE;
+
+    case TOKEN_TAIL_SPACE_TO_END:
+        for (i = pos; i < len; i++) {
+            if (!g_ascii_isspace (str[i]))
+                return TOKEN_MATCH_NO;
+        }
+        return TOKEN_MATCH_YES;
+
+    case TOKEN_TAIL_ERROR_CODE:
+        for (i = pos; i < len && g_ascii_isspace (str[i]); i++);
+        if (i == len)
+            return TOKEN_MATCH_INCOMPLETE;
+        if (!g_ascii_isdigit (str[i]))
+            return TOKEN_MATCH_NO;
+        *value_start = i;
+        for (; i < len && g_ascii_isdigit (str[i]); i++);
+        *value_end = i;
+        if (i == len)
+            return TOKEN_MATCH_INCOMPLETE;
+        if (str[i] != '\r')
+            return TOKEN_MATCH_NO;
+        if (i + 1 == len)
+            return TOKEN_MATCH_INCOMPLETE;
+        return (str[i + 1] == '\n' ? TOKEN_MATCH_YES : TOKEN_MATCH_NO);
+
+    case TOKEN_TAIL_ERROR_STRING:
+        /* The leading whitespace may also include CR and LF characters, and
+         * the regex engine would backtrack from the longest whitespace
+         * prefix until a valid value is found, so do the same. */
+        for (ws_end = pos; ws_end < len && g_ascii_isspace (str[ws_end]); ws_end++);
+        for (i = ws_end + 1; i > pos; i--) {
+            gsize start = i - 1;
+            gsize end;
+
+            if (start == len) {
+                incomplete = TRUE;
+                continue;
+            }
+            if (str[start] == '\r' || str[start] == '\n')
+                continue;
+            for (end = start; end < len && str[end] != '\r' && str[end] != '\n'; end++);
+            if (end == len || (str[end] == '\r' && end + 1 == len)) {
+                incomplete = TRUE;
+                continue;
+            }
+            if (str[end] == '\r' && str[end + 1] == '\n') {
+                *value_start = start;
+                *value_end = end;
+                return TOKEN_MATCH_YES;
+            }
+        }
+        return (incomplete ? TOKEN_MATCH_INCOMPLETE : TOKEN_MATCH_NO);
+
+    default:
+        break;
+    }
+
+    g_assert_not_reached ();
+    return TOKEN_MATCH_NO;
+}
+
+static TokenMatch
+token_match (const ResultToken *token,
+             const gchar       *str,
+             gsize              len,
+             gsize              pos,
+             gsize             *value_start,
+             gsize             *value_end)
+{
+    gsize available;
+
+    available = len - pos;
+    if (available < token->literal_len)
+        return (memcmp (str + pos, token->literal, available) == 0 ? TOKEN_MATCH_INCOMPLETE : TOKEN_MATCH_NO);
+    if (memcmp (str + pos, token->literal, token->literal_len) != 0)
+        return TOKEN_MATCH_NO;
+    return token_match_tail (token->tail, str, len, pos + token->literal_len, value_start, value_end);
+}
+
+/* Scans the response starting at the given offset, and returns the result
+ * class with the highest precedence found. If none found, the offset from
+ * which the next scan should be resumed is returned. */
+static ResultClass
+scan_response (const GString *response,
+               gsize          offset,
+               ResultMatch   *matches,
+               gsize         *resume_offset)
+{
+    const guint8 *first_bytes;
+    ResultClass   best = RESULT_CLASS_NONE;
+    gsize         i;
+
+    first_bytes = result_token_first_bytes ();
+    *resume_offset = response->len;
+
+    for (i = offset; i < response->len && best != RESULT_CLASS_OK; i++) {
+        guint t;
+
+        if (!first_bytes[(guint8) response->str[i]])
+            continue;
+
+        for (t = 0; t < G_N_ELEMENTS (result_tokens); t++) {
+            const ResultToken *token = &result_tokens[t];
+            ResultMatch       *match;
+            gsize              value_start = 0;
+            gsize              value_end = 0;
+
+            /* Only the first match of each class matters */
+            match = &matches[token->result];
+            if (match->found || (best != RESULT_CLASS_NONE && token->result > best))
+                continue;
+            if (token->literal[0] != response->str[i])
+                continue;
+
+            switch (token_match (token, response->str, response->len, i, &value_start, &value_end)) {
+            case TOKEN_MATCH_YES:
+                match->found = TRUE;
+                match->start = i;
+                match->value_start = value_start;
+                match->value_end = value_end;
+                if (best == RESULT_CLASS_NONE || token->result < best)
+                    best = token->result;
+                break;
+            case TOKEN_MATCH_INCOMPLETE:
+                *resume_offset = MIN (*resume_offset, i);
+                break;
+            case TOKEN_MATCH_NO:
+            default:
+                break;
+            }
+        }
+    }
+
+    return best;
+}
+
+/* Same as removing all matches of "\r\nOK(\r\n)+" */
+static void
+remove_ok_matches (GString *response,
+                   gsize    offset)
+{
+    gsize i;
+    gsize j;
+
+    for (i = j = offset; i < response->len;) {
+        if ((response->len - i >= 6) && (memcmp (response->str + i, "\r\nOK\r\n", 6) == 0)) {
+            i += 6;
+            while ((response->len - i >= 2) && (response->str[i] == '\r') && (response->str[i + 1] == '\n'))
+                i += 2;
+            continue;
+        }
+        response->str[j++] = response->str[i++];
+    }
+    g_string_truncate (response, j);
+}
+
+static GError *
+result_error_new (ResultClass    result,
+                  const GString *response,
+                  ResultMatch   *match,
+                  gpointer       log_object)
+{
+    g_autofree gchar *value = NULL;
+
+    if (match->value_end > match->value_start)
+        value = g_strndup (response->str + match->value_start, match->value_end - match->value_start);
+
+    switch (result) {
+    case RESULT_CLASS_CME_ERROR:
+        return mm_mobile_equipment_error_for_code (atoi (value), log_object);
+    case RESULT_CLASS_CMS_ERROR:
+        return mm_message_error_for_code (atoi (value), log_object);
+    case RESULT_CLASS_CME_ERROR_STR:
+        return mm_mobile_equipment_error_for_string (value, log_object);
+    case RESULT_CLASS_CMS_ERROR_STR:
+        return mm_message_error_for_string (value, log_object);
+    case RESULT_CLASS_EZX_ERROR:
+    case RESULT_CLASS_UNKNOWN_ERROR:
+        return mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN, log_object);
+    case RESULT_CLASS_CONNECT_FAILED:
+        /* The legacy regex only ever captured the NO CARRIER alternative, all
+         * the other ones ended up also reported as NO CARRIER */
+        return mm_connection_error_for_code (MM_CONNECTION_ERROR_NO_CARRIER, log_object);
+    case RESULT_CLASS_NA:
+        /* Assume NA means 'Not Allowed' :) */
+        return g_error_new (MM_MOBILE_EQUIPMENT_ERROR,
+                            MM_MOBILE_EQUIPMENT_ERROR_NOT_ALLOWED,
+                            "Not Allowed");
+    case RESULT_CLASS_NONE:
+    case RESULT_CLASS_OK:
+    case RESULT_CLASS_CONNECT:
+    case RESULT_CLASS_SMS_PROMPT:
+    case RESULT_CLASS_LAST:
+    default:
+        break;
+    }
+
+    g_assert_not_reached ();
+    return NULL;
+}
+
+static gboolean
+parse_scanner (MMSerialParserV1  *parser,
+               GString           *response,
+               gpointer           log_object,
+               GError           **error)
+{
+    ResultMatch  matches[RESULT_CLASS_LAST] = { { 0 } };
+    ResultClass  result;
+    GError      *local_error = NULL;
+    gsize        offset = 0;
+    gsize        resume_offset = 0;
+
+    /* Custom successful replies first, if any */
+    if (parser->regex_custom_successful &&
+        g_regex_match_full (parser->regex_custom_successful,
+                            response->str, response->len,
+                            0, 0, NULL, NULL)) {
+        g_string_truncate (parser->scanned, 0);
+        response_clean (response);
+        return TRUE;
+    }
+
+    /* Resume scanning if the previously scanned prefix is still there */
+    if (parser->scanned->len > 0 &&
+        parser->scanned->len <= response->len &&
+        memcmp (parser->scanned->str, response->str, parser->scanned->len) == 0)
+        offset = parser->scanned->len;
+
+    result = scan_response (response, offset, matches, &resume_offset);
+
+    if (result == RESULT_CLASS_OK ||
+        result == RESULT_CLASS_CONNECT ||
+        result == RESULT_CLASS_SMS_PROMPT) {
+        g_string_truncate (parser->scanned, 0);
+        if (result == RESULT_CLASS_OK)
+            remove_ok_matches (response, matches[RESULT_CLASS_OK].start);
+        response_clean (response);
+        return TRUE;
+    }
+
+    /* Custom error matches first, if any */
+    if (parser->regex_custom_error) {
+        g_autoptr(GMatchInfo) match_info = NULL;
+
+        if (g_regex_match_full (parser->regex_custom_error,
+                                response->str, response->len,
+                                0, 0, &match_info, NULL)) {
+            g_autofree gchar *str = NULL;
+
+            str = g_match_info_fetch (match_info, 1);
+            g_assert (str);
+            local_error = mm_mobile_equipment_error_for_code (atoi (str), log_object);
+        }
+    }
+
+    if (!local_error && result != RESULT_CLASS_NONE)
+        local_error = result_error_new (result, response, &matches[result], log_object);
+
+    if (!local_error) {
+        g_string_truncate (parser->scanned, 0);
+        g_string_append_len (parser->scanned, response->str, resume_offset);
+        return FALSE;
+    }
+
+    g_string_truncate (parser->scanned, 0);
+    response_clean (response);
+    mm_obj_dbg (log_object, "operation failure: %d (%s)", local_error->code, local_error->message);
+    g_propagate_error (error, local_error);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_serial_parser_v1_parse (gpointer   data,
+                           GString   *response,
+                           gpointer   log_object,
+                           GError   **error)
+{
+    MMSerialParserV1 *parser = (MMSerialParserV1 *) data;
+    GError *local_error = NULL;
+
+    g_return_val_if_fail (parser != NULL, FALSE);
+    g_return_val_if_fail (response != NULL, FALSE);
+
+    /* Skip NUL bytes if they are found leading the response */
+    while (response->len > 0 && response->str[0] == '\0')
+        g_string_erase (response, 0, 1);
+
+    if (G_UNLIKELY (!response->len))
+        return FALSE;
+
+    /* First, apply custom filter if any */
+    if (parser->filter_callback &&
+        !parser->filter_callback (parser,
+                                  parser->filter_user_data,
+                                  response,
+                                  &local_error)) {
+        g_assert (local_error != NULL);
+        mm_obj_dbg (log_object, "response filtered in serial port: %s", local_error->message);
+        g_propagate_error (error, local_error);
+        g_string_truncate (parser->scanned, 0);
+        response_clean (response);
+        return TRUE;
+    }
+
+    if (parser->legacy)
+        return parse_legacy (parser, response, log_object, error);
+    return parse_scanner (parser, response, log_object, error);
+}
+
 gboolean
 mm_serial_parser_v1_is_known_error (const GError *error)
 {
@@ -403,5 +841,7 @@ mm_serial_parser_v1_destroy (gpointer data)
     if (parser->regex_custom_error)
         g_regex_unref (parser->regex_custom_error);
 
+    g_string_free (parser->scanned, TRUE);
+
     g_slice_free (MMSerialParserV1, data);
 }
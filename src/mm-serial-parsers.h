@@ -18,6 +18,9 @@
 
 #include <glib.h>
 
+/* Select whether new parsers use the legacy regex-based implementation */
+void     mm_serial_parser_v1_set_legacy           (gboolean legacy);
+
 gpointer mm_serial_parser_v1_new                  (void);
 void     mm_serial_parser_v1_set_custom_regex     (gpointer data,
                                                    GRegex *successful,
@@ -51,10 +51,138 @@ static guint signals[SIGNAL_LAST];
 struct _MMSmsListPrivate {
     /* The owner modem */
     MMBaseModem *modem;
-    /* List of sms objects */
+    /* List of sms objects, most recent first */
     GList *list;
+    guint  list_length;
+    /* Lookup tables, all of them pointing to links in the list */
+    GHashTable *by_path;
+    GHashTable *by_part_index;
+    GHashTable *by_concat_key;
+    /* Messages created locally (not taken as parts), which may get their
+     * parts stored afterwards, so they're not indexed by part */
+    GList *local;
 };
 
+#define CONCAT_KEY_TAG "sms-list-concat-key"
+
+/*****************************************************************************/
+
+static void
+index_parts (MMSmsList *self,
+             GList     *link)
+{
+    MMBaseSms    *sms = MM_BASE_SMS (link->data);
+    MMSmsStorage  storage;
+    GList        *l;
+
+    storage = mm_base_sms_get_storage (sms);
+    if (storage == MM_SMS_STORAGE_UNKNOWN)
+        return;
+
+    for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l)) {
+        guint index;
+
+        index = mm_sms_part_get_index ((MMSmsPart *) l->data);
+        if (index != SMS_PART_INVALID_INDEX)
+            g_hash_table_insert (self->priv->by_part_index,
+                                 mm_sms_part_index_key_new (storage, index),
+                                 link);
+    }
+}
+
+static void
+unindex_parts (MMSmsList *self,
+               GList     *link)
+{
+    MMBaseSms    *sms = MM_BASE_SMS (link->data);
+    MMSmsStorage  storage;
+    GList        *l;
+
+    storage = mm_base_sms_get_storage (sms);
+    if (storage == MM_SMS_STORAGE_UNKNOWN)
+        return;
+
+    for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l)) {
+        g_autofree gint64 *key = NULL;
+        guint              index;
+
+        index = mm_sms_part_get_index ((MMSmsPart *) l->data);
+        if (index == SMS_PART_INVALID_INDEX)
+            continue;
+
+        key = mm_sms_part_index_key_new (storage, index);
+        if (g_hash_table_lookup (self->priv->by_part_index, key) == link)
+            g_hash_table_remove (self->priv->by_part_index, key);
+    }
+}
+
+/* Takes ownership of the sms reference */
+static void
+list_add (MMSmsList   *self,
+          MMBaseSms   *sms,
+          gboolean     local,
+          const gchar *concat_key)
+{
+    const gchar *path;
+
+    self->priv->list = g_list_prepend (self->priv->list, sms);
+    self->priv->list_length++;
+
+    path = mm_base_sms_get_path (sms);
+    if (path)
+        g_hash_table_insert (self->priv->by_path, g_strdup (path), self->priv->list);
+
+    if (local) {
+        self->priv->local = g_list_prepend (self->priv->local, sms);
+        return;
+    }
+
+    index_parts (self, self->priv->list);
+
+    if (concat_key) {
+        g_object_set_data_full (G_OBJECT (sms), CONCAT_KEY_TAG, g_strdup (concat_key), g_free);
+        g_hash_table_insert (self->priv->by_concat_key, g_strdup (concat_key), self->priv->list);
+    }
+}
+
+static void
+list_remove (MMSmsList *self,
+             GList     *link)
+{
+    MMBaseSms   *sms = MM_BASE_SMS (link->data);
+    const gchar *path;
+    const gchar *concat_key;
+
+    path = mm_base_sms_get_path (sms);
+    if (path && g_hash_table_lookup (self->priv->by_path, path) == link)
+        g_hash_table_remove (self->priv->by_path, path);
+
+    if (g_list_find (self->priv->local, sms))
+        self->priv->local = g_list_remove (self->priv->local, sms);
+    else
+        unindex_parts (self, link);
+
+    self->priv->list = g_list_delete_link (self->priv->list, link);
+    self->priv->list_length--;
+
+    concat_key = g_object_get_data (G_OBJECT (sms), CONCAT_KEY_TAG);
+    if (concat_key && g_hash_table_lookup (self->priv->by_concat_key, concat_key) == link) {
+        GList *l;
+
+        g_hash_table_remove (self->priv->by_concat_key, concat_key);
+
+        /* Fallback to the most recent older message with the same key, if any */
+        for (l = self->priv->list; l; l = g_list_next (l)) {
+            if (!g_strcmp0 (g_object_get_data (G_OBJECT (l->data), CONCAT_KEY_TAG), concat_key)) {
+                g_hash_table_insert (self->priv->by_concat_key, g_strdup (concat_key), l);
+                break;
+            }
+        }
+    }
+
+    g_object_unref (sms);
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -89,7 +217,7 @@ mm_sms_list_has_local_multipart_reference (MMSmsList *self,
 guint
 mm_sms_list_get_count (MMSmsList *self)
 {
-    return g_list_length (self->priv->list);
+    return self->priv->list_length;
 }
 
 GStrv
@@ -99,8 +227,7 @@ mm_sms_list_get_paths (MMSmsList *self)
     GList *l;
     guint i;
 
-    path_list = g_new0 (gchar *,
-                        1 + g_list_length (self->priv->list));
+    path_list = g_new0 (gchar *, 1 + self->priv->list_length);
 
     for (i = 0, l = self->priv->list; l; l = g_list_next (l)) {
         const gchar *path;
@@ -124,13 +251,6 @@ mm_sms_list_delete_sms_finish (MMSmsList *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
-static guint
-cmp_sms_by_path (MMBaseSms *sms,
-                 const gchar *path)
-{
-    return g_strcmp0 (mm_base_sms_get_path (sms), path);
-}
-
 static void
 delete_ready (MMBaseSms *sms,
               GAsyncResult *res,
@@ -151,13 +271,9 @@ delete_ready (MMBaseSms *sms,
     self = g_task_get_source_object (task);
     path = g_task_get_task_data (task);
     /* The SMS was properly deleted, we now remove it from our list */
-    l = g_list_find_custom (self->priv->list,
-                            path,
-                            (GCompareFunc)cmp_sms_by_path);
-    if (l) {
-        g_object_unref (MM_BASE_SMS (l->data));
-        self->priv->list = g_list_delete_link (self->priv->list, l);
-    }
+    l = g_hash_table_lookup (self->priv->by_path, path);
+    if (l)
+        list_remove (self, l);
 
     /* We don't need to unref the SMS any more, but we can use the
      * reference we got in the method, which is the one kept alive
@@ -181,9 +297,7 @@ mm_sms_list_delete_sms (MMSmsList *self,
     GList *l;
     GTask *task;
 
-    l = g_list_find_custom (self->priv->list,
-                            (gpointer)sms_path,
-                            (GCompareFunc)cmp_sms_by_path);
+    l = g_hash_table_lookup (self->priv->by_path, sms_path);
     if (!l) {
         g_task_report_new_error (self,
                                  callback,
@@ -211,7 +325,7 @@ void
 mm_sms_list_add_sms (MMSmsList *self,
                      MMBaseSms *sms)
 {
-    self->priv->list = g_list_prepend (self->priv->list, g_object_ref (sms));
+    list_add (self, g_object_ref (sms), TRUE, NULL);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    FALSE);
@@ -219,16 +333,6 @@ mm_sms_list_add_sms (MMSmsList *self,
 
 /*****************************************************************************/
 
-static guint
-cmp_sms_by_concat_reference (MMBaseSms *sms,
-                             gpointer user_data)
-{
-    if (!mm_base_sms_is_multipart (sms))
-        return -1;
-
-    return (GPOINTER_TO_UINT (user_data) - mm_base_sms_get_multipart_reference (sms));
-}
-
 typedef struct {
     guint part_index;
     MMSmsStorage storage;
@@ -259,7 +363,7 @@ take_singlepart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
+    list_add (self, sms, FALSE, NULL);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    state == MM_SMS_STATE_RECEIVED);
@@ -276,15 +380,24 @@ take_multipart (MMSmsList *self,
     GList *l;
     MMBaseSms *sms;
     guint concat_reference;
+    g_autofree gchar *concat_key = NULL;
 
     concat_reference = mm_sms_part_get_concat_reference (part);
-    l = g_list_find_custom (self->priv->list,
-                            GUINT_TO_POINTER (concat_reference),
-                            (GCompareFunc)cmp_sms_by_concat_reference);
+    concat_key = mm_sms_part_concat_key_new (concat_reference, mm_sms_part_get_number (part));
+    l = g_hash_table_lookup (self->priv->by_concat_key, concat_key);
     if (l) {
         /* Try to take the part */
         mm_obj_dbg (self, "found existing multipart SMS object with reference '%u': adding new part", concat_reference);
-        return mm_base_sms_multipart_take_part (MM_BASE_SMS (l->data), part, error);
+        if (!mm_base_sms_multipart_take_part (MM_BASE_SMS (l->data), part, error))
+            return FALSE;
+
+        if (mm_sms_part_get_index (part) != SMS_PART_INVALID_INDEX &&
+            mm_base_sms_get_storage (MM_BASE_SMS (l->data)) != MM_SMS_STORAGE_UNKNOWN)
+            g_hash_table_insert (self->priv->by_part_index,
+                                 mm_sms_part_index_key_new (mm_base_sms_get_storage (MM_BASE_SMS (l->data)),
+                                                            mm_sms_part_get_index (part)),
+                                 l);
+        return TRUE;
     }
 
     /* Create new Multipart */
@@ -301,7 +414,7 @@ take_multipart (MMSmsList *self,
     mm_obj_dbg (self, "creating new multipart SMS object: need to receive %u parts with reference '%u'",
                 mm_sms_part_get_concat_max (part),
                 concat_reference);
-    self->priv->list = g_list_prepend (self->priv->list, sms);
+    list_add (self, sms, FALSE, concat_key);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    (state == MM_SMS_STATE_RECEIVED ||
@@ -315,16 +428,22 @@ mm_sms_list_has_part (MMSmsList *self,
                       MMSmsStorage storage,
                       guint index)
 {
+    g_autofree gint64 *key = NULL;
     PartIndexAndStorage ctx;
 
     if (storage == MM_SMS_STORAGE_UNKNOWN ||
         index == SMS_PART_INVALID_INDEX)
         return FALSE;
 
+    key = mm_sms_part_index_key_new (storage, index);
+    if (g_hash_table_contains (self->priv->by_part_index, key))
+        return TRUE;
+
+    /* Locally created messages are not indexed by part */
     ctx.part_index = index;
     ctx.storage = storage;
 
-    return !!g_list_find_custom (self->priv->list,
+    return !!g_list_find_custom (self->priv->local,
                                  &ctx,
                                  (GCompareFunc)cmp_sms_by_part_index_and_storage);
 }
@@ -443,6 +562,9 @@ mm_sms_list_init (MMSmsList *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_SMS_LIST,
                                               MMSmsListPrivate);
+    self->priv->by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->priv->by_part_index = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+    self->priv->by_concat_key = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 static void
@@ -451,12 +573,29 @@ dispose (GObject *object)
     MMSmsList *self = MM_SMS_LIST (object);
 
     g_clear_object (&self->priv->modem);
+    g_hash_table_remove_all (self->priv->by_path);
+    g_hash_table_remove_all (self->priv->by_part_index);
+    g_hash_table_remove_all (self->priv->by_concat_key);
+    g_clear_pointer (&self->priv->local, g_list_free);
     g_list_free_full (self->priv->list, g_object_unref);
     self->priv->list = NULL;
+    self->priv->list_length = 0;
 
     G_OBJECT_CLASS (mm_sms_list_parent_class)->dispose (object);
 }
 
+static void
+finalize (GObject *object)
+{
+    MMSmsList *self = MM_SMS_LIST (object);
+
+    g_hash_table_unref (self->priv->by_path);
+    g_hash_table_unref (self->priv->by_part_index);
+    g_hash_table_unref (self->priv->by_concat_key);
+
+    G_OBJECT_CLASS (mm_sms_list_parent_class)->finalize (object);
+}
+
 static void
 log_object_iface_init (MMLogObjectInterface *iface)
 {
@@ -474,6 +613,7 @@ mm_sms_list_class_init (MMSmsListClass *klass)
     object_class->get_property = get_property;
     object_class->set_property = set_property;
     object_class->dispose = dispose;
+    object_class->finalize = finalize;
 
     /* Properties */
     properties[PROP_MODEM] =
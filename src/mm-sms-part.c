@@ -191,3 +191,23 @@ mm_sms_part_new (guint index,
 
     return sms_part;
 }
+
+/*****************************************************************************/
+
+gint64 *
+mm_sms_part_index_key_new (MMSmsStorage storage,
+                           guint        index)
+{
+    gint64 *key;
+
+    key = g_new (gint64, 1);
+    *key = ((gint64) storage << 32) | index;
+    return key;
+}
+
+gchar *
+mm_sms_part_concat_key_new (guint        reference,
+                            const gchar *number)
+{
+    return g_strdup_printf ("%u/%s", reference, number ? number : "");
+}
@@ -146,6 +146,14 @@ void              mm_sms_part_set_concat_sequence    (MMSmsPart *part,
 
 gboolean          mm_sms_part_should_concat          (MMSmsPart *part);
 
+/* Hash table keys to look up parts by storage and index (use with
+ * g_int64_hash() and g_int64_equal()), and multipart messages by
+ * concat reference and number (use with g_str_hash() and g_str_equal()) */
+gint64           *mm_sms_part_index_key_new          (MMSmsStorage storage,
+                                                      guint index);
+gchar            *mm_sms_part_concat_key_new         (guint reference,
+                                                      const gchar *number);
+
 /* CDMA specific */
 MMSmsCdmaTeleserviceId   mm_sms_part_get_cdma_teleservice_id   (MMSmsPart *part);
 void                     mm_sms_part_set_cdma_teleservice_id   (MMSmsPart *part,
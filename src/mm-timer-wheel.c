@@ -0,0 +1,370 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <config.h>
+
+#include "mm-log-object.h"
+#include "mm-utils.h"
+#include "mm-timer-wheel.h"
+
+/* One slot per second; timers further away than the wheel size just stay
+ * in their slot for more than one revolution */
+#define TIMER_WHEEL_SLOTS 64
+
+typedef struct {
+    guint        id;
+    gpointer     owner;
+    gchar       *name;
+    guint        interval;
+    gint64       expiry;
+    GSourceFunc  callback;
+    gpointer     user_data;
+    /* Slot the timer is in, or -1 while being dispatched */
+    gint         slot;
+    GList       *link;
+} Timer;
+
+struct _MMTimerWheel {
+    GObject parent;
+    /* Timers by id */
+    GHashTable *timers;
+    guint       next_id;
+    /* Timers by expiry second */
+    GList      *slots[TIMER_WHEEL_SLOTS];
+    gint64      last_dispatch;
+    /* Single main loop source, and the time it expires at */
+    guint       source_id;
+    gint64      source_expiry;
+    /* Clock, the monotonic one unless set by the tests */
+    MMTimerWheelClock clock;
+    gpointer          clock_user_data;
+};
+
+struct _MMTimerWheelClass {
+    GObjectClass parent_class;
+};
+
+static void log_object_iface_init (MMLogObjectInterface *iface);
+
+G_DEFINE_TYPE_EXTENDED (MMTimerWheel, mm_timer_wheel, G_TYPE_OBJECT, 0,
+                        G_IMPLEMENT_INTERFACE (MM_TYPE_LOG_OBJECT, log_object_iface_init))
+
+/*****************************************************************************/
+
+static gint64
+now_seconds (MMTimerWheel *self)
+{
+    if (self->clock)
+        return self->clock (self->clock_user_data);
+    return g_get_monotonic_time () / G_USEC_PER_SEC;
+}
+
+static void
+timer_free (Timer *timer)
+{
+    g_free (timer->name);
+    g_slice_free (Timer, timer);
+}
+
+static void
+slot_add (MMTimerWheel *self,
+          Timer        *timer)
+{
+    timer->slot = timer->expiry % TIMER_WHEEL_SLOTS;
+    self->slots[timer->slot] = g_list_prepend (self->slots[timer->slot], timer);
+    timer->link = self->slots[timer->slot];
+}
+
+static void
+slot_remove (MMTimerWheel *self,
+             Timer        *timer)
+{
+    if (timer->slot < 0)
+        return;
+    self->slots[timer->slot] = g_list_delete_link (self->slots[timer->slot], timer->link);
+    timer->slot = -1;
+    timer->link = NULL;
+}
+
+static gboolean source_cb (MMTimerWheel *self);
+
+static void
+source_arm (MMTimerWheel *self)
+{
+    GHashTableIter  iter;
+    Timer          *timer;
+    gint64          next_expiry = G_MAXINT64;
+    gint64          now;
+
+    g_hash_table_iter_init (&iter, self->timers);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&timer)) {
+        if (timer->slot >= 0 && timer->expiry < next_expiry)
+            next_expiry = timer->expiry;
+    }
+
+    /* Nothing to do if the source already expires at the right time */
+    if (self->source_id && self->source_expiry == next_expiry)
+        return;
+
+    if (self->source_id) {
+        g_source_remove (self->source_id);
+        self->source_id = 0;
+    }
+
+    if (next_expiry == G_MAXINT64)
+        return;
+
+    now = now_seconds (self);
+    self->source_expiry = next_expiry;
+    self->source_id = g_timeout_add_seconds ((guint) MAX (next_expiry - now, 0),
+                                             (GSourceFunc) source_cb,
+                                             self);
+}
+
+static void
+dispatch (MMTimerWheel *self,
+          gint64        now)
+{
+    g_autoptr(GArray) due = NULL;
+    gint64            tick;
+    guint             i;
+
+    /* Collect the ids of all expired timers first, as callbacks may add or
+     * remove timers */
+    due = g_array_new (FALSE, FALSE, sizeof (guint));
+    for (tick = self->last_dispatch + 1;
+         tick <= now && tick <= self->last_dispatch + TIMER_WHEEL_SLOTS;
+         tick++) {
+        GList *l;
+
+        for (l = self->slots[tick % TIMER_WHEEL_SLOTS]; l; l = g_list_next (l)) {
+            Timer *timer = l->data;
+
+            if (timer->expiry <= now)
+                g_array_append_val (due, timer->id);
+        }
+    }
+    self->last_dispatch = now;
+
+    for (i = 0; i < due->len; i++) {
+        guint    id;
+        Timer   *timer;
+        gboolean keep;
+
+        id = g_array_index (due, guint, i);
+        timer = g_hash_table_lookup (self->timers, GUINT_TO_POINTER (id));
+        if (!timer)
+            continue;
+
+        slot_remove (self, timer);
+        keep = timer->callback (timer->user_data);
+
+        /* The callback may have removed the timer itself */
+        timer = g_hash_table_lookup (self->timers, GUINT_TO_POINTER (id));
+        if (!timer)
+            continue;
+
+        if (keep) {
+            timer->expiry = now + timer->interval;
+            slot_add (self, timer);
+        } else
+            g_hash_table_remove (self->timers, GUINT_TO_POINTER (id));
+    }
+}
+
+static gboolean
+source_cb (MMTimerWheel *self)
+{
+    self->source_id = 0;
+    dispatch (self, now_seconds (self));
+    source_arm (self);
+    return G_SOURCE_REMOVE;
+}
+
+/*****************************************************************************/
+
+guint
+mm_timer_wheel_add_seconds (MMTimerWheel *self,
+                            gpointer      owner,
+                            const gchar  *name,
+                            guint         interval,
+                            GSourceFunc   callback,
+                            gpointer      user_data)
+{
+    Timer  *timer;
+    gint64  now;
+
+    g_return_val_if_fail (MM_IS_TIMER_WHEEL (self), 0);
+    g_return_val_if_fail (callback != NULL, 0);
+
+    now = now_seconds (self);
+
+    /* If the wheel was idle, restart from the current time, so that the next
+     * dispatch doesn't need to go through all the slots */
+    if (!g_hash_table_size (self->timers))
+        self->last_dispatch = now;
+
+    timer = g_slice_new0 (Timer);
+    do {
+        timer->id = ++self->next_id;
+    } while (!timer->id || g_hash_table_contains (self->timers, GUINT_TO_POINTER (timer->id)));
+    timer->owner = owner;
+    timer->name = g_strdup (name);
+    timer->interval = MAX (interval, 1);
+    timer->expiry = now + timer->interval;
+    timer->callback = callback;
+    timer->user_data = user_data;
+    g_hash_table_insert (self->timers, GUINT_TO_POINTER (timer->id), timer);
+    slot_add (self, timer);
+
+    if (!self->source_id || timer->expiry < self->source_expiry)
+        source_arm (self);
+
+    return timer->id;
+}
+
+void
+mm_timer_wheel_remove (MMTimerWheel *self,
+                       guint         id)
+{
+    Timer *timer;
+
+    g_return_if_fail (MM_IS_TIMER_WHEEL (self));
+
+    timer = g_hash_table_lookup (self->timers, GUINT_TO_POINTER (id));
+    if (!timer) {
+        g_warning ("timer id %u not found in the timer wheel", id);
+        return;
+    }
+
+    slot_remove (self, timer);
+    g_hash_table_remove (self->timers, GUINT_TO_POINTER (id));
+
+    /* Stop the source if no more timers */
+    if (!g_hash_table_size (self->timers) && self->source_id) {
+        g_source_remove (self->source_id);
+        self->source_id = 0;
+    }
+}
+
+void
+mm_timer_wheel_set_clock (MMTimerWheel      *self,
+                          MMTimerWheelClock  clock,
+                          gpointer           user_data)
+{
+    g_return_if_fail (MM_IS_TIMER_WHEEL (self));
+    g_return_if_fail (!g_hash_table_size (self->timers));
+
+    self->clock = clock;
+    self->clock_user_data = user_data;
+}
+
+void
+mm_timer_wheel_run_due (MMTimerWheel *self)
+{
+    g_return_if_fail (MM_IS_TIMER_WHEEL (self));
+
+    if (self->source_id) {
+        g_source_remove (self->source_id);
+        self->source_id = 0;
+    }
+    source_cb (self);
+}
+
+static gint
+timer_cmp_expiry (const Timer *a,
+                  const Timer *b)
+{
+    if (a->expiry != b->expiry)
+        return (a->expiry < b->expiry) ? -1 : 1;
+    return (a->id < b->id) ? -1 : (a->id > b->id);
+}
+
+void
+mm_timer_wheel_log_timers (MMTimerWheel *self)
+{
+    g_autoptr(GList)  timers = NULL;
+    GList            *l;
+    gint64            now;
+
+    g_return_if_fail (MM_IS_TIMER_WHEEL (self));
+
+    now = now_seconds (self);
+    timers = g_list_sort (g_hash_table_get_values (self->timers), (GCompareFunc) timer_cmp_expiry);
+
+    mm_obj_dbg (self, "%u active timers", g_hash_table_size (self->timers));
+    for (l = timers; l; l = g_list_next (l)) {
+        Timer *timer = l->data;
+
+        mm_obj_dbg (timer->owner ? timer->owner : self,
+                    "timer '%s' (id %u): every %us, next in %" G_GINT64_FORMAT "s",
+                    timer->name ? timer->name : "unnamed",
+                    timer->id,
+                    timer->interval,
+                    (timer->slot >= 0) ? MAX (timer->expiry - now, 0) : 0);
+    }
+}
+
+/*****************************************************************************/
+
+static gchar *
+log_object_build_id (MMLogObject *_self)
+{
+    return g_strdup ("timer-wheel");
+}
+
+/*****************************************************************************/
+
+static void
+mm_timer_wheel_init (MMTimerWheel *self)
+{
+    self->timers = g_hash_table_new_full (g_direct_hash,
+                                          g_direct_equal,
+                                          NULL,
+                                          (GDestroyNotify) timer_free);
+}
+
+static void
+dispose (GObject *object)
+{
+    MMTimerWheel *self = MM_TIMER_WHEEL (object);
+    guint         i;
+
+    if (self->source_id) {
+        g_source_remove (self->source_id);
+        self->source_id = 0;
+    }
+    for (i = 0; i < TIMER_WHEEL_SLOTS; i++)
+        g_clear_pointer (&self->slots[i], g_list_free);
+    g_clear_pointer (&self->timers, g_hash_table_unref);
+
+    G_OBJECT_CLASS (mm_timer_wheel_parent_class)->dispose (object);
+}
+
+static void
+log_object_iface_init (MMLogObjectInterface *iface)
+{
+    iface->build_id = log_object_build_id;
+}
+
+static void
+mm_timer_wheel_class_init (MMTimerWheelClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->dispose = dispose;
+}
+
+MM_DEFINE_SINGLETON_GETTER (MMTimerWheel, mm_timer_wheel_get, MM_TYPE_TIMER_WHEEL);
@@ -0,0 +1,70 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_TIMER_WHEEL_H
+#define MM_TIMER_WHEEL_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MM_TYPE_TIMER_WHEEL         (mm_timer_wheel_get_type ())
+#define MM_TIMER_WHEEL(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), MM_TYPE_TIMER_WHEEL, MMTimerWheel))
+#define MM_TIMER_WHEEL_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST ((k), MM_TYPE_TIMER_WHEEL, MMTimerWheelClass))
+#define MM_TIMER_WHEEL_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), MM_TYPE_TIMER_WHEEL, MMTimerWheelClass))
+#define MM_IS_TIMER_WHEEL(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), MM_TYPE_TIMER_WHEEL))
+#define MM_IS_TIMER_WHEEL_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), MM_TYPE_TIMER_WHEEL))
+
+typedef struct _MMTimerWheel      MMTimerWheel;
+typedef struct _MMTimerWheelClass MMTimerWheelClass;
+
+GType         mm_timer_wheel_get_type (void) G_GNUC_CONST;
+MMTimerWheel *mm_timer_wheel_get      (void);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMTimerWheel, g_object_unref)
+
+/* Same semantics as g_timeout_add_seconds(): the callback is run after
+ * the given number of seconds, and again every time the same interval
+ * elapses for as long as it returns G_SOURCE_CONTINUE. All timers share a
+ * single main loop source, so timers expiring in the same second are run
+ * in the same wakeup. The returned id is never 0.
+ *
+ * The owner is the log object the timer is listed under, or NULL; it is
+ * not referenced, so the timer must be removed before it is disposed. */
+guint mm_timer_wheel_add_seconds (MMTimerWheel *self,
+                                  gpointer      owner,
+                                  const gchar  *name,
+                                  guint         interval,
+                                  GSourceFunc   callback,
+                                  gpointer      user_data);
+void  mm_timer_wheel_remove      (MMTimerWheel *self,
+                                  guint         id);
+
+/* Logs all active timers, in debug level */
+void  mm_timer_wheel_log_timers  (MMTimerWheel *self);
+
+/* Testing support: replace the monotonic clock, which must be done before
+ * any timer is added, and run the timers due at the current clock time
+ * without waiting for the main loop */
+typedef gint64 (* MMTimerWheelClock) (gpointer user_data);
+
+void  mm_timer_wheel_set_clock   (MMTimerWheel      *self,
+                                  MMTimerWheelClock  clock,
+                                  gpointer           user_data);
+void  mm_timer_wheel_run_due     (MMTimerWheel      *self);
+
+G_END_DECLS
+
+#endif /* MM_TIMER_WHEEL_H */
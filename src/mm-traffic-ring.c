@@ -0,0 +1,327 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "mm-traffic-ring.h"
+
+/* Each record is a header followed by the data, both stored in the same
+ * circular buffer and possibly wrapping around its end */
+typedef struct {
+    gint64  timestamp;
+    guint64 sequence;
+    guint32 len;
+    /* Length before truncation, if the record didn't fit in the ring */
+    guint32 original_len;
+    guint8  direction;
+} RecordHeader;
+
+struct _MMTrafficRing {
+    guint8  *buffer;
+    gsize    capacity;
+    /* Offset of the oldest record, and amount of bytes in use */
+    gsize    start;
+    gsize    used;
+    /* Sequence number of the next record */
+    guint64  sequence;
+};
+
+/*****************************************************************************/
+
+static void
+ring_write (MMTrafficRing *self,
+            gsize          offset,
+            gconstpointer  data,
+            gsize          len)
+{
+    gsize first;
+
+    offset %= self->capacity;
+    first = MIN (len, self->capacity - offset);
+    memcpy (self->buffer + offset, data, first);
+    if (first < len)
+        memcpy (self->buffer, (const guint8 *)data + first, len - first);
+}
+
+static void
+ring_read (MMTrafficRing *self,
+           gsize          offset,
+           gpointer       data,
+           gsize          len)
+{
+    gsize first;
+
+    offset %= self->capacity;
+    first = MIN (len, self->capacity - offset);
+    memcpy (data, self->buffer + offset, first);
+    if (first < len)
+        memcpy ((guint8 *)data + first, self->buffer, len - first);
+}
+
+static void
+ring_drop_oldest (MMTrafficRing *self)
+{
+    RecordHeader header;
+    gsize        record_size;
+
+    ring_read (self, self->start, &header, sizeof (header));
+    record_size = sizeof (header) + header.len;
+    self->start = (self->start + record_size) % self->capacity;
+    self->used -= record_size;
+}
+
+/*****************************************************************************/
+
+void
+mm_traffic_ring_append (MMTrafficRing      *self,
+                        MMTrafficDirection  direction,
+                        const guint8       *data,
+                        gsize               len)
+{
+    RecordHeader header;
+    gsize        record_size;
+
+    g_return_if_fail (self != NULL);
+
+    header.timestamp = g_get_real_time ();
+    header.sequence = self->sequence++;
+    header.original_len = (guint32) MIN (len, G_MAXUINT32);
+    header.len = (guint32) MIN (len, self->capacity - sizeof (header));
+    header.direction = (guint8) direction;
+
+    record_size = sizeof (header) + header.len;
+    while (self->used + record_size > self->capacity)
+        ring_drop_oldest (self);
+
+    ring_write (self, self->start + self->used, &header, sizeof (header));
+    ring_write (self, self->start + self->used + sizeof (header), data, header.len);
+    self->used += record_size;
+}
+
+guint64
+mm_traffic_ring_get_sequence (MMTrafficRing *self)
+{
+    g_return_val_if_fail (self != NULL, 0);
+
+    return self->sequence;
+}
+
+void
+mm_traffic_ring_foreach (MMTrafficRing            *self,
+                         guint64                   since_sequence,
+                         MMTrafficRingForeachFunc  func,
+                         gpointer                  user_data)
+{
+    g_autofree guint8 *data = NULL;
+    gsize              offset;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (func != NULL);
+
+    data = g_malloc (self->capacity);
+    for (offset = 0; offset < self->used; ) {
+        RecordHeader header;
+
+        ring_read (self, self->start + offset, &header, sizeof (header));
+        offset += sizeof (header);
+        if (header.sequence >= since_sequence) {
+            ring_read (self, self->start + offset, data, header.len);
+            func (header.sequence,
+                  header.timestamp,
+                  (MMTrafficDirection) header.direction,
+                  data,
+                  header.len,
+                  user_data);
+        }
+        offset += header.len;
+    }
+}
+
+/*****************************************************************************/
+
+/* Commands whose arguments may carry PIN, PUK or password values */
+static const gchar *secret_commands[] = { "+CPIN=", "+CPWD=", "+CLCK=" };
+
+static gsize
+match_secret_command (const guint8 *data,
+                      gsize         len)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (secret_commands); i++) {
+        gsize command_len;
+
+        command_len = strlen (secret_commands[i]);
+        if (len >= command_len && g_ascii_strncasecmp ((const gchar *)data, secret_commands[i], command_len) == 0)
+            return command_len;
+    }
+    return 0;
+}
+
+/* Runs of hex digits at least this long are SMS PDUs or subscriber and SIM
+ * identifiers (IMSI, ICCID, IMEI) */
+#define MIN_HIDDEN_HEX_RUN 14
+
+static gsize
+match_hex_run (const guint8 *data,
+               gsize         len)
+{
+    gsize run_len;
+
+    for (run_len = 0; run_len < len && g_ascii_isxdigit (data[run_len]); run_len++);
+    return run_len;
+}
+
+gchar *
+mm_traffic_ring_escape (const guint8 *data,
+                        gsize         len)
+{
+    GString *str;
+    gsize    i;
+
+    str = g_string_sized_new (len + 16);
+    for (i = 0; i < len; i++) {
+        gsize command_len;
+        gsize run_len;
+
+        if (g_ascii_isxdigit (data[i])) {
+            run_len = match_hex_run (&data[i], len - i);
+            if (run_len >= MIN_HIDDEN_HEX_RUN)
+                g_string_append (str, "<hidden>");
+            else
+                g_string_append_len (str, (const gchar *)&data[i], run_len);
+            i += run_len - 1;
+            continue;
+        }
+
+        command_len = (data[i] == '+') ? match_secret_command (&data[i], len - i) : 0;
+        if (command_len) {
+            g_string_append_len (str, (const gchar *)&data[i], command_len);
+            g_string_append (str, "<hidden>");
+            i += command_len;
+            while (i < len && data[i] != '\r' && data[i] != '\n')
+                i++;
+            /* Let the line terminator be escaped as usual */
+            i--;
+        } else if (g_ascii_isprint (data[i]))
+            g_string_append_c (str, (gchar) data[i]);
+        else if (data[i] == '\r')
+            g_string_append (str, "<CR>");
+        else if (data[i] == '\n')
+            g_string_append (str, "<LF>");
+        else
+            g_string_append_printf (str, "\\%u", data[i]);
+    }
+    return g_string_free (str, FALSE);
+}
+
+/*****************************************************************************/
+
+#define PCAP_MAGIC           0xa1b2c3d4
+#define PCAP_VERSION_MAJOR   2
+#define PCAP_VERSION_MINOR   4
+#define PCAP_LINKTYPE_USER0  147
+
+typedef struct {
+    guint32 magic;
+    guint16 version_major;
+    guint16 version_minor;
+    gint32  thiszone;
+    guint32 sigfigs;
+    guint32 snaplen;
+    guint32 linktype;
+} PcapFileHeader;
+
+typedef struct {
+    guint32 ts_sec;
+    guint32 ts_usec;
+    guint32 incl_len;
+    guint32 orig_len;
+} PcapRecordHeader;
+
+static void
+pcap_append_record (guint64             sequence,
+                    gint64              timestamp,
+                    MMTrafficDirection  direction,
+                    const guint8       *data,
+                    gsize               len,
+                    GByteArray         *pcap)
+{
+    PcapRecordHeader header;
+    guint8           direction_byte;
+
+    /* Host byte order, as given by the magic number in the file header */
+    header.ts_sec = (guint32) (timestamp / G_USEC_PER_SEC);
+    header.ts_usec = (guint32) (timestamp % G_USEC_PER_SEC);
+    header.incl_len = (guint32) (len + 1);
+    header.orig_len = (guint32) (len + 1);
+    direction_byte = (guint8) direction;
+
+    g_byte_array_append (pcap, (const guint8 *)&header, sizeof (header));
+    g_byte_array_append (pcap, &direction_byte, 1);
+    g_byte_array_append (pcap, data, len);
+}
+
+gboolean
+mm_traffic_ring_write_pcap (MMTrafficRing  *self,
+                            const gchar    *path,
+                            GError        **error)
+{
+    g_autoptr(GByteArray) pcap = NULL;
+    PcapFileHeader        header = {
+        .magic         = PCAP_MAGIC,
+        .version_major = PCAP_VERSION_MAJOR,
+        .version_minor = PCAP_VERSION_MINOR,
+        .thiszone      = 0,
+        .sigfigs       = 0,
+        .snaplen       = G_MAXUINT16,
+        .linktype      = PCAP_LINKTYPE_USER0,
+    };
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (path != NULL, FALSE);
+
+    pcap = g_byte_array_sized_new (sizeof (header) + self->used);
+    g_byte_array_append (pcap, (const guint8 *)&header, sizeof (header));
+    mm_traffic_ring_foreach (self, 0, (MMTrafficRingForeachFunc) pcap_append_record, pcap);
+
+    return g_file_set_contents (path, (const gchar *)pcap->data, (gssize) pcap->len, error);
+}
+
+/*****************************************************************************/
+
+MMTrafficRing *
+mm_traffic_ring_new (gsize capacity)
+{
+    MMTrafficRing *self;
+
+    /* Always room for at least one header and some data */
+    capacity = MAX (capacity, 2 * sizeof (RecordHeader));
+
+    self = g_slice_new0 (MMTrafficRing);
+    self->capacity = capacity;
+    self->buffer = g_malloc (capacity);
+    return self;
+}
+
+void
+mm_traffic_ring_free (MMTrafficRing *self)
+{
+    if (!self)
+        return;
+    g_free (self->buffer);
+    g_slice_free (MMTrafficRing, self);
+}
@@ -0,0 +1,71 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_TRAFFIC_RING_H
+#define MM_TRAFFIC_RING_H
+
+#include <glib.h>
+
+/* Fixed-size history of the raw data exchanged through a port. Records are
+ * stored as given, and only formatted when the history is dumped; once the
+ * ring is full, the oldest records are dropped. */
+
+typedef enum {
+    MM_TRAFFIC_DIRECTION_OUT,
+    MM_TRAFFIC_DIRECTION_IN,
+} MMTrafficDirection;
+
+typedef struct _MMTrafficRing MMTrafficRing;
+
+MMTrafficRing *mm_traffic_ring_new          (gsize               capacity);
+void           mm_traffic_ring_free         (MMTrafficRing      *self);
+void           mm_traffic_ring_append       (MMTrafficRing      *self,
+                                             MMTrafficDirection  direction,
+                                             const guint8       *data,
+                                             gsize               len);
+/* Number of records ever appended */
+guint64        mm_traffic_ring_get_sequence (MMTrafficRing      *self);
+
+/* Runs the function for each record still in the ring, oldest first,
+ * skipping the ones with a sequence number lower than the given one.
+ * Timestamps are given in microseconds since the Epoch. */
+typedef void (* MMTrafficRingForeachFunc) (guint64             sequence,
+                                           gint64              timestamp,
+                                           MMTrafficDirection  direction,
+                                           const guint8       *data,
+                                           gsize               len,
+                                           gpointer            user_data);
+void           mm_traffic_ring_foreach      (MMTrafficRing            *self,
+                                             guint64                   since_sequence,
+                                             MMTrafficRingForeachFunc  func,
+                                             gpointer                  user_data);
+
+/* Printable version of the data, with control characters escaped and
+ * personal info hidden: the arguments of the commands that carry PIN, PUK
+ * or passwords (+CPIN, +CPWD, +CLCK), and long runs of hex digits, as found
+ * in SMS PDUs and in IMSI, ICCID or IMEI replies */
+gchar         *mm_traffic_ring_escape       (const guint8 *data,
+                                             gsize         len);
+
+/* Writes all records in a pcap file, using the LINKTYPE_USER0 link type;
+ * each packet is prefixed with one byte giving the direction (0 for data
+ * sent to the device, 1 for data received from the device). */
+gboolean       mm_traffic_ring_write_pcap   (MMTrafficRing  *self,
+                                             const gchar    *path,
+                                             GError        **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMTrafficRing, mm_traffic_ring_free)
+
+#endif /* MM_TRAFFIC_RING_H */
@@ -83,6 +83,43 @@ static const ParseResponseTest parse_error_tests[] = {
     { "\r\nNO DIALTONE\r\n\r\nSomething extra\r\n", TRUE, TRUE}
 };
 
+/* Responses recorded from real modems, including URCs and partial reads */
+static const gchar *parse_traces[] = {
+    "ATE0\r\r\nOK\r\n",
+    "\r\n+CGSN: 866758040000000\r\n\r\nOK\r\n",
+    "\r\nHUAWEI\r\n\r\nOK\r\n\r\n^RSSI: 17\r\n",
+    "\r\n+CGDCONT: 1,\"IP\",\"internet\",\"0.0.0.0\",0,0\r\n+CGDCONT: 2,\"IPV4V6\",\"ims\",\"\",0,0\r\n\r\nOK\r\n",
+    "\r\n+CMGL: 0,1,,24\r\n07914306073011F0040B914316709807F2000002909010711123040BD4F29C0E\r\n\r\nOK\r\n",
+    "\r\n> ",
+    "\r\n>\r\n",
+    "\r\nCONNECT 150000000\r\n",
+    "\r\nCONNECT\r\n",
+    "\r\n+CME ERROR: 10\r\n",
+    "\r\n+CME ERROR: SIM not inserted\r\n",
+    "\r\n+CME ERROR: incorrect password\r\n\r\n+CME ERROR: 16\r\n",
+    "\r\n+CMS ERROR: 500\r\n",
+    "\r\n+CMS ERROR: unknown error\r\n",
+    "\r\n+CREG: 1\r\n\r\nERROR\r\n",
+    "\r\n+CIEV: 7,1\r\n\r\nNO CARRIER\r\n",
+    "\r\nBUSY\r\n",
+    "\r\nNO ANSWER\r\n",
+    "\r\nNO DIALTONE\r\n",
+    "\r\nCOMMAND NOT SUPPORT\r\n",
+    "\r\nMODEM ERROR: 3\r\n",
+    "\r\nNA\r\n",
+    "\r\n+COPS: 0,0,\"vodafone ES\",7\r\n\r\nOK\r\n\r\nOK\r\n",
+    "\r\nOK\r\n\r\n\r\nOK\r\n\r\n",
+    "\r\nRING\r\n\r\n+CLIP: \"+0123456789\",145,,,,0\r\n",
+};
+
+/* Pieces used to build random responses for the differential tests */
+static const gchar *parse_fuzz_pieces[] = {
+    "\r\n", "\r", "\n", " ", "\t", "5", "12", "abc", ">", "x",
+    "OK", "ERROR", "CONNECT", "NA", "+CME ERROR:", "+CMS ERROR:", "MODEM ERROR:",
+    "NO CARRIER", "BUSY", "NO ANSWER", "NO DIALTONE", "COMMAND NOT SUPPORT",
+    "+CREG: 1",
+};
+
 static void
 at_serial_echo_removal (void)
 {
@@ -149,6 +186,239 @@ at_serial_parse_error (void)
     _run_parse_test (parse_error_tests, G_N_ELEMENTS(parse_error_tests));
 }
 
+/*****************************************************************************/
+/* Differential tests between the legacy and the default parsers */
+
+static gpointer
+parser_new (gboolean legacy)
+{
+    gpointer parser;
+
+    mm_serial_parser_v1_set_legacy (legacy);
+    parser = mm_serial_parser_v1_new ();
+    mm_serial_parser_v1_set_legacy (FALSE);
+    return parser;
+}
+
+static void
+_run_differential_test (const gchar *trace,
+                        gsize        trace_len,
+                        gsize        chunk_size)
+{
+    gpointer  legacy_parser;
+    gpointer  parser;
+    GString  *legacy_response;
+    GString  *response;
+    gsize     fed = 0;
+
+    legacy_parser = parser_new (TRUE);
+    parser = parser_new (FALSE);
+    legacy_response = g_string_new (NULL);
+    response = g_string_new (NULL);
+
+    /* Feed the trace in chunks, as if read from the port */
+    while (fed < trace_len) {
+        GError   *legacy_error = NULL;
+        GError   *error = NULL;
+        gboolean  legacy_found;
+        gboolean  found;
+        gsize     n;
+
+        n = MIN (chunk_size, trace_len - fed);
+        g_string_append_len (legacy_response, trace + fed, n);
+        g_string_append_len (response, trace + fed, n);
+        fed += n;
+
+        legacy_found = mm_serial_parser_v1_parse (legacy_parser, legacy_response, NULL, &legacy_error);
+        found = mm_serial_parser_v1_parse (parser, response, NULL, &error);
+
+        g_assert_cmpint (found, ==, legacy_found);
+        g_assert_cmpuint (response->len, ==, legacy_response->len);
+        g_assert (memcmp (response->str, legacy_response->str, response->len) == 0);
+        if (legacy_error) {
+            g_assert (error != NULL);
+            g_assert_cmpuint (error->domain, ==, legacy_error->domain);
+            g_assert_cmpint (error->code, ==, legacy_error->code);
+            g_assert_cmpstr (error->message, ==, legacy_error->message);
+            g_error_free (legacy_error);
+            g_error_free (error);
+        } else
+            g_assert_no_error (error);
+
+        /* The port consumes the whole response once it's parsed */
+        if (found) {
+            g_string_truncate (legacy_response, 0);
+            g_string_truncate (response, 0);
+        }
+    }
+
+    g_string_free (legacy_response, TRUE);
+    g_string_free (response, TRUE);
+    mm_serial_parser_v1_destroy (legacy_parser);
+    mm_serial_parser_v1_destroy (parser);
+}
+
+static void
+_run_differential_tests (const ParseResponseTest tests[], guint number_of_tests)
+{
+    guint i;
+
+    for (i = 0; i < number_of_tests; i++) {
+        gsize len;
+
+        len = strlen (tests[i].response);
+        _run_differential_test (tests[i].response, len, len);
+        _run_differential_test (tests[i].response, len, 1);
+    }
+}
+
+static void
+at_serial_parse_differential_tests (void)
+{
+    _run_differential_tests (parse_ok_tests, G_N_ELEMENTS (parse_ok_tests));
+    _run_differential_tests (parse_error_tests, G_N_ELEMENTS (parse_error_tests));
+}
+
+static void
+at_serial_parse_differential_traces (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (parse_traces); i++) {
+        gsize len;
+        gsize chunk_size;
+
+        len = strlen (parse_traces[i]);
+        for (chunk_size = 1; chunk_size <= len; chunk_size++)
+            _run_differential_test (parse_traces[i], len, chunk_size);
+    }
+}
+
+static void
+at_serial_parse_differential_fuzz (void)
+{
+    guint i;
+
+    for (i = 0; i < 5000; i++) {
+        GString *trace;
+        guint    n_pieces;
+        guint    j;
+
+        trace = g_string_new (NULL);
+        n_pieces = g_test_rand_int_range (1, 13);
+        for (j = 0; j < n_pieces; j++)
+            g_string_append (trace, parse_fuzz_pieces[g_test_rand_int_range (0, G_N_ELEMENTS (parse_fuzz_pieces))]);
+
+        _run_differential_test (trace->str, trace->len, trace->len);
+        _run_differential_test (trace->str, trace->len, g_test_rand_int_range (1, 6));
+        g_string_free (trace, TRUE);
+    }
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    const gchar *pattern;
+    const gchar *prefix;
+} LiteralPrefixTest;
+
+static const LiteralPrefixTest literal_prefix_tests[] = {
+    { "\\r\\n\\+CREG:\\s*(\\d)\\r\\n",           "\r\n+CREG:"        },
+    { "\\r\\n\\^MODE:(.*)\\r\\n",                "\r\n^MODE:"        },
+    { "\\r\\n\\+ZEND\\r\\n",                     "\r\n+ZEND\r\n"     },
+    { "\\r\\n\\+PACSP.*\\r\\n",                  "\r\n+PACSP"        },
+    { "\\$.*\\r\\n",                             "$"                },
+    { "\\r\\n(NO CARRIER|BUSY)\\r\\n",           "\r\n"             },
+    { "\\r\\nRING|BUSY",                         NULL               },
+    { "\\r?\\n?\\+CIEV:",                        NULL               },
+    { "(?:\\+IFC:)?\\s*\\((.*)\\)",                NULL               },
+};
+
+static void
+at_serial_regex_literal_prefix (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (literal_prefix_tests); i++) {
+        GRegex *regex;
+        gchar  *prefix;
+
+        regex = g_regex_new (literal_prefix_tests[i].pattern, G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        g_assert (regex);
+        prefix = mm_port_serial_at_get_regex_literal_prefix (regex);
+        g_assert_cmpstr (prefix, ==, literal_prefix_tests[i].prefix);
+        g_free (prefix);
+        g_regex_unref (regex);
+    }
+}
+
+static void
+count_urc_cb (MMPortSerialAt *port,
+              GMatchInfo     *match_info,
+              guint          *count)
+{
+    (*count)++;
+}
+
+static void
+at_serial_unsolicited_dispatch (void)
+{
+    MMPortSerialAt *port;
+    GRegex         *creg_regex;
+    GRegex         *mode_regex;
+    GRegex         *gps_regex;
+    GByteArray     *response;
+    guint           creg_count = 0;
+    guint           mode_count = 0;
+    guint           gps_count = 0;
+    guint           n_evaluated = 0;
+    guint           n_skipped = 0;
+    guint           n_hits = 0;
+    const gchar    *trace = "\r\n+CREG: 1\r\n\r\n+CSQ: 20,99\r\n\r\nOK\r\n\r\n+CREG: 5\r\n";
+    const gchar    *expected = "\r\n+CSQ: 20,99\r\n\r\nOK\r\n";
+
+    port = mm_port_serial_at_new ("ttyTEST0", MM_PORT_SUBSYS_TTY);
+
+    creg_regex = g_regex_new ("\\r\\n\\+CREG:\\s*(\\d)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    mode_regex = g_regex_new ("\\r\\n\\^MODE:(.*)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    gps_regex = g_regex_new ("(?:\\r\\n)?\\$GPGGA.*\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    mm_port_serial_at_add_unsolicited_msg_handler (port, creg_regex, (MMPortSerialAtUnsolicitedMsgFn) count_urc_cb, &creg_count, NULL);
+    mm_port_serial_at_add_unsolicited_msg_handler (port, mode_regex, (MMPortSerialAtUnsolicitedMsgFn) count_urc_cb, &mode_count, NULL);
+    mm_port_serial_at_add_unsolicited_msg_handler (port, gps_regex, (MMPortSerialAtUnsolicitedMsgFn) count_urc_cb, &gps_count, NULL);
+
+    response = g_byte_array_new ();
+    g_byte_array_append (response, (const guint8 *) trace, strlen (trace));
+    MM_PORT_SERIAL_GET_CLASS (port)->parse_unsolicited (MM_PORT_SERIAL (port), response);
+
+    /* Matched URCs are removed, everything else is kept */
+    g_assert_cmpuint (response->len, ==, strlen (expected));
+    g_assert (memcmp (response->data, expected, response->len) == 0);
+    g_assert_cmpuint (creg_count, ==, 2);
+    g_assert_cmpuint (mode_count, ==, 0);
+    g_assert_cmpuint (gps_count, ==, 0);
+
+    /* The handler with a literal prefix not found in the response is skipped,
+     * the one without literal prefix is always run */
+    g_assert (mm_port_serial_at_get_unsolicited_msg_handler_stats (port, creg_regex, &n_evaluated, &n_skipped, &n_hits));
+    g_assert_cmpuint (n_evaluated, ==, 1);
+    g_assert_cmpuint (n_skipped, ==, 0);
+    g_assert_cmpuint (n_hits, ==, 2);
+    g_assert (mm_port_serial_at_get_unsolicited_msg_handler_stats (port, mode_regex, &n_evaluated, &n_skipped, &n_hits));
+    g_assert_cmpuint (n_evaluated, ==, 0);
+    g_assert_cmpuint (n_skipped, ==, 1);
+    g_assert_cmpuint (n_hits, ==, 0);
+    g_assert (mm_port_serial_at_get_unsolicited_msg_handler_stats (port, gps_regex, &n_evaluated, &n_skipped, &n_hits));
+    g_assert_cmpuint (n_evaluated, ==, 1);
+    g_assert_cmpuint (n_skipped, ==, 0);
+    g_assert_cmpuint (n_hits, ==, 0);
+
+    g_byte_array_unref (response);
+    g_regex_unref (creg_regex);
+    g_regex_unref (mode_regex);
+    g_regex_unref (gps_regex);
+    g_object_unref (port);
+}
+
 int main (int argc, char **argv)
 {
     g_test_init (&argc, &argv, NULL);
@@ -156,6 +426,11 @@ int main (int argc, char **argv)
     g_test_add_func ("/ModemManager/AT-serial/echo-removal", at_serial_echo_removal);
     g_test_add_func ("/ModemManager/AT-serial/parse-ok", at_serial_parse_ok);
     g_test_add_func ("/ModemManager/AT-serial/parse-error", at_serial_parse_error);
+    g_test_add_func ("/ModemManager/AT-serial/parse-differential/tests", at_serial_parse_differential_tests);
+    g_test_add_func ("/ModemManager/AT-serial/parse-differential/traces", at_serial_parse_differential_traces);
+    g_test_add_func ("/ModemManager/AT-serial/parse-differential/fuzz", at_serial_parse_differential_fuzz);
+    g_test_add_func ("/ModemManager/AT-serial/regex-literal-prefix", at_serial_regex_literal_prefix);
+    g_test_add_func ("/ModemManager/AT-serial/unsolicited-dispatch", at_serial_unsolicited_dispatch);
 
     return g_test_run ();
 }
@@ -17,6 +17,8 @@
 #include <string.h>
 #include <locale.h>
 
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
 #include "mm-modem-helpers.h"
 #include "mm-log-test.h"
 
@@ -446,6 +448,453 @@ test_charset_can_covert_to (void)
     }
 }
 
+/* Conversions handled by the fast paths must give exactly the same result
+ * as going through iconv */
+
+typedef struct {
+    MMModemCharset  charset;
+    const gchar    *iconv_name;
+} FastPathCharset;
+
+static const FastPathCharset fast_path_charsets[] = {
+    { MM_MODEM_CHARSET_IRA,    "ASCII"     },
+    { MM_MODEM_CHARSET_8859_1, "ISO8859-1" },
+    { MM_MODEM_CHARSET_UCS2,   "UCS-2BE"   },
+};
+
+static const gchar *fast_path_utf8_strings[] = {
+    "",
+    "T-Mobile",
+    "patín, ècole, ñ, ö, æ",
+    "Some from the GSM7 basic set: a % Ψ Ω ñ ö è æ",
+    "More from the GSM7 extended set: {} [] ~ € |",
+    "ホモ・サピエンス 喂人类 katakana, chinese, english",
+    "outside the BMP: \xf0\x9f\x98\x80",
+};
+
+static void
+test_fast_path_from_utf8 (void)
+{
+    guint i;
+    guint j;
+
+    for (i = 0; i < G_N_ELEMENTS (fast_path_charsets); i++) {
+        for (j = 0; j < G_N_ELEMENTS (fast_path_utf8_strings); j++) {
+            g_autofree gchar      *expected = NULL;
+            gsize                  expected_len = 0;
+            g_autofree gchar      *expected_translit = NULL;
+            gsize                  expected_translit_len = 0;
+            g_autoptr(GByteArray)  bytearray = NULL;
+            g_autoptr(GByteArray)  bytearray_translit = NULL;
+
+            expected = g_convert (fast_path_utf8_strings[j], -1,
+                                  fast_path_charsets[i].iconv_name, "UTF-8",
+                                  NULL, &expected_len, NULL);
+            bytearray = mm_modem_charset_bytearray_from_utf8 (fast_path_utf8_strings[j],
+                                                              fast_path_charsets[i].charset,
+                                                              FALSE, NULL);
+            if (!expected)
+                g_assert_null (bytearray);
+            else {
+                g_assert_nonnull (bytearray);
+                g_assert_cmpmem (bytearray->data, bytearray->len, expected, expected_len);
+            }
+
+            expected_translit = g_convert_with_fallback (fast_path_utf8_strings[j], -1,
+                                                         fast_path_charsets[i].iconv_name, "UTF-8", "?",
+                                                         NULL, &expected_translit_len, NULL);
+            bytearray_translit = mm_modem_charset_bytearray_from_utf8 (fast_path_utf8_strings[j],
+                                                                       fast_path_charsets[i].charset,
+                                                                       TRUE, NULL);
+            if (!expected_translit)
+                g_assert_null (bytearray_translit);
+            else {
+                g_assert_nonnull (bytearray_translit);
+                g_assert_cmpmem (bytearray_translit->data, bytearray_translit->len, expected_translit, expected_translit_len);
+            }
+        }
+    }
+}
+
+static void
+test_fast_path_to_utf8 (void)
+{
+    static const struct {
+        const guint8 *data;
+        guint         len;
+    } inputs[] = {
+        { (const guint8 *) "", 0 },
+        { (const guint8 *) "T-Mobile", 8 },
+        { (const guint8 *) "\x00T\x00-\x00M", 6 },
+        { (const guint8 *) "pat\xedn \xe8" "cole", 11 },
+        { (const guint8 *) "\x00\xed\x20\xac\x30\xdb\xff\xfd", 8 },
+        /* UCS-2: surrogate pair, not allowed */
+        { (const guint8 *) "\xd8\x3d\xde\x00", 4 },
+        /* UCS-2: partial character */
+        { (const guint8 *) "\x00T\x00", 3 },
+        /* embedded NUL */
+        { (const guint8 *) "ab\x00\x00" "cd", 6 },
+    };
+    guint i;
+    guint j;
+
+    for (i = 0; i < G_N_ELEMENTS (fast_path_charsets); i++) {
+        for (j = 0; j < G_N_ELEMENTS (inputs); j++) {
+            g_autofree gchar      *expected = NULL;
+            g_autofree gchar      *utf8 = NULL;
+            g_autoptr(GByteArray)  bytearray = NULL;
+
+            bytearray = g_byte_array_sized_new (inputs[j].len);
+            g_byte_array_append (bytearray, inputs[j].data, inputs[j].len);
+
+            expected = g_convert ((const gchar *) inputs[j].data, inputs[j].len,
+                                  "UTF-8", fast_path_charsets[i].iconv_name,
+                                  NULL, NULL, NULL);
+            utf8 = mm_modem_charset_bytearray_to_utf8 (bytearray, fast_path_charsets[i].charset, FALSE, NULL);
+            if (!expected)
+                g_assert_null (utf8);
+            else
+                g_assert_cmpstr (utf8, ==, expected);
+        }
+    }
+}
+
+/* Compare the fast paths and the cached converters against plain
+ * g_convert(), which opens a new iconv descriptor on every call */
+
+#define CONVERT_BENCHMARK_ITERATIONS 10000
+
+static gdouble
+convert_benchmark_g_convert (const gchar *iconv_name,
+                             guint        iterations)
+{
+    g_autoptr(GTimer) timer = NULL;
+    guint             i;
+    guint             j;
+
+    timer = g_timer_new ();
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < G_N_ELEMENTS (fast_path_utf8_strings); j++) {
+            g_autofree gchar *encoded = NULL;
+            g_autofree gchar *decoded = NULL;
+            gsize             encoded_len = 0;
+
+            encoded = g_convert_with_fallback (fast_path_utf8_strings[j], -1, iconv_name, "UTF-8", "?",
+                                               NULL, &encoded_len, NULL);
+            g_assert_nonnull (encoded);
+            decoded = g_convert (encoded, encoded_len, "UTF-8", iconv_name, NULL, NULL, NULL);
+            g_assert_nonnull (decoded);
+        }
+    }
+    return g_timer_elapsed (timer, NULL);
+}
+
+static gdouble
+convert_benchmark_charsets (MMModemCharset  charset,
+                            guint           iterations)
+{
+    g_autoptr(GTimer) timer = NULL;
+    guint             i;
+    guint             j;
+
+    timer = g_timer_new ();
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < G_N_ELEMENTS (fast_path_utf8_strings); j++) {
+            g_autoptr(GByteArray)  encoded = NULL;
+            g_autofree gchar      *decoded = NULL;
+
+            encoded = mm_modem_charset_bytearray_from_utf8 (fast_path_utf8_strings[j], charset, TRUE, NULL);
+            g_assert_nonnull (encoded);
+            decoded = mm_modem_charset_bytearray_to_utf8 (encoded, charset, FALSE, NULL);
+            g_assert_nonnull (decoded);
+        }
+    }
+    return g_timer_elapsed (timer, NULL);
+}
+
+static void
+test_convert_benchmark (void)
+{
+    static const FastPathCharset charsets[] = {
+        { MM_MODEM_CHARSET_IRA,     "ASCII"     },
+        { MM_MODEM_CHARSET_8859_1,  "ISO8859-1" },
+        { MM_MODEM_CHARSET_UCS2,    "UCS-2BE"   },
+        { MM_MODEM_CHARSET_PCCP437, "CP437"     },
+    };
+    guint iterations;
+    guint i;
+
+    iterations = g_test_perf () ? CONVERT_BENCHMARK_ITERATIONS : 1;
+
+    for (i = 0; i < G_N_ELEMENTS (charsets); i++) {
+        gdouble elapsed_g_convert;
+        gdouble elapsed_charsets;
+
+        elapsed_g_convert = convert_benchmark_g_convert (charsets[i].iconv_name, iterations);
+        elapsed_charsets = convert_benchmark_charsets (charsets[i].charset, iterations);
+
+        if (g_test_perf ()) {
+            g_test_message ("%s: g_convert():  %.3f ms", charsets[i].iconv_name, elapsed_g_convert * 1000.0);
+            g_test_message ("%s: mm-charsets:  %.3f ms", charsets[i].iconv_name, elapsed_charsets * 1000.0);
+            g_test_minimized_result (elapsed_charsets, "%s: %u round trips in %.3f ms",
+                                     charsets[i].iconv_name,
+                                     iterations * (guint) G_N_ELEMENTS (fast_path_utf8_strings),
+                                     elapsed_charsets * 1000.0);
+        }
+    }
+}
+
+/* Reference implementations, processing one septet or byte at a time, used
+ * to validate the block-based ones */
+
+static guint8 *
+reference_gsm_unpack (const guint8 *gsm,
+                      guint32       num_septets,
+                      guint8        start_offset,
+                      guint32      *out_unpacked_len)
+{
+    GByteArray *unpacked;
+    guint       i;
+
+    unpacked = g_byte_array_sized_new (num_septets + 1);
+    for (i = 0; i < num_septets; i++) {
+        guint8  bits_here, bits_in_next, octet, offset, c;
+        guint32 start_bit;
+
+        start_bit = start_offset + (i * 7);
+        offset = start_bit % 8;
+        bits_here = offset ? (8 - offset) : 7;
+        bits_in_next = 7 - bits_here;
+        octet = gsm[start_bit / 8];
+        c = (octet >> offset) & (0xFF >> (8 - bits_here));
+        if (bits_in_next) {
+            octet = gsm[(start_bit / 8) + 1];
+            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
+        }
+        g_byte_array_append (unpacked, &c, 1);
+    }
+    *out_unpacked_len = unpacked->len;
+    return g_byte_array_free (unpacked, FALSE);
+}
+
+static guint8 *
+reference_gsm_pack (const guint8 *src,
+                    guint32       src_len,
+                    guint8        start_offset,
+                    guint32      *out_packed_len)
+{
+    guint8 *packed;
+    guint   octet = 0, lshift, plen;
+    guint   i;
+
+    plen = (src_len * 7) + start_offset;
+    if (plen % 8)
+        plen += 8;
+    plen /= 8;
+    packed = g_malloc0 (plen);
+    for (i = 0, lshift = start_offset; i < src_len; i++) {
+        packed[octet] |= (src[i] & 0x7F) << lshift;
+        if (lshift > 1)
+            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
+        if (lshift)
+            octet++;
+        lshift = lshift ? lshift - 1 : 7;
+    }
+    *out_packed_len = plen;
+    return packed;
+}
+
+static gchar *
+reference_bin2hexstr (const guint8 *bin,
+                      gsize         len)
+{
+    GString *ret;
+    gsize    i;
+
+    ret = g_string_sized_new (len * 2 + 1);
+    for (i = 0; i < len; i++)
+        g_string_append_printf (ret, "%.2X", bin[i]);
+    return g_string_free (ret, FALSE);
+}
+
+#define FUZZ_MAX_LEN    300
+#define FUZZ_ITERATIONS 2000
+
+static void
+fuzz_random_bytes (guint8 *buf,
+                   guint   len)
+{
+    guint i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (guint8) g_test_rand_int_range (0, 256);
+}
+
+static void
+test_gsm7_pack_unpack_differential (void)
+{
+    guint8 buf[FUZZ_MAX_LEN];
+    guint  iteration;
+
+    for (iteration = 0; iteration < FUZZ_ITERATIONS; iteration++) {
+        guint8 start_offset;
+        guint  len;
+
+        len = g_test_rand_int_range (0, FUZZ_MAX_LEN);
+        start_offset = (guint8) g_test_rand_int_range (0, 8);
+        fuzz_random_bytes (buf, len);
+
+        /* Pack, even with the MSB set in the input septets */
+        {
+            g_autofree guint8 *packed = NULL;
+            g_autofree guint8 *expected = NULL;
+            guint32            packed_len = 0;
+            guint32            expected_len = 0;
+
+            packed = mm_charset_gsm_pack (buf, len, start_offset, &packed_len);
+            expected = reference_gsm_pack (buf, len, start_offset, &expected_len);
+            g_assert_cmpmem (packed, packed_len, expected, expected_len);
+        }
+
+        /* Unpack as many septets as fit in the buffer */
+        {
+            g_autofree guint8 *unpacked = NULL;
+            g_autofree guint8 *expected = NULL;
+            guint32            num_septets;
+            guint32            unpacked_len = 0;
+            guint32            expected_len = 0;
+
+            num_septets = (len * 8 > start_offset) ? ((len * 8 - start_offset) / 7) : 0;
+            unpacked = mm_charset_gsm_unpack (buf, num_septets, start_offset, &unpacked_len);
+            expected = reference_gsm_unpack (buf, num_septets, start_offset, &expected_len);
+            g_assert_cmpmem (unpacked, unpacked_len, expected, expected_len);
+        }
+    }
+}
+
+static void
+test_hex_differential (void)
+{
+    guint8 buf[FUZZ_MAX_LEN];
+    guint  iteration;
+
+    for (iteration = 0; iteration < FUZZ_ITERATIONS; iteration++) {
+        g_autofree gchar  *hex = NULL;
+        g_autofree gchar  *expected = NULL;
+        g_autofree guint8 *bin = NULL;
+        gsize              bin_len = 0;
+        g_autoptr(GError)  error = NULL;
+        guint              len;
+        guint              pos;
+
+        len = g_test_rand_int_range (1, FUZZ_MAX_LEN);
+        fuzz_random_bytes (buf, len);
+
+        hex = mm_utils_bin2hexstr (buf, len);
+        expected = reference_bin2hexstr (buf, len);
+        g_assert_cmpstr (hex, ==, expected);
+
+        /* Round trip, also with lowercase digits */
+        bin = mm_utils_hexstr2bin (hex, -1, &bin_len, &error);
+        g_assert_no_error (error);
+        g_assert_cmpmem (bin, bin_len, buf, len);
+        g_clear_pointer (&bin, g_free);
+
+        for (pos = 0; hex[pos]; pos++)
+            hex[pos] = g_ascii_tolower (hex[pos]);
+        bin = mm_utils_hexstr2bin (hex, -1, &bin_len, &error);
+        g_assert_no_error (error);
+        g_assert_cmpmem (bin, bin_len, buf, len);
+        g_clear_pointer (&bin, g_free);
+
+        /* A random non-hex char anywhere must be reported */
+        pos = g_test_rand_int_range (0, len * 2);
+        hex[pos] = (gchar) g_test_rand_int_range ('g', 'z' + 1);
+        bin = mm_utils_hexstr2bin (hex, -1, &bin_len, &error);
+        g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS);
+        g_assert_null (bin);
+    }
+}
+
+#define PDU_BENCHMARK_LEN        140
+#define PDU_BENCHMARK_ITERATIONS 100000
+
+static void
+test_pdu_kernels_benchmark (void)
+{
+    g_autoptr(GTimer) timer = NULL;
+    guint8            septets[PDU_BENCHMARK_LEN];
+    guint             iterations;
+    guint             i;
+    gdouble           elapsed_reference;
+    gdouble           elapsed;
+
+    iterations = g_test_perf () ? PDU_BENCHMARK_ITERATIONS : 1;
+    for (i = 0; i < PDU_BENCHMARK_LEN; i++)
+        septets[i] = i & 0x7F;
+
+    timer = g_timer_new ();
+
+    /* GSM-7 pack and unpack */
+    for (i = 0; i < iterations; i++) {
+        g_autofree guint8 *packed = NULL;
+        g_autofree guint8 *unpacked = NULL;
+        guint32            packed_len;
+        guint32            unpacked_len;
+
+        packed = reference_gsm_pack (septets, PDU_BENCHMARK_LEN, 0, &packed_len);
+        unpacked = reference_gsm_unpack (packed, PDU_BENCHMARK_LEN, 0, &unpacked_len);
+    }
+    elapsed_reference = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < iterations; i++) {
+        g_autofree guint8 *packed = NULL;
+        g_autofree guint8 *unpacked = NULL;
+        guint32            packed_len;
+        guint32            unpacked_len;
+
+        packed = mm_charset_gsm_pack (septets, PDU_BENCHMARK_LEN, 0, &packed_len);
+        unpacked = mm_charset_gsm_unpack (packed, PDU_BENCHMARK_LEN, 0, &unpacked_len);
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+
+    if (g_test_perf ()) {
+        g_test_message ("gsm7 pack+unpack: reference %.3f ms, current %.3f ms",
+                        elapsed_reference * 1000.0, elapsed * 1000.0);
+        g_test_minimized_result (elapsed, "gsm7: %.1f MB/s",
+                                 (iterations * PDU_BENCHMARK_LEN) / (elapsed * 1024.0 * 1024.0));
+    }
+
+    /* Hex encode and decode */
+    g_timer_start (timer);
+    for (i = 0; i < iterations; i++) {
+        g_autofree gchar *hex = NULL;
+
+        hex = reference_bin2hexstr (septets, PDU_BENCHMARK_LEN);
+    }
+    elapsed_reference = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < iterations; i++) {
+        g_autofree gchar  *hex = NULL;
+        g_autofree guint8 *bin = NULL;
+        gsize              bin_len;
+
+        hex = mm_utils_bin2hexstr (septets, PDU_BENCHMARK_LEN);
+        bin = mm_utils_hexstr2bin (hex, -1, &bin_len, NULL);
+        g_assert_nonnull (bin);
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+
+    if (g_test_perf ()) {
+        g_test_message ("hex encode: reference %.3f ms; encode+decode: current %.3f ms",
+                        elapsed_reference * 1000.0, elapsed * 1000.0);
+        g_test_minimized_result (elapsed, "hex: %.1f MB/s",
+                                 (iterations * PDU_BENCHMARK_LEN) / (elapsed * 1024.0 * 1024.0));
+    }
+}
+
 int main (int argc, char **argv)
 {
     setlocale (LC_ALL, "");
@@ -464,6 +913,10 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/charsets/gsm7/pack/24-chars",          test_gsm7_pack_24_chars);
     g_test_add_func ("/MM/charsets/gsm7/pack/last-septet-alone", test_gsm7_pack_last_septet_alone);
     g_test_add_func ("/MM/charsets/gsm7/pack/7-chars-offset",    test_gsm7_pack_7_chars_offset);
+    g_test_add_func ("/MM/charsets/gsm7/pack-unpack/differential", test_gsm7_pack_unpack_differential);
+
+    g_test_add_func ("/MM/charsets/hex/differential",             test_hex_differential);
+    g_test_add_func ("/MM/charsets/pdu-kernels-benchmark",        test_pdu_kernels_benchmark);
 
     g_test_add_func ("/MM/charsets/str-from-to/ucs2",         test_str_ucs2_to_from_utf8);
     g_test_add_func ("/MM/charsets/str-from-to/gsm",          test_str_gsm_to_from_utf8);
@@ -471,5 +924,9 @@ int main (int argc, char **argv)
 
     g_test_add_func ("/MM/charsets/can-convert-to", test_charset_can_covert_to);
 
+    g_test_add_func ("/MM/charsets/fast-path/from-utf8", test_fast_path_from_utf8);
+    g_test_add_func ("/MM/charsets/fast-path/to-utf8",   test_fast_path_to_utf8);
+    g_test_add_func ("/MM/charsets/convert-benchmark",   test_convert_benchmark);
+
     return g_test_run ();
 }
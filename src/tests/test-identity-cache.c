@@ -0,0 +1,223 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <locale.h>
+
+#include "mm-identity-cache.h"
+#include "mm-log-test.h"
+
+#define TEST_DEVICE "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-2"
+
+static gchar *
+common_setup_path (void)
+{
+    g_autoptr(GError)  error = NULL;
+    g_autofree gchar  *dir = NULL;
+
+    dir = g_dir_make_tmp ("mm-identity-cache-XXXXXX", &error);
+    g_assert_no_error (error);
+    g_assert (dir);
+
+    /* Use a subdirectory, to check it's created on demand */
+    return g_build_filename (dir, "state", MM_IDENTITY_CACHE_FILENAME, NULL);
+}
+
+static void
+common_cleanup_path (const gchar *path)
+{
+    g_autofree gchar *state_dir = NULL;
+    g_autofree gchar *dir = NULL;
+
+    state_dir = g_path_get_dirname (path);
+    dir = g_path_get_dirname (state_dir);
+    g_unlink (path);
+    g_rmdir (state_dir);
+    g_rmdir (dir);
+}
+
+/*****************************************************************************/
+
+static void
+test_roundtrip (void)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *str = NULL;
+    guint             val = 0;
+
+    path = common_setup_path ();
+
+    mm_identity_cache_setup (path);
+    g_assert (mm_identity_cache_is_enabled ());
+    g_assert (!mm_identity_cache_has_device (TEST_DEVICE));
+
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION, "M0.1.2");
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL, "Some model");
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MANUFACTURER, NULL);
+    mm_identity_cache_set_uint   (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_VENDOR_ID, 0x1199);
+    g_assert (mm_identity_cache_has_device (TEST_DEVICE));
+    mm_identity_cache_shutdown ();
+    g_assert (!mm_identity_cache_is_enabled ());
+
+    /* Reload from disk */
+    mm_identity_cache_setup (path);
+    g_assert (mm_identity_cache_has_device (TEST_DEVICE));
+
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION);
+    g_assert_cmpstr (str, ==, "M0.1.2");
+    g_clear_pointer (&str, g_free);
+
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL);
+    g_assert_cmpstr (str, ==, "Some model");
+    g_clear_pointer (&str, g_free);
+
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MANUFACTURER);
+    g_assert (!str);
+
+    g_assert (mm_identity_cache_has_key (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION));
+    g_assert (!mm_identity_cache_has_key (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_IMSI));
+
+    g_assert (mm_identity_cache_get_uint (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_VENDOR_ID, &val));
+    g_assert_cmpuint (val, ==, 0x1199);
+    g_assert (!mm_identity_cache_get_uint (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_PRODUCT_ID, &val));
+
+    /* Remove a single key, and then the whole device */
+    mm_identity_cache_remove_key (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL);
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL);
+    g_assert (!str);
+    mm_identity_cache_remove_device (TEST_DEVICE);
+    g_assert (!mm_identity_cache_has_device (TEST_DEVICE));
+    mm_identity_cache_shutdown ();
+
+    mm_identity_cache_setup (path);
+    g_assert (!mm_identity_cache_has_device (TEST_DEVICE));
+    mm_identity_cache_shutdown ();
+
+    common_cleanup_path (path);
+}
+
+static void
+test_unsupported_version (void)
+{
+    g_autoptr(GError)  error = NULL;
+    g_autofree gchar  *path = NULL;
+    g_autofree gchar  *dir = NULL;
+    static const gchar *contents =
+        "[cache]\n"
+        "Version=0\n"
+        "\n"
+        "[" TEST_DEVICE "]\n"
+        "Revision=M0.1.2\n";
+
+    path = common_setup_path ();
+    dir = g_path_get_dirname (path);
+    g_assert_cmpint (g_mkdir_with_parents (dir, 0700), ==, 0);
+    g_file_set_contents (path, contents, -1, &error);
+    g_assert_no_error (error);
+
+    mm_identity_cache_setup (path);
+    g_assert (mm_identity_cache_is_enabled ());
+    g_assert (!mm_identity_cache_has_device (TEST_DEVICE));
+    mm_identity_cache_shutdown ();
+
+    common_cleanup_path (path);
+}
+
+static void
+test_disabled (void)
+{
+    g_autofree gchar *str = NULL;
+
+    mm_identity_cache_setup (NULL);
+    g_assert (!mm_identity_cache_is_enabled ());
+
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION, "M0.1.2");
+    g_assert (!mm_identity_cache_has_device (TEST_DEVICE));
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION);
+    g_assert (!str);
+
+    mm_identity_cache_shutdown ();
+}
+
+static void
+test_invalid_input (void)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *str = NULL;
+
+    path = common_setup_path ();
+    mm_identity_cache_setup (path);
+
+    /* Device names that cannot be used as group names are ignored */
+    mm_identity_cache_set_string ("[weird]", MM_IDENTITY_CACHE_KEY_REVISION, "M0.1.2");
+    g_assert (!mm_identity_cache_has_device ("[weird]"));
+    mm_identity_cache_set_string ("cache", MM_IDENTITY_CACHE_KEY_REVISION, "M0.1.2");
+    g_assert (!mm_identity_cache_has_device ("cache"));
+
+    /* Multiline values are not stored */
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL, "Some model");
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL, "Some\r\nmodel");
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_MODEL);
+    g_assert (!str);
+
+    mm_identity_cache_shutdown ();
+    common_cleanup_path (path);
+}
+
+static void
+test_remove_keys_with_prefix (void)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *str = NULL;
+
+    path = common_setup_path ();
+    mm_identity_cache_setup (path);
+
+    mm_identity_cache_set_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION, "M0.1.2");
+    mm_identity_cache_set_uint   (TEST_DEVICE, "Probe.tty.option.if00.Flags", 1);
+    mm_identity_cache_set_uint   (TEST_DEVICE, "Probe.tty.option.if02.Flags", 1);
+    mm_identity_cache_set_uint   (TEST_DEVICE "/other", "Probe.tty.option.if00.Flags", 1);
+
+    mm_identity_cache_remove_keys_with_prefix ("Probe.");
+    g_assert (!mm_identity_cache_has_key (TEST_DEVICE, "Probe.tty.option.if00.Flags"));
+    g_assert (!mm_identity_cache_has_key (TEST_DEVICE, "Probe.tty.option.if02.Flags"));
+    g_assert (!mm_identity_cache_has_key (TEST_DEVICE "/other", "Probe.tty.option.if00.Flags"));
+
+    /* Other keys are kept */
+    str = mm_identity_cache_get_string (TEST_DEVICE, MM_IDENTITY_CACHE_KEY_REVISION);
+    g_assert_cmpstr (str, ==, "M0.1.2");
+
+    mm_identity_cache_shutdown ();
+    common_cleanup_path (path);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/identity-cache/roundtrip",           test_roundtrip);
+    g_test_add_func ("/MM/identity-cache/unsupported-version", test_unsupported_version);
+    g_test_add_func ("/MM/identity-cache/disabled",            test_disabled);
+    g_test_add_func ("/MM/identity-cache/invalid-input",       test_invalid_input);
+    g_test_add_func ("/MM/identity-cache/remove-prefix",       test_remove_keys_with_prefix);
+
+    return g_test_run ();
+}
@@ -18,6 +18,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <locale.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
 
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
@@ -106,13 +109,147 @@ test_string_match (void)
 
 /*****************************************************************************/
 
+typedef struct {
+    const gchar *name;
+    const gchar *number;
+    const gchar *class;
+    const gchar *driver;
+} FakeUsbInterface;
+
+static gchar *
+fake_usb_device_new (const gchar            *num_interfaces,
+                     const FakeUsbInterface *interfaces,
+                     guint                   n_interfaces)
+{
+    g_autoptr(GError)  error = NULL;
+    g_autofree gchar  *root = NULL;
+    gchar             *physdev;
+    gchar             *aux;
+    guint              i;
+
+    root = g_dir_make_tmp ("mm-kernel-device-helpers-XXXXXX", &error);
+    g_assert_no_error (error);
+
+    physdev = g_build_filename (root, "1-2", NULL);
+    g_assert_cmpint (g_mkdir_with_parents (physdev, 0700), ==, 0);
+
+    aux = g_build_filename (physdev, "bNumInterfaces", NULL);
+    g_file_set_contents (aux, num_interfaces, -1, &error);
+    g_assert_no_error (error);
+    g_free (aux);
+
+    for (i = 0; i < n_interfaces; i++) {
+        g_autofree gchar *interface = NULL;
+
+        interface = g_build_filename (physdev, interfaces[i].name, NULL);
+        g_assert_cmpint (g_mkdir_with_parents (interface, 0700), ==, 0);
+
+        aux = g_build_filename (interface, "bInterfaceNumber", NULL);
+        g_file_set_contents (aux, interfaces[i].number, -1, &error);
+        g_assert_no_error (error);
+        g_free (aux);
+
+        aux = g_build_filename (interface, "bInterfaceClass", NULL);
+        g_file_set_contents (aux, interfaces[i].class, -1, &error);
+        g_assert_no_error (error);
+        g_free (aux);
+
+        if (interfaces[i].driver) {
+            g_autofree gchar *driver = NULL;
+
+            driver = g_build_filename (root, "drivers", interfaces[i].driver, NULL);
+            g_assert_cmpint (g_mkdir_with_parents (driver, 0700), ==, 0);
+            aux = g_build_filename (interface, "driver", NULL);
+            g_assert_cmpint (symlink (driver, aux), ==, 0);
+            g_free (aux);
+        }
+    }
+
+    return physdev;
+}
+
+static void
+remove_recursive (const gchar *path)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    /* Symlinks are removed, never followed */
+    if (!g_file_test (path, G_FILE_TEST_IS_SYMLINK) && (dir = g_dir_open (path, 0, NULL)) != NULL) {
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            g_autofree gchar *child = NULL;
+
+            child = g_build_filename (path, name, NULL);
+            remove_recursive (child);
+        }
+        g_dir_close (dir);
+    }
+    g_remove (path);
+}
+
+static void
+fake_usb_device_free (gchar *physdev)
+{
+    g_autofree gchar *root = NULL;
+
+    root = g_path_get_dirname (physdev);
+    remove_recursive (root);
+    g_free (physdev);
+}
+
+static void
+test_usb_port_interfaces (void)
+{
+    static const FakeUsbInterface interfaces[] = {
+        { "1-2:1.0", "00", "ff", "option"        },
+        { "1-2:1.2", "02", "ff", "option"        },
+        { "1-2:1.4", "04", "08", "usb-storage"   },
+        { "1-2:1.8", "0c", "02", "cdc_mbim"      },
+        { "1-2:1.9", "0d", "0a", "cdc_mbim"      },
+        { "1-2:1.6", "06", "03", "usbhid"        },
+        { "1-2:1.7", "07", "ff", "usbfs"         },
+    };
+    gchar   *physdev;
+    guint64  mask = 0;
+
+    /* All interfaces registered and bound */
+    physdev = fake_usb_device_new (" 7", interfaces, G_N_ELEMENTS (interfaces));
+    g_assert (mm_kernel_device_get_usb_port_interfaces (physdev, &mask));
+    g_assert_cmphex (mask, ==, (1 << 0x00) | (1 << 0x02) | (1 << 0x0c));
+    fake_usb_device_free (physdev);
+
+    /* Not all interfaces registered yet */
+    physdev = fake_usb_device_new (" 8", interfaces, G_N_ELEMENTS (interfaces));
+    g_assert (!mm_kernel_device_get_usb_port_interfaces (physdev, &mask));
+    fake_usb_device_free (physdev);
+}
+
+static void
+test_usb_port_interfaces_unbound (void)
+{
+    static const FakeUsbInterface interfaces[] = {
+        { "1-2:1.0", "00", "ff", "qmi_wwan" },
+        { "1-2:1.1", "01", "ff", NULL       },
+    };
+    gchar   *physdev;
+    guint64  mask = 0;
+
+    physdev = fake_usb_device_new (" 2", interfaces, G_N_ELEMENTS (interfaces));
+    g_assert (!mm_kernel_device_get_usb_port_interfaces (physdev, &mask));
+    fake_usb_device_free (physdev);
+}
+
+/*****************************************************************************/
+
 int main (int argc, char **argv)
 {
     setlocale (LC_ALL, "");
 
     g_test_init (&argc, &argv, NULL);
 
-    g_test_add_func ("/MM/kernel-device-helpers/string-match", test_string_match);
+    g_test_add_func ("/MM/kernel-device-helpers/string-match",                test_string_match);
+    g_test_add_func ("/MM/kernel-device-helpers/usb-port-interfaces",         test_usb_port_interfaces);
+    g_test_add_func ("/MM/kernel-device-helpers/usb-port-interfaces-unbound", test_usb_port_interfaces_unbound);
 
     return g_test_run ();
 }
@@ -0,0 +1,196 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <locale.h>
+
+#include "mm-log-object.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+/* Test log object, counting how many times its id is built */
+
+#define TEST_TYPE_LOG_OBJECT test_log_object_get_type ()
+G_DECLARE_FINAL_TYPE (TestLogObject, test_log_object, TEST, LOG_OBJECT, GObject)
+
+struct _TestLogObject {
+    GObject parent;
+    guint   n_build_id;
+};
+
+static void log_object_iface_init (MMLogObjectInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestLogObject, test_log_object, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (MM_TYPE_LOG_OBJECT, log_object_iface_init))
+
+static gchar *
+log_object_build_id (MMLogObject *_self)
+{
+    TestLogObject *self = TEST_LOG_OBJECT (_self);
+
+    self->n_build_id++;
+    return g_strdup ("test");
+}
+
+static void
+log_object_iface_init (MMLogObjectInterface *iface)
+{
+    iface->build_id = log_object_build_id;
+}
+
+static void
+test_log_object_init (TestLogObject *self)
+{
+}
+
+static void
+test_log_object_class_init (TestLogObjectClass *klass)
+{
+}
+
+/*****************************************************************************/
+
+static guint n_evaluated;
+
+static const gchar *
+evaluate (void)
+{
+    n_evaluated++;
+    return "evaluated";
+}
+
+static void
+test_level_check (void)
+{
+    guint32 saved_level;
+
+    saved_level = _mm_log_level;
+
+    n_evaluated = 0;
+    _mm_log_level = MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO;
+    mm_obj_dbg (NULL, "message: %s", evaluate ());
+    g_assert_cmpuint (n_evaluated, ==, 0);
+    mm_obj_info (NULL, "message: %s", evaluate ());
+    g_assert_cmpuint (n_evaluated, ==, 1);
+
+    _mm_log_level |= MM_LOG_LEVEL_DEBUG;
+    mm_obj_dbg (NULL, "message: %s", evaluate ());
+#if defined MM_LOG_NO_DEBUG
+    g_assert_cmpuint (n_evaluated, ==, 1);
+#else
+    g_assert_cmpuint (n_evaluated, ==, 2);
+#endif
+
+    _mm_log_level = saved_level;
+}
+
+/*****************************************************************************/
+
+static void
+test_object_id (void)
+{
+    g_autoptr(TestLogObject) obj = NULL;
+
+    obj = g_object_new (TEST_TYPE_LOG_OBJECT, NULL);
+
+    g_assert_cmpstr (mm_log_object_get_id (MM_LOG_OBJECT (obj)), ==, "test");
+    g_assert_cmpstr (mm_log_object_get_id (MM_LOG_OBJECT (obj)), ==, "test");
+    g_assert_cmpuint (obj->n_build_id, ==, 1);
+
+    /* Setting a new owner invalidates the cached id, setting the same one
+     * doesn't */
+    mm_log_object_set_owner_id (MM_LOG_OBJECT (obj), "owner");
+    g_assert_cmpstr (mm_log_object_get_id (MM_LOG_OBJECT (obj)), ==, "owner/test");
+    g_assert_cmpuint (obj->n_build_id, ==, 2);
+    mm_log_object_set_owner_id (MM_LOG_OBJECT (obj), "owner");
+    g_assert_cmpstr (mm_log_object_get_id (MM_LOG_OBJECT (obj)), ==, "owner/test");
+    g_assert_cmpuint (obj->n_build_id, ==, 2);
+
+    mm_log_object_reset_id (MM_LOG_OBJECT (obj));
+    g_assert_cmpstr (mm_log_object_get_id (MM_LOG_OBJECT (obj)), ==, "owner/test");
+    g_assert_cmpuint (obj->n_build_id, ==, 3);
+}
+
+/*****************************************************************************/
+/* Only run in perf mode (-m perf) */
+
+#define BENCHMARK_ITERATIONS 10000000
+
+static void
+test_benchmark (void)
+{
+    g_autoptr(TestLogObject) obj = NULL;
+    g_autoptr(GTimer)        timer = NULL;
+    guint32                  saved_level;
+    guint                    i;
+    gdouble                  elapsed;
+
+    if (!g_test_perf ()) {
+        g_test_skip ("only run in perf mode");
+        return;
+    }
+
+    obj = g_object_new (TEST_TYPE_LOG_OBJECT, NULL);
+    timer = g_timer_new ();
+    saved_level = _mm_log_level;
+
+    /* Disabled debug message: just the level check */
+    _mm_log_level = MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO;
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+        mm_obj_dbg (obj, "message %u: %s", i, evaluate ());
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_test_minimized_result (elapsed * 1e9 / BENCHMARK_ITERATIONS,
+                             "disabled debug message: %.2f ns/call",
+                             elapsed * 1e9 / BENCHMARK_ITERATIONS);
+
+    /* Enabled message, without the backend */
+    _mm_log_level |= MM_LOG_LEVEL_DEBUG;
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+        mm_obj_dbg (obj, "message %u: %s", i, evaluate ());
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_test_minimized_result (elapsed * 1e9 / BENCHMARK_ITERATIONS,
+                             "enabled debug message (no output): %.2f ns/call",
+                             elapsed * 1e9 / BENCHMARK_ITERATIONS);
+
+    /* Cached object id lookup */
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+        mm_log_object_get_id (MM_LOG_OBJECT (obj));
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_test_minimized_result (elapsed * 1e9 / BENCHMARK_ITERATIONS,
+                             "cached object id: %.2f ns/call",
+                             elapsed * 1e9 / BENCHMARK_ITERATIONS);
+    g_assert_cmpuint (obj->n_build_id, ==, 1);
+
+    _mm_log_level = saved_level;
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/log/level-check", test_level_check);
+    g_test_add_func ("/MM/log/object-id",   test_object_id);
+    g_test_add_func ("/MM/log/benchmark",   test_benchmark);
+
+    return g_test_run ();
+}
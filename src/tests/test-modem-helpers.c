@@ -4594,6 +4594,114 @@ test_cpol_response (void)
     }
 }
 
+/*****************************************************************************/
+/* Test NMEA sentence framing */
+
+static void
+nmea_sentence_collect (const gchar *sentence,
+                       GPtrArray   *sentences)
+{
+    g_ptr_array_add (sentences, g_strdup (sentence));
+}
+
+static void
+test_nmea_parse_sentences (void)
+{
+    g_autoptr(GByteArray) buffer = NULL;
+    g_autoptr(GByteArray) other = NULL;
+    g_autoptr(GPtrArray)  sentences = NULL;
+    guint                 n_sentences;
+    static const gchar   *chunk1 =
+        "$GPGGA,102000.00,5130.12340,N,00712.56840,E,1,09,0.8,120.0,M,47.0,M,,*66\r\n"
+        "OK\r\n"
+        "$GPGSA,A,3,02,05,06,09,12,13,17,19,20,,,,1.5,0.8,1.2*00\r\n" /* wrong checksum */
+        "$GPVTG,90.0,T,,M,12.0,N,22.2,K,A\r\n"                           /* no checksum */
+        "$GPRMC,102000.00,A,5130.12";
+    static const gchar   *chunk2 =
+        "340,N,00712.56840,E,12.0,90.0,170922,,,A*50\r\n";
+
+    buffer = g_byte_array_new ();
+    other = g_byte_array_new ();
+    sentences = g_ptr_array_new_with_free_func (g_free);
+
+    g_byte_array_append (buffer, (const guint8 *) chunk1, strlen (chunk1));
+    n_sentences = mm_nmea_parse_sentences (buffer, other, (MMNmeaSentenceFn) nmea_sentence_collect, sentences);
+    g_assert_cmpuint (n_sentences, ==, 2);
+    g_assert_cmpuint (sentences->len, ==, 2);
+    g_assert_cmpstr (g_ptr_array_index (sentences, 0), ==, "$GPGGA,102000.00,5130.12340,N,00712.56840,E,1,09,0.8,120.0,M,47.0,M,,*66\r\n");
+    g_assert_cmpstr (g_ptr_array_index (sentences, 1), ==, "$GPVTG,90.0,T,,M,12.0,N,22.2,K,A\r\n");
+    g_assert_cmpuint (other->len, ==, 4);
+    g_assert (memcmp (other->data, "OK\r\n", 4) == 0);
+
+    /* The incomplete sentence is kept until the rest arrives */
+    g_assert_cmpuint (buffer->len, ==, strlen ("$GPRMC,102000.00,A,5130.12"));
+
+    g_byte_array_append (buffer, (const guint8 *) chunk2, strlen (chunk2));
+    n_sentences = mm_nmea_parse_sentences (buffer, NULL, (MMNmeaSentenceFn) nmea_sentence_collect, sentences);
+    g_assert_cmpuint (n_sentences, ==, 1);
+    g_assert_cmpuint (sentences->len, ==, 3);
+    g_assert_cmpstr (g_ptr_array_index (sentences, 2), ==, "$GPRMC,102000.00,A,5130.12340,N,00712.56840,E,12.0,90.0,170922,,,A*50\r\n");
+    g_assert_cmpuint (buffer->len, ==, 0);
+}
+
+static void
+nmea_sentence_count (const gchar *sentence,
+                     gsize       *total_len)
+{
+    *total_len += strlen (sentence);
+}
+
+/* Throughput of the NMEA framing, feeding a recorded trace in chunks of the
+ * same size as the ones read from the serial port */
+static void
+test_nmea_parse_sentences_recorded (void)
+{
+    g_autoptr(GError)      error = NULL;
+    g_autoptr(GByteArray)  buffer = NULL;
+    g_autoptr(GTimer)      timer = NULL;
+    g_autofree gchar      *path = NULL;
+    g_autofree gchar      *contents = NULL;
+    gsize                  contents_len = 0;
+    guint                  n_lines = 0;
+    guint                  n_sentences = 0;
+    guint                  iterations;
+    guint                  i;
+    gsize                  total_len = 0;
+    gdouble                elapsed;
+
+    path = g_build_filename (TESTDATADIR, "nmea-trace.txt", NULL);
+    g_file_get_contents (path, &contents, &contents_len, &error);
+    g_assert_no_error (error);
+
+    for (i = 0; i < contents_len; i++) {
+        if (contents[i] == '\n')
+            n_lines++;
+    }
+
+    buffer = g_byte_array_new ();
+    timer = g_timer_new ();
+    iterations = g_test_perf () ? 1000 : 1;
+    for (i = 0; i < iterations; i++) {
+        gsize pos;
+
+        for (pos = 0; pos < contents_len; pos += 256) {
+            g_byte_array_append (buffer, (const guint8 *) &contents[pos], MIN (256, contents_len - pos));
+            n_sentences += mm_nmea_parse_sentences (buffer, NULL, (MMNmeaSentenceFn) nmea_sentence_count, &total_len);
+        }
+        g_assert_cmpuint (buffer->len, ==, 0);
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+
+    /* All sentences in the recorded trace are valid */
+    g_assert_cmpuint (n_sentences, ==, n_lines * iterations);
+    g_assert_cmpuint (total_len, ==, contents_len * iterations);
+
+    if (g_test_perf ())
+        g_test_minimized_result (elapsed, "%u sentences in %.3f ms (%.1f MB/s)",
+                                 n_sentences, elapsed * 1000.0,
+                                 (total_len / (1024.0 * 1024.0)) / elapsed);
+}
+
 /*****************************************************************************/
 
 #define TESTCASE(t, d) g_test_create_case (#t, 0, d, NULL, (GTestFixtureFunc) t, NULL)
@@ -4830,6 +4938,9 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_cpol_response, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_nmea_parse_sentences, NULL));
+    g_test_suite_add (suite, TESTCASE (test_nmea_parse_sentences_recorded, NULL));
+
     result = g_test_run ();
 
     reg_test_data_free (reg_data);
@@ -0,0 +1,453 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <locale.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+/* The SMS list is built right into the test, along with a minimal MMBaseSms
+ * implementation, as the real one needs a whole modem object */
+#include "mm-sms-list.c"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+/* Minimal MMBaseModem and MMBaseSms implementations */
+
+G_DEFINE_ABSTRACT_TYPE (MMBaseModem, mm_base_modem, MM_GDBUS_TYPE_OBJECT_SKELETON)
+
+static void
+mm_base_modem_init (MMBaseModem *self)
+{
+}
+
+static void
+mm_base_modem_class_init (MMBaseModemClass *klass)
+{
+}
+
+struct _MMBaseSmsPrivate {
+    gchar        *path;
+    MMSmsStorage  storage;
+    GList        *parts;
+    gboolean      is_multipart;
+    guint         max_parts;
+    guint         multipart_reference;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (MMBaseSms, mm_base_sms, MM_GDBUS_TYPE_SMS_SKELETON)
+
+static guint sms_path_id;
+
+static MMBaseSms *
+test_sms_new (MMSmsStorage  storage,
+              MMSmsPart    *part,
+              gboolean      is_multipart,
+              guint         reference,
+              guint         max_parts)
+{
+    MMBaseSms *self;
+
+    self = g_object_new (MM_TYPE_BASE_SMS, NULL);
+    self->priv->storage = storage;
+    self->priv->is_multipart = is_multipart;
+    self->priv->multipart_reference = reference;
+    self->priv->max_parts = max_parts;
+    self->priv->parts = g_list_append (NULL, part);
+    self->priv->path = g_strdup_printf ("/org/freedesktop/ModemManager1/SMS/%u", sms_path_id++);
+    mm_gdbus_sms_set_number (MM_GDBUS_SMS (self), mm_sms_part_get_number (part));
+    mm_gdbus_sms_set_pdu_type (MM_GDBUS_SMS (self), mm_sms_part_get_pdu_type (part));
+    return self;
+}
+
+MMBaseSms *
+mm_base_sms_singlepart_new (MMBaseModem  *modem,
+                            MMSmsState    state,
+                            MMSmsStorage  storage,
+                            MMSmsPart    *part,
+                            GError      **error)
+{
+    return test_sms_new (storage, part, FALSE, 0, 1);
+}
+
+MMBaseSms *
+mm_base_sms_multipart_new (MMBaseModem  *modem,
+                           MMSmsState    state,
+                           MMSmsStorage  storage,
+                           guint         reference,
+                           guint         max_parts,
+                           MMSmsPart    *first_part,
+                           GError      **error)
+{
+    return test_sms_new (storage, first_part, TRUE, reference, max_parts);
+}
+
+gboolean
+mm_base_sms_multipart_take_part (MMBaseSms  *self,
+                                 MMSmsPart  *part,
+                                 GError    **error)
+{
+    if (g_list_length (self->priv->parts) >= self->priv->max_parts) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Already took %u parts, cannot take more",
+                     g_list_length (self->priv->parts));
+        return FALSE;
+    }
+
+    self->priv->parts = g_list_append (self->priv->parts, part);
+    return TRUE;
+}
+
+void
+mm_base_sms_unexport (MMBaseSms *self)
+{
+}
+
+const gchar *
+mm_base_sms_get_path (MMBaseSms *self)
+{
+    return self->priv->path;
+}
+
+MMSmsStorage
+mm_base_sms_get_storage (MMBaseSms *self)
+{
+    return self->priv->storage;
+}
+
+gboolean
+mm_base_sms_has_part_index (MMBaseSms *self,
+                            guint      index)
+{
+    GList *l;
+
+    for (l = self->priv->parts; l; l = g_list_next (l)) {
+        if (mm_sms_part_get_index ((MMSmsPart *) l->data) == index)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+GList *
+mm_base_sms_get_parts (MMBaseSms *self)
+{
+    return self->priv->parts;
+}
+
+gboolean
+mm_base_sms_is_multipart (MMBaseSms *self)
+{
+    return self->priv->is_multipart;
+}
+
+guint
+mm_base_sms_get_multipart_reference (MMBaseSms *self)
+{
+    return self->priv->multipart_reference;
+}
+
+void
+mm_base_sms_delete (MMBaseSms           *self,
+                    GAsyncReadyCallback  callback,
+                    gpointer             user_data)
+{
+    GTask *task;
+
+    task = g_task_new (self, NULL, callback, user_data);
+    g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+gboolean
+mm_base_sms_delete_finish (MMBaseSms     *self,
+                           GAsyncResult  *res,
+                           GError       **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+mm_base_sms_init (MMBaseSms *self)
+{
+    self->priv = mm_base_sms_get_instance_private (self);
+}
+
+static void
+base_sms_finalize (GObject *object)
+{
+    MMBaseSms *self = MM_BASE_SMS (object);
+
+    g_list_free_full (self->priv->parts, (GDestroyNotify) mm_sms_part_free);
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mm_base_sms_parent_class)->finalize (object);
+}
+
+static void
+mm_base_sms_class_init (MMBaseSmsClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->finalize = base_sms_finalize;
+}
+
+/*****************************************************************************/
+
+static MMSmsPart *
+build_part (guint        index,
+            const gchar *number,
+            guint        reference,
+            guint        sequence,
+            guint        max)
+{
+    MMSmsPart *part;
+
+    part = mm_sms_part_new (index, MM_SMS_PDU_TYPE_DELIVER);
+    mm_sms_part_set_number (part, number);
+    if (reference) {
+        mm_sms_part_set_concat_reference (part, reference);
+        mm_sms_part_set_concat_sequence (part, sequence);
+        mm_sms_part_set_concat_max (part, max);
+    }
+    return part;
+}
+
+static void
+take_part (MMSmsList *list,
+           MMSmsPart *part)
+{
+    g_autoptr(GError) error = NULL;
+    gboolean          taken;
+
+    taken = mm_sms_list_take_part (list, part, MM_SMS_STATE_RECEIVED, MM_SMS_STORAGE_SM, &error);
+    g_assert_no_error (error);
+    g_assert_true (taken);
+}
+
+typedef struct {
+    gboolean  done;
+    gboolean  deleted;
+    guint     n_deleted_signals;
+    GError   *error;
+} DeleteContext;
+
+static void
+sms_deleted_cb (MMSmsList     *list,
+                const gchar   *path,
+                DeleteContext *ctx)
+{
+    ctx->n_deleted_signals++;
+}
+
+static void
+delete_sms_ready (MMSmsList     *list,
+                  GAsyncResult  *res,
+                  DeleteContext *ctx)
+{
+    ctx->deleted = mm_sms_list_delete_sms_finish (list, res, &ctx->error);
+    ctx->done = TRUE;
+}
+
+static gboolean
+delete_sms (MMSmsList    *list,
+            const gchar  *path,
+            GError      **error)
+{
+    DeleteContext ctx = { 0 };
+    gulong        id;
+    guint         count;
+
+    count = mm_sms_list_get_count (list);
+    id = g_signal_connect (list, MM_SMS_DELETED, G_CALLBACK (sms_deleted_cb), &ctx);
+
+    mm_sms_list_delete_sms (list, path, (GAsyncReadyCallback) delete_sms_ready, &ctx);
+    while (!ctx.done)
+        g_main_context_iteration (NULL, TRUE);
+
+    g_signal_handler_disconnect (list, id);
+
+    if (!ctx.deleted) {
+        g_assert_cmpuint (ctx.n_deleted_signals, ==, 0);
+        g_assert_cmpuint (mm_sms_list_get_count (list), ==, count);
+        g_propagate_error (error, ctx.error);
+        return FALSE;
+    }
+
+    g_assert_cmpuint (ctx.n_deleted_signals, ==, 1);
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, count - 1);
+    return TRUE;
+}
+
+/* Path of the most recent message in the list */
+static gchar *
+peek_last_path (MMSmsList *list)
+{
+    g_auto(GStrv) paths = NULL;
+
+    paths = mm_sms_list_get_paths (list);
+    g_assert_nonnull (paths[0]);
+    return g_strdup (paths[0]);
+}
+
+/*****************************************************************************/
+
+#define N_LOAD_TEST_PARTS 1000
+
+static void
+test_load_parts (void)
+{
+    g_autoptr(MMSmsList) list = NULL;
+    g_autoptr(GTimer)    timer = NULL;
+    g_autoptr(GError)    error = NULL;
+    MMSmsPart           *part;
+    guint                i;
+
+    list = mm_sms_list_new (NULL);
+    timer = g_timer_new ();
+
+    /* Single-part messages first, then 2-part messages */
+    for (i = 0; i < N_LOAD_TEST_PARTS; i++) {
+        g_autofree gchar *number = NULL;
+
+        number = g_strdup_printf ("+3461234%04u", (i / 2) % 100);
+        if (i < N_LOAD_TEST_PARTS / 2)
+            part = build_part (i, number, 0, 0, 0);
+        else
+            part = build_part (i, number, 1 + (i - N_LOAD_TEST_PARTS / 2) / 2, 1 + (i % 2), 2);
+        take_part (list, part);
+    }
+
+    if (g_test_perf ())
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "loaded %u parts in %.3f ms",
+                                 N_LOAD_TEST_PARTS, g_timer_elapsed (timer, NULL) * 1000.0);
+
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, N_LOAD_TEST_PARTS / 2 + N_LOAD_TEST_PARTS / 4);
+    for (i = 0; i < N_LOAD_TEST_PARTS; i++)
+        g_assert_true (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, i));
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, N_LOAD_TEST_PARTS));
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_ME, 0));
+
+    /* A part with an index already taken is rejected */
+    part = build_part (0, "+34612340000", 0, 0, 0);
+    g_assert_false (mm_sms_list_take_part (list, part, MM_SMS_STATE_RECEIVED, MM_SMS_STORAGE_SM, &error));
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED);
+    mm_sms_part_free (part);
+}
+
+static void
+test_same_reference_different_number (void)
+{
+    g_autoptr(MMSmsList) list = NULL;
+
+    list = mm_sms_list_new (NULL);
+
+    /* Same reference from two senders must not be merged */
+    take_part (list, build_part (0, "+34600000001", 5, 1, 2));
+    take_part (list, build_part (1, "+34600000002", 5, 1, 2));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+
+    take_part (list, build_part (2, "+34600000001", 5, 2, 2));
+    take_part (list, build_part (3, "+34600000002", 5, 2, 2));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+}
+
+static void
+test_delete_singlepart (void)
+{
+    g_autoptr(MMSmsList) list = NULL;
+    g_autoptr(GError)    error = NULL;
+    g_autofree gchar    *path = NULL;
+
+    list = mm_sms_list_new (NULL);
+
+    take_part (list, build_part (0, "+34600000001", 0, 0, 0));
+    take_part (list, build_part (1, "+34600000002", 0, 0, 0));
+    path = peek_last_path (list);
+
+    g_assert_true (delete_sms (list, path, &error));
+    g_assert_no_error (error);
+    g_assert_true (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 0));
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 1));
+
+    /* Removed from the path index as well */
+    g_assert_false (delete_sms (list, path, &error));
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_NOT_FOUND);
+    g_clear_error (&error);
+
+    /* The index may be reused */
+    take_part (list, build_part (1, "+34600000003", 0, 0, 0));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+}
+
+static void
+test_delete_multipart_and_readd (void)
+{
+    g_autoptr(MMSmsList) list = NULL;
+    g_autoptr(GError)    error = NULL;
+    g_autofree gchar    *path = NULL;
+    g_autofree gchar    *readded_path = NULL;
+
+    list = mm_sms_list_new (NULL);
+
+    take_part (list, build_part (0, "+34600000001", 0, 0, 0));
+    take_part (list, build_part (1, "+34600000001", 7, 1, 2));
+    take_part (list, build_part (2, "+34600000001", 7, 2, 2));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+    path = peek_last_path (list);
+
+    /* Removing the message drops all its parts and its concat key */
+    g_assert_true (delete_sms (list, path, &error));
+    g_assert_no_error (error);
+    g_assert_true (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 0));
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 1));
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 2));
+
+    /* The same message received again, in the same storage slots, builds a
+     * new multipart message instead of reaching the removed one */
+    take_part (list, build_part (2, "+34600000001", 7, 2, 2));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+    readded_path = peek_last_path (list);
+    g_assert_cmpstr (readded_path, !=, path);
+
+    take_part (list, build_part (1, "+34600000001", 7, 1, 2));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+    g_assert_true (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 1));
+    g_assert_true (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 2));
+
+    /* And it can be removed again */
+    g_assert_true (delete_sms (list, readded_path, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 1);
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 1));
+    g_assert_false (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 2));
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/SMS/List/load-1000-parts", test_load_parts);
+    g_test_add_func ("/MM/SMS/List/same-reference-different-number", test_same_reference_different_number);
+    g_test_add_func ("/MM/SMS/List/delete-singlepart", test_delete_singlepart);
+    g_test_add_func ("/MM/SMS/List/delete-multipart-and-readd", test_delete_multipart_and_readd);
+
+    return g_test_run ();
+}
@@ -0,0 +1,195 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <locale.h>
+
+#include "mm-timer-wheel.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+/* Timers are driven by a fake clock, so that the tests don't depend on how
+ * long the main loop takes to dispatch */
+static gint64 fake_clock;
+
+static gint64
+fake_clock_cb (gpointer user_data)
+{
+    return fake_clock;
+}
+
+static MMTimerWheel *
+timer_wheel_new (void)
+{
+    MMTimerWheel *wheel;
+
+    wheel = g_object_new (MM_TYPE_TIMER_WHEEL, NULL);
+    fake_clock = 1000;
+    mm_timer_wheel_set_clock (wheel, fake_clock_cb, NULL);
+    return wheel;
+}
+
+static void
+advance (MMTimerWheel *wheel,
+         guint         seconds)
+{
+    fake_clock += seconds;
+    mm_timer_wheel_run_due (wheel);
+}
+
+typedef struct {
+    MMTimerWheel *wheel;
+    const gchar  *name;
+    guint         n_calls;
+    gboolean      keep;
+    /* Timer to remove from within the callback */
+    guint        *remove_id;
+    /* Names of the timers run, in order */
+    GString      *run_order;
+} TimerData;
+
+static gboolean
+timer_cb (TimerData *data)
+{
+    data->n_calls++;
+    if (data->run_order)
+        g_string_append_printf (data->run_order, "%s%s", data->run_order->len ? "," : "", data->name);
+    if (data->remove_id && *data->remove_id) {
+        mm_timer_wheel_remove (data->wheel, *data->remove_id);
+        *data->remove_id = 0;
+    }
+    return data->keep ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+static void
+test_timers (void)
+{
+    g_autoptr(MMTimerWheel) wheel = NULL;
+    TimerData               periodic = { .keep = TRUE };
+    TimerData               oneshot = { .keep = FALSE };
+    TimerData               removed = { .keep = TRUE };
+    TimerData               remover = { .keep = FALSE };
+    TimerData               victim = { .keep = TRUE };
+    guint                   periodic_id;
+    guint                   removed_id;
+    guint                   victim_id;
+
+    wheel = timer_wheel_new ();
+    remover.wheel = wheel;
+
+    periodic_id = mm_timer_wheel_add_seconds (wheel, NULL, "periodic", 1, (GSourceFunc) timer_cb, &periodic);
+    g_assert_cmpuint (periodic_id, !=, 0);
+    mm_timer_wheel_add_seconds (wheel, NULL, "oneshot", 2, (GSourceFunc) timer_cb, &oneshot);
+
+    /* Removed before it ever fires */
+    removed_id = mm_timer_wheel_add_seconds (wheel, NULL, "removed", 1, (GSourceFunc) timer_cb, &removed);
+    mm_timer_wheel_remove (wheel, removed_id);
+
+    /* Removed by another timer expiring earlier */
+    victim_id = mm_timer_wheel_add_seconds (wheel, NULL, "victim", 60, (GSourceFunc) timer_cb, &victim);
+    remover.remove_id = &victim_id;
+    mm_timer_wheel_add_seconds (wheel, NULL, "remover", 1, (GSourceFunc) timer_cb, &remover);
+
+    mm_timer_wheel_log_timers (wheel);
+
+    /* Nothing is due before the first second elapses */
+    advance (wheel, 0);
+    g_assert_cmpuint (periodic.n_calls, ==, 0);
+    g_assert_cmpuint (remover.n_calls, ==, 0);
+
+    advance (wheel, 1);
+    g_assert_cmpuint (periodic.n_calls, ==, 1);
+    g_assert_cmpuint (oneshot.n_calls, ==, 0);
+    g_assert_cmpuint (remover.n_calls, ==, 1);
+    g_assert_cmpuint (victim_id, ==, 0);
+
+    advance (wheel, 1);
+    g_assert_cmpuint (periodic.n_calls, ==, 2);
+    g_assert_cmpuint (oneshot.n_calls, ==, 1);
+
+    advance (wheel, 1);
+    g_assert_cmpuint (periodic.n_calls, ==, 3);
+    g_assert_cmpuint (oneshot.n_calls, ==, 1);
+    g_assert_cmpuint (remover.n_calls, ==, 1);
+
+    /* Past the victim expiry */
+    advance (wheel, 60);
+    g_assert_cmpuint (removed.n_calls, ==, 0);
+    g_assert_cmpuint (victim.n_calls, ==, 0);
+
+    mm_timer_wheel_remove (wheel, periodic_id);
+}
+
+static void
+test_missed_ticks (void)
+{
+    g_autoptr(MMTimerWheel) wheel = NULL;
+    g_autoptr(GString)      run_order = NULL;
+    TimerData               periodic = { .name = "periodic", .keep = TRUE };
+    TimerData               first = { .name = "first", .keep = FALSE };
+    TimerData               second = { .name = "second", .keep = FALSE };
+    TimerData               far = { .name = "far", .keep = FALSE };
+    guint                   periodic_id;
+
+    wheel = timer_wheel_new ();
+    run_order = g_string_new (NULL);
+    periodic.run_order = first.run_order = second.run_order = far.run_order = run_order;
+
+    /* Added in reverse expiry order */
+    mm_timer_wheel_add_seconds (wheel, NULL, second.name, 3, (GSourceFunc) timer_cb, &second);
+    mm_timer_wheel_add_seconds (wheel, NULL, first.name, 2, (GSourceFunc) timer_cb, &first);
+    periodic_id = mm_timer_wheel_add_seconds (wheel, NULL, periodic.name, 5, (GSourceFunc) timer_cb, &periodic);
+
+    /* Further away than the number of slots in the wheel */
+    mm_timer_wheel_add_seconds (wheel, NULL, far.name, 100, (GSourceFunc) timer_cb, &far);
+
+    /* A late dispatch runs the expired timers in expiry order, and a
+     * periodic timer only once however many periods were missed */
+    advance (wheel, 12);
+    g_assert_cmpstr (run_order->str, ==, "first,second,periodic");
+    g_assert_cmpuint (periodic.n_calls, ==, 1);
+
+    /* The periodic timer is rescheduled from the dispatch time */
+    advance (wheel, 4);
+    g_assert_cmpuint (periodic.n_calls, ==, 1);
+    advance (wheel, 1);
+    g_assert_cmpuint (periodic.n_calls, ==, 2);
+
+    /* The far timer only fires once its expiry is reached, even if its
+     * slot was visited before */
+    g_assert_cmpuint (far.n_calls, ==, 0);
+    advance (wheel, 64);
+    g_assert_cmpuint (far.n_calls, ==, 0);
+    advance (wheel, 19);
+    g_assert_cmpuint (far.n_calls, ==, 1);
+
+    mm_timer_wheel_remove (wheel, periodic_id);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/timer-wheel/timers", test_timers);
+    g_test_add_func ("/MM/timer-wheel/missed-ticks", test_missed_ticks);
+
+    return g_test_run ();
+}
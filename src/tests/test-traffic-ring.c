@@ -0,0 +1,248 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+#include <string.h>
+
+#include "mm-traffic-ring.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    guint64 first_sequence;
+    guint   n_records;
+    guint   n_in;
+    guint   n_out;
+    gsize   total_len;
+} ForeachData;
+
+static void
+count_record (guint64             sequence,
+              gint64              timestamp,
+              MMTrafficDirection  direction,
+              const guint8       *data,
+              gsize               len,
+              ForeachData        *fd)
+{
+    if (!fd->n_records)
+        fd->first_sequence = sequence;
+    g_assert_cmpuint (sequence, ==, fd->first_sequence + fd->n_records);
+    g_assert_cmpint (timestamp, >, 0);
+    fd->n_records++;
+    fd->total_len += len;
+    if (direction == MM_TRAFFIC_DIRECTION_IN)
+        fd->n_in++;
+    else
+        fd->n_out++;
+}
+
+static void
+test_append (void)
+{
+    g_autoptr(MMTrafficRing) ring = NULL;
+    ForeachData              fd = { 0 };
+
+    ring = mm_traffic_ring_new (1024);
+    mm_traffic_ring_append (ring, MM_TRAFFIC_DIRECTION_OUT, (const guint8 *)"AT\r", 3);
+    mm_traffic_ring_append (ring, MM_TRAFFIC_DIRECTION_IN, (const guint8 *)"\r\nOK\r\n", 6);
+    g_assert_cmpuint (mm_traffic_ring_get_sequence (ring), ==, 2);
+
+    mm_traffic_ring_foreach (ring, 0, (MMTrafficRingForeachFunc) count_record, &fd);
+    g_assert_cmpuint (fd.n_records, ==, 2);
+    g_assert_cmpuint (fd.n_out, ==, 1);
+    g_assert_cmpuint (fd.n_in, ==, 1);
+    g_assert_cmpuint (fd.total_len, ==, 9);
+
+    /* Only the records newer than the given sequence */
+    memset (&fd, 0, sizeof (fd));
+    mm_traffic_ring_foreach (ring, 1, (MMTrafficRingForeachFunc) count_record, &fd);
+    g_assert_cmpuint (fd.n_records, ==, 1);
+    g_assert_cmpuint (fd.first_sequence, ==, 1);
+    g_assert_cmpuint (fd.n_in, ==, 1);
+}
+
+/*****************************************************************************/
+
+static void
+check_wrapped_record (guint64             sequence,
+                      gint64              timestamp,
+                      MMTrafficDirection  direction,
+                      const guint8       *data,
+                      gsize               len,
+                      ForeachData        *fd)
+{
+    g_autofree gchar *expected = NULL;
+
+    expected = g_strdup_printf ("AT+RECORD=%" G_GUINT64_FORMAT "\r", sequence);
+    g_assert_cmpuint (len, ==, strlen (expected));
+    g_assert (memcmp (data, expected, len) == 0);
+    count_record (sequence, timestamp, direction, data, len, fd);
+}
+
+static void
+test_wrap (void)
+{
+    g_autoptr(MMTrafficRing) ring = NULL;
+    ForeachData              fd = { 0 };
+    guint                    i;
+
+    ring = mm_traffic_ring_new (256);
+    for (i = 0; i < 100; i++) {
+        g_autofree gchar *cmd = NULL;
+
+        cmd = g_strdup_printf ("AT+RECORD=%u\r", i);
+        mm_traffic_ring_append (ring, MM_TRAFFIC_DIRECTION_OUT, (const guint8 *)cmd, strlen (cmd));
+    }
+    g_assert_cmpuint (mm_traffic_ring_get_sequence (ring), ==, 100);
+
+    /* Oldest ones dropped, the newest one always kept and intact */
+    mm_traffic_ring_foreach (ring, 0, (MMTrafficRingForeachFunc) check_wrapped_record, &fd);
+    g_assert_cmpuint (fd.n_records, >, 0);
+    g_assert_cmpuint (fd.n_records, <, 100);
+    g_assert_cmpuint (fd.first_sequence + fd.n_records, ==, 100);
+}
+
+static void
+test_oversized (void)
+{
+    g_autoptr(MMTrafficRing) ring = NULL;
+    ForeachData              fd = { 0 };
+    guint8                   big[1024];
+
+    memset (big, 'A', sizeof (big));
+    ring = mm_traffic_ring_new (128);
+    mm_traffic_ring_append (ring, MM_TRAFFIC_DIRECTION_IN, big, sizeof (big));
+
+    /* Truncated to whatever fits */
+    mm_traffic_ring_foreach (ring, 0, (MMTrafficRingForeachFunc) count_record, &fd);
+    g_assert_cmpuint (fd.n_records, ==, 1);
+    g_assert_cmpuint (fd.total_len, >, 0);
+    g_assert_cmpuint (fd.total_len, <, 128);
+}
+
+/*****************************************************************************/
+
+static void
+test_escape (void)
+{
+    g_autofree gchar *str = NULL;
+
+    str = mm_traffic_ring_escape ((const guint8 *)"\r\n+CSQ: 20,99\r\n\x1a", 16);
+    g_assert_cmpstr (str, ==, "<CR><LF>+CSQ: 20,99<CR><LF>\\26");
+}
+
+static void
+test_escape_secrets (void)
+{
+    g_autofree gchar *pin = NULL;
+    g_autofree gchar *clck = NULL;
+    g_autofree gchar *query = NULL;
+    g_autofree gchar *imsi = NULL;
+    g_autofree gchar *iccid = NULL;
+    g_autofree gchar *pdu = NULL;
+    g_autofree gchar *cmgs = NULL;
+
+    pin = mm_traffic_ring_escape ((const guint8 *)"AT+CPIN=\"1234\"\r", 15);
+    g_assert_cmpstr (pin, ==, "AT+CPIN=<hidden><CR>");
+
+    clck = mm_traffic_ring_escape ((const guint8 *)"at+clck=\"SC\",0,\"1234\"", 21);
+    g_assert_cmpstr (clck, ==, "at+clck=<hidden>");
+
+    /* Queries carry no secrets */
+    query = mm_traffic_ring_escape ((const guint8 *)"AT+CPIN?\r", 9);
+    g_assert_cmpstr (query, ==, "AT+CPIN?<CR>");
+
+    imsi = mm_traffic_ring_escape ((const guint8 *)"\r\n310260123456789\r\n", 19);
+    g_assert_cmpstr (imsi, ==, "<CR><LF><hidden><CR><LF>");
+
+    iccid = mm_traffic_ring_escape ((const guint8 *)"+ICCID: 8901260123456789012F", 28);
+    g_assert_cmpstr (iccid, ==, "+ICCID: <hidden>");
+
+    pdu = mm_traffic_ring_escape ((const guint8 *)"0011000B916407281553F80000AA0AE8329BFD4697D9EC37\x1a", 49);
+    g_assert_cmpstr (pdu, ==, "<hidden>\\26");
+
+    /* Short numbers are kept */
+    cmgs = mm_traffic_ring_escape ((const guint8 *)"+CMGS=23\r", 9);
+    g_assert_cmpstr (cmgs, ==, "+CMGS=23<CR>");
+}
+
+/*****************************************************************************/
+
+static void
+test_pcap (void)
+{
+    g_autoptr(MMTrafficRing) ring = NULL;
+    g_autoptr(GError)        error = NULL;
+    g_autofree gchar        *dir = NULL;
+    g_autofree gchar        *path = NULL;
+    g_autofree gchar        *contents = NULL;
+    gsize                    len = 0;
+    guint32                  magic;
+    guint32                  linktype;
+    guint32                  incl_len;
+    gboolean                 success;
+
+    ring = mm_traffic_ring_new (1024);
+    mm_traffic_ring_append (ring, MM_TRAFFIC_DIRECTION_OUT, (const guint8 *)"AT\r", 3);
+    mm_traffic_ring_append (ring, MM_TRAFFIC_DIRECTION_IN, (const guint8 *)"\r\nOK\r\n", 6);
+
+    dir = g_dir_make_tmp ("mm-test-traffic-ring-XXXXXX", &error);
+    g_assert_no_error (error);
+    path = g_build_filename (dir, "traffic.pcap", NULL);
+
+    success = mm_traffic_ring_write_pcap (ring, path, &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    success = g_file_get_contents (path, &contents, &len, &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    /* File header, then two records with the direction byte prefix */
+    g_assert_cmpuint (len, ==, 24 + (16 + 1 + 3) + (16 + 1 + 6));
+    memcpy (&magic, contents, 4);
+    g_assert_cmphex (magic, ==, 0xa1b2c3d4);
+    memcpy (&linktype, contents + 20, 4);
+    g_assert_cmpuint (linktype, ==, 147);
+    memcpy (&incl_len, contents + 24 + 8, 4);
+    g_assert_cmpuint (incl_len, ==, 4);
+    g_assert_cmpint (contents[24 + 16], ==, MM_TRAFFIC_DIRECTION_OUT);
+    g_assert (memcmp (contents + 24 + 16 + 1, "AT\r", 3) == 0);
+    g_assert_cmpint (contents[24 + 20 + 16], ==, MM_TRAFFIC_DIRECTION_IN);
+
+    g_unlink (path);
+    g_rmdir (dir);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/traffic-ring/append",    test_append);
+    g_test_add_func ("/MM/traffic-ring/wrap",      test_wrap);
+    g_test_add_func ("/MM/traffic-ring/oversized", test_oversized);
+    g_test_add_func ("/MM/traffic-ring/escape",    test_escape);
+    g_test_add_func ("/MM/traffic-ring/secrets",   test_escape_secrets);
+    g_test_add_func ("/MM/traffic-ring/pcap",      test_pcap);
+
+    return g_test_run ();
+}
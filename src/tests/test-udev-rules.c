@@ -15,6 +15,7 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #include <stdio.h>
 #include <locale.h>
@@ -41,6 +42,302 @@ test_load_cleanup_core (void)
     g_array_unref (rules);
 }
 
+/************************************************************/
+/* Apply the core and plugin rules to a set of synthetic devices, and compare
+ * the results obtained with and without the vendor index */
+
+typedef struct {
+    MMUdevRulesDevice  device;
+    GHashTable        *properties;
+    gchar             *name;
+} TestDevice;
+
+static gchar *
+test_device_lookup_attribute (gpointer     user_data,
+                              const gchar *attribute,
+                              gboolean     lookup_parents)
+{
+    /* No additional sysfs attributes in the synthetic devices */
+    return NULL;
+}
+
+static const gchar *
+test_device_get_property (gpointer user_data,
+                          GQuark   property)
+{
+    TestDevice *test_device = user_data;
+
+    return g_hash_table_lookup (test_device->properties, GUINT_TO_POINTER (property));
+}
+
+static void
+test_device_set_property (gpointer        user_data,
+                          GQuark          property,
+                          gchar          *value,
+                          GDestroyNotify  value_free)
+{
+    TestDevice *test_device = user_data;
+
+    g_hash_table_insert (test_device->properties, GUINT_TO_POINTER (property), g_strdup (value));
+    if (value_free)
+        value_free (value);
+}
+
+static const gchar *tty_subsystems[] = { "tty", "usb", NULL };
+static const gchar *tty_drivers[]    = { "option", "usb", NULL };
+static const gchar *net_subsystems[] = { "net", "usb", NULL };
+static const gchar *net_drivers[]    = { "qmi_wwan", "usb", NULL };
+
+static void
+test_device_reset (TestDevice *test_device)
+{
+    g_hash_table_remove_all (test_device->properties);
+}
+
+static void
+test_device_free (TestDevice *test_device)
+{
+    g_hash_table_unref (test_device->properties);
+    g_free (test_device->name);
+    g_slice_free (TestDevice, test_device);
+}
+
+static TestDevice *
+test_device_new (guint16  vid,
+                 guint16  pid,
+                 guint8   interface_number,
+                 gboolean net)
+{
+    TestDevice *test_device;
+
+    test_device = g_slice_new0 (TestDevice);
+    test_device->properties = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+    test_device->name = (net ?
+                         g_strdup_printf ("wwan%u", interface_number) :
+                         g_strdup_printf ("ttyUSB%u", interface_number));
+
+    test_device->device.name               = test_device->name;
+    test_device->device.sysfs_path         = "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-2";
+    test_device->device.subsystems         = net ? net_subsystems : tty_subsystems;
+    test_device->device.drivers            = net ? net_drivers : tty_drivers;
+    test_device->device.vendor_id          = vid;
+    test_device->device.product_id         = pid;
+    test_device->device.interface_class    = net ? 0xff : 0x02;
+    test_device->device.interface_number   = interface_number;
+    test_device->device.lookup_attribute   = test_device_lookup_attribute;
+    test_device->device.get_property       = test_device_get_property;
+    test_device->device.set_property       = test_device_set_property;
+    test_device->device.user_data          = test_device;
+    return test_device;
+}
+
+static void
+copy_rules_file (const gchar *path,
+                 const gchar *dest_dir)
+{
+    g_autoptr(GError)  error = NULL;
+    g_autofree gchar  *contents = NULL;
+    g_autofree gchar  *basename = NULL;
+    g_autofree gchar  *dest = NULL;
+
+    g_file_get_contents (path, &contents, NULL, &error);
+    g_assert_no_error (error);
+    basename = g_path_get_basename (path);
+    dest = g_build_filename (dest_dir, basename, NULL);
+    g_file_set_contents (dest, contents, -1, &error);
+    g_assert_no_error (error);
+}
+
+/* Gather all rules as installed: core ones and the ones from all plugins */
+static gchar *
+setup_rules_dir (void)
+{
+    g_autoptr(GError)  error = NULL;
+    g_autofree gchar  *core_rules = NULL;
+    g_autofree gchar  *plugins_dir = NULL;
+    gchar             *rules_dir;
+    GDir              *dir;
+    const gchar       *plugin;
+
+    rules_dir = g_dir_make_tmp ("mm-udev-rules-XXXXXX", &error);
+    g_assert_no_error (error);
+
+    core_rules = g_build_filename (TESTUDEVRULESDIR, "80-mm-candidate.rules", NULL);
+    copy_rules_file (core_rules, rules_dir);
+
+    plugins_dir = g_build_filename (TESTUDEVRULESDIR, "..", "plugins", NULL);
+    dir = g_dir_open (plugins_dir, 0, NULL);
+    if (!dir)
+        return rules_dir;
+
+    while ((plugin = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *plugin_dir_path = NULL;
+        GDir             *plugin_dir;
+        const gchar      *file;
+
+        plugin_dir_path = g_build_filename (plugins_dir, plugin, NULL);
+        plugin_dir = g_dir_open (plugin_dir_path, 0, NULL);
+        if (!plugin_dir)
+            continue;
+        while ((file = g_dir_read_name (plugin_dir)) != NULL) {
+            g_autofree gchar *path = NULL;
+
+            if (!g_str_has_suffix (file, ".rules"))
+                continue;
+            path = g_build_filename (plugin_dir_path, file, NULL);
+            copy_rules_file (path, rules_dir);
+        }
+        g_dir_close (plugin_dir);
+    }
+    g_dir_close (dir);
+
+    return rules_dir;
+}
+
+static void
+cleanup_rules_dir (const gchar *rules_dir)
+{
+    GDir        *dir;
+    const gchar *file;
+
+    dir = g_dir_open (rules_dir, 0, NULL);
+    g_assert (dir);
+    while ((file = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *path = NULL;
+
+        path = g_build_filename (rules_dir, file, NULL);
+        g_unlink (path);
+    }
+    g_dir_close (dir);
+    g_rmdir (rules_dir);
+}
+
+/* One tty and one net device per interface, for every vid/pid found in the rules */
+static GPtrArray *
+build_test_devices (GArray *rules)
+{
+    g_autoptr(GHashTable)  seen = NULL;
+    GPtrArray             *devices;
+    guint                  i;
+
+    devices = g_ptr_array_new_with_free_func ((GDestroyNotify) test_device_free);
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    /* A device not matched by any vendor specific rule */
+    g_ptr_array_add (devices, test_device_new (0xffff, 0xffff, 0, FALSE));
+
+    for (i = 0; i < rules->len; i++) {
+        MMUdevRule *rule;
+        guint       vid = 0;
+        guint       pid = 0;
+        guint       j;
+
+        rule = &g_array_index (rules, MMUdevRule, i);
+        if (!rule->conditions)
+            continue;
+
+        for (j = 0; j < rule->conditions->len; j++) {
+            MMUdevRuleMatch *match;
+
+            match = &g_array_index (rule->conditions, MMUdevRuleMatch, j);
+            if (match->type != MM_UDEV_RULE_MATCH_TYPE_EQUAL || !match->value_uint_valid)
+                continue;
+            if (match->parameter_id == MM_UDEV_RULE_MATCH_PARAMETER_VENDOR_ID)
+                vid = match->value_uint;
+            else if (match->parameter_id == MM_UDEV_RULE_MATCH_PARAMETER_PRODUCT_ID)
+                pid = match->value_uint;
+        }
+
+        if (vid && pid && g_hash_table_add (seen, GUINT_TO_POINTER ((vid << 16) | pid))) {
+            guint8 interface_number;
+
+            for (interface_number = 0; interface_number < 6; interface_number++) {
+                g_ptr_array_add (devices, test_device_new (vid, pid, interface_number, FALSE));
+                g_ptr_array_add (devices, test_device_new (vid, pid, interface_number, TRUE));
+            }
+        }
+    }
+
+    return devices;
+}
+
+static gdouble
+apply_rules (GArray    *rules,
+             GPtrArray *devices,
+             gboolean   use_index,
+             guint      iterations)
+{
+    g_autoptr(GTimer) timer = NULL;
+    guint             i;
+    guint             j;
+
+    timer = g_timer_new ();
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < devices->len; j++) {
+            TestDevice *test_device;
+
+            test_device = g_ptr_array_index (devices, j);
+            test_device_reset (test_device);
+            mm_kernel_device_generic_rules_apply (rules, &test_device->device, use_index);
+        }
+    }
+    return g_timer_elapsed (timer, NULL);
+}
+
+static void
+test_apply_index (void)
+{
+    g_autoptr(GError)     error = NULL;
+    g_autoptr(GArray)     rules = NULL;
+    g_autoptr(GPtrArray)  devices = NULL;
+    g_autoptr(GPtrArray)  devices_no_index = NULL;
+    g_autofree gchar     *rules_dir = NULL;
+    guint                 iterations;
+    gdouble               elapsed;
+    gdouble               elapsed_no_index;
+    guint                 i;
+
+    rules_dir = setup_rules_dir ();
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    cleanup_rules_dir (rules_dir);
+    g_assert_no_error (error);
+    g_assert (rules);
+
+    devices = build_test_devices (rules);
+    devices_no_index = build_test_devices (rules);
+    g_assert_cmpuint (devices->len, ==, devices_no_index->len);
+
+    iterations = g_test_perf () ? 100 : 1;
+    elapsed = apply_rules (rules, devices, TRUE, iterations);
+    elapsed_no_index = apply_rules (rules, devices_no_index, FALSE, iterations);
+
+    /* The index must never change the outcome */
+    for (i = 0; i < devices->len; i++) {
+        TestDevice     *test_device;
+        TestDevice     *test_device_no_index;
+        GHashTableIter  iter;
+        gpointer        key;
+        gpointer        value;
+
+        test_device = g_ptr_array_index (devices, i);
+        test_device_no_index = g_ptr_array_index (devices_no_index, i);
+        g_assert_cmpuint (g_hash_table_size (test_device->properties), ==,
+                          g_hash_table_size (test_device_no_index->properties));
+
+        g_hash_table_iter_init (&iter, test_device->properties);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+            g_assert_cmpstr ((const gchar *) value, ==,
+                             (const gchar *) g_hash_table_lookup (test_device_no_index->properties, key));
+    }
+
+    if (g_test_perf ()) {
+        g_test_message ("%u rules, %u devices, %u iterations", rules->len, devices->len, iterations);
+        g_test_message ("linear walk:   %.3f ms", elapsed_no_index * 1000.0);
+        g_test_message ("vendor index:  %.3f ms", elapsed * 1000.0);
+        g_test_minimized_result (elapsed, "vendor index: %.3f ms", elapsed * 1000.0);
+    }
+}
+
 /************************************************************/
 
 int main (int argc, char **argv)
@@ -50,6 +347,7 @@ int main (int argc, char **argv)
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/MM/test-udev-rules/load-cleanup-core", test_load_cleanup_core);
+    g_test_add_func ("/MM/test-udev-rules/apply-index",       test_apply_index);
 
     return g_test_run ();
 }
@@ -303,6 +303,8 @@ _mm_log (gpointer     obj,
     g_print ("[%s] %s\n", level_str ? level_str : "unknown", msg);
 }
 
+guint32 _mm_log_level = MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_DEBUG;
+
 int main (int argc, char **argv)
 {
     GOptionContext *context;